@@ -35,6 +35,14 @@
 #define MAX_CMD53_RETRY 	3
 /** Max retry number of CMD53 read/write */
 #define MAX_CMD52_RETRY     3
+/** First delay between FW download status polls in us */
+#define FW_DNLD_POLL_MIN_DELAY	1
+/** Longest delay between FW download status polls in us */
+#define FW_DNLD_POLL_MAX_DELAY	10
+/** First delay between firmware ready polls in ms */
+#define FW_READY_POLL_MIN_DELAY	5
+/** Longest delay between firmware ready polls in ms */
+#define FW_READY_POLL_MAX_DELAY	100
 /** Firmware name */
 static char *fw_name;
 /** fw serial download flag */
@@ -234,6 +242,23 @@ done:
 	return ret;
 }
 
+/**
+ *  @brief This function waits before the next FW download status poll
+ *
+ *  @param delay    A pointer to the current delay in us, updated for
+ *                  the next call
+ *  @return         Time waited in us
+ */
+static u32
+sd_fw_dnld_backoff(u32 *delay)
+{
+	u32 cur = *delay;
+
+	udelay(cur);
+	*delay = min_t(u32, cur << 1, FW_DNLD_POLL_MAX_DELAY);
+	return cur;
+}
+
 /**
  *  @brief This function polls the card status register
  *
@@ -249,10 +274,12 @@ sd_poll_card_status(bt_private *priv, u8 bits)
 	struct sdio_mmc_card *card = (struct sdio_mmc_card *)priv->bt_dev.card;
 	u8 cs;
 	u8 card_status_reg = CARD_STATUS_REG;
+	u32 delay = FW_DNLD_POLL_MIN_DELAY;
+	u32 waited = 0;
 
 	ENTER();
 
-	for (tries = 0; tries < MAX_POLL_TRIES * 1000; tries++) {
+	for (tries = 0; waited < MAX_POLL_TRIES * 1000; tries++) {
 		cs = sdio_readb(card->func, card_status_reg, &rval);
 		if (rval != 0)
 			break;
@@ -260,7 +287,7 @@ sd_poll_card_status(bt_private *priv, u8 bits)
 			LEAVE();
 			return BT_STATUS_SUCCESS;
 		}
-		udelay(1);
+		waited += sd_fw_dnld_backoff(&delay);
 	}
 	PRINTM(ERROR,
 	       "BT: sdio_poll_card_status failed (%d), tries = %d, cs = 0x%x\n",
@@ -485,19 +512,29 @@ sd_verify_fw_download(bt_private *priv, int pollnum)
 	int ret = BT_STATUS_FAILURE;
 	u16 firmwarestat = 0;
 	int tries;
+	u32 delay = FW_READY_POLL_MIN_DELAY;
+	u32 waited = 0;
 
 	ENTER();
 
-	/* Wait for firmware initialization event */
-	for (tries = 0; tries < pollnum; tries++) {
-		if (sd_read_firmware_status(priv, &firmwarestat) < 0)
-			continue;
-		if (firmwarestat == FIRMWARE_READY) {
-			PRINTM(MSG, "BT FW is active(%d)\n", tries);
+	/* Wait for firmware initialization event. The total wait is still
+	 * pollnum * FW_READY_POLL_MAX_DELAY ms, but the first polls are
+	 * closer together so firmware downloaded by the other interface
+	 * is picked up soon after it comes up. */
+	for (tries = 0; ; tries++) {
+		if (sd_read_firmware_status(priv, &firmwarestat) == 0 &&
+		    firmwarestat == FIRMWARE_READY) {
+			PRINTM(MSG, "BT FW is active(%d, %u ms)\n", tries,
+			       waited);
 			ret = BT_STATUS_SUCCESS;
 			break;
 		}
-		mdelay(100);
+		/* A single status check does not need to sleep */
+		if (pollnum <= 1 || waited >= pollnum * FW_READY_POLL_MAX_DELAY)
+			break;
+		mdelay(delay);
+		waited += delay;
+		delay = min_t(u32, delay << 1, FW_READY_POLL_MAX_DELAY);
 	}
 	if ((pollnum > 1) && (ret != BT_STATUS_SUCCESS)) {
 		PRINTM(ERROR,
@@ -527,17 +564,20 @@ sd_init_fw_dpc(bt_private *priv, u8 *fw, int fw_len)
 	u8 base1;
 	int ret = BT_STATUS_SUCCESS;
 	int offset;
-	void *tmpfwbuf = NULL;
+	void *tmpfwbuf[2] = { NULL, NULL };
 	int tmpfwbufsz;
+	u8 *fwbuf_arr[2];
 	u8 *fwbuf;
+	int cur = 0;
+	int prep_offset = 0, prep_len = 0;
 	u16 len;
 	int txlen = 0;
 	int tx_blocks = 0;
 	int i = 0;
 	int tries = 0;
-#ifdef FW_DOWNLOAD_SPEED
-	u32 tv1, tv2;
-#endif
+	u32 delay, waited;
+	bt_timeval tv1, tv2;
+	u32 dnld_us;
 	u8 sq_read_base_address_a0_reg = SQ_READ_BASE_ADDRESS_A0_REG;
 	u8 sq_read_base_address_a1_reg = SQ_READ_BASE_ADDRESS_A1_REG;
 
@@ -545,20 +585,24 @@ sd_init_fw_dpc(bt_private *priv, u8 *fw, int fw_len)
 
 	PRINTM(INFO, "BT: Downloading FW image (%d bytes)\n", firmwarelen);
 
-#ifdef FW_DOWNLOAD_SPEED
-	tv1 = get_utimeofday();
-#endif
+	get_monotonic_time(&tv1);
 
+	/* Two bounce buffers: the next block is copied into one while the
+	 * helper is still consuming the block sent from the other */
 	tmpfwbufsz = BT_UPLD_SIZE + DMA_ALIGNMENT;
-	tmpfwbuf = kzalloc(tmpfwbufsz, GFP_KERNEL);
-	if (!tmpfwbuf) {
-		PRINTM(ERROR,
-		       "BT: Unable to allocate buffer for firmware. Terminating download\n");
-		ret = BT_STATUS_FAILURE;
-		goto done;
+	for (cur = 0; cur < 2; cur++) {
+		tmpfwbuf[cur] = kzalloc(tmpfwbufsz, GFP_KERNEL);
+		if (!tmpfwbuf[cur]) {
+			PRINTM(ERROR,
+			       "BT: Unable to allocate buffer for firmware. Terminating download\n");
+			ret = BT_STATUS_FAILURE;
+			goto done;
+		}
+		/* Ensure aligned firmware buffer */
+		fwbuf_arr[cur] = (u8 *)ALIGN_ADDR(tmpfwbuf[cur], DMA_ALIGNMENT);
 	}
-	/* Ensure aligned firmware buffer */
-	fwbuf = (u8 *)ALIGN_ADDR(tmpfwbuf, DMA_ALIGNMENT);
+	cur = 0;
+	fwbuf = fwbuf_arr[cur];
 
 	/* Perform firmware data transfer */
 	offset = 0;
@@ -576,7 +620,9 @@ sd_init_fw_dpc(bt_private *priv, u8 *fw, int fw_len)
 		if (offset >= firmwarelen)
 			break;
 
-		for (tries = 0; tries < MAX_POLL_TRIES; tries++) {
+		delay = FW_DNLD_POLL_MIN_DELAY;
+		waited = 0;
+		for (tries = 0; waited < MAX_POLL_TRIES * 10; tries++) {
 			base0 = sdio_readb(card->func,
 					   sq_read_base_address_a0_reg, &ret);
 			if (ret) {
@@ -599,7 +645,7 @@ sd_init_fw_dpc(bt_private *priv, u8 *fw, int fw_len)
 
 			if (len != 0)
 				break;
-			udelay(10);
+			waited += sd_fw_dnld_backoff(&delay);
 		}
 
 		if (len == 0)
@@ -646,8 +692,15 @@ sd_init_fw_dpc(bt_private *priv, u8 *fw, int fw_len)
 				(txlen + SD_BLOCK_SIZE_FW_DL -
 				 1) / SD_BLOCK_SIZE_FW_DL;
 
-			/* Copy payload to buffer */
-			memcpy(fwbuf, &firmware[offset], txlen);
+			/* Keep the last block intact for a CRC resend and use
+			 * the other buffer, which normally already holds this
+			 * block */
+			cur ^= 1;
+			fwbuf = fwbuf_arr[cur];
+			if (prep_len != txlen || prep_offset != offset)
+				/* Copy payload to buffer */
+				memcpy(fwbuf, &firmware[offset], txlen);
+			prep_len = 0;
 		}
 
 		/* Send data */
@@ -664,23 +717,27 @@ sd_init_fw_dpc(bt_private *priv, u8 *fw, int fw_len)
 		}
 
 		offset += txlen;
+
+		/* Prepare the next block, assuming the helper asks for the same
+		 * length again, while the card handles the one just sent */
+		if (txlen && offset < firmwarelen) {
+			prep_offset = offset;
+			prep_len = min(txlen, firmwarelen - offset);
+			memcpy(fwbuf_arr[cur ^ 1], &firmware[offset], prep_len);
+		}
 	} while (TRUE);
 
-	PRINTM(MSG, "BT: FW download over, size %d bytes\n", offset);
+	get_monotonic_time(&tv2);
+	dnld_us = (tv2.time_sec - tv1.time_sec) * 1000000 +
+		tv2.time_usec - tv1.time_usec;
+	PRINTM(MSG, "BT: FW download over, size %d bytes in %u us (%u KB/s)\n",
+	       offset, dnld_us,
+	       dnld_us ? (u32)div_u64((u64)offset * 1000, dnld_us) : 0);
 
 	ret = BT_STATUS_SUCCESS;
 done:
-#ifdef FW_DOWNLOAD_SPEED
-	tv2 = get_utimeofday();
-	PRINTM(INFO, "FW: %d.%03d.%03d ", tv1 / 1000000,
-	       (tv1 % 1000000) / 1000, tv1 % 1000);
-	PRINTM(INFO, " -> %d.%03d.%03d ", tv2 / 1000000,
-	       (tv2 % 1000000) / 1000, tv2 % 1000);
-	tv2 -= tv1;
-	PRINTM(INFO, " == %d.%03d.%03d\n", tv2 / 1000000,
-	       (tv2 % 1000000) / 1000, tv2 % 1000);
-#endif
-	kfree(tmpfwbuf);
+	kfree(tmpfwbuf[0]);
+	kfree(tmpfwbuf[1]);
 	LEAVE();
 	return ret;
 }
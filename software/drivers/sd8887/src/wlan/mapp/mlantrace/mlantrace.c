@@ -0,0 +1,217 @@
+/** @file  mlantrace.c
+ *
+ *  @brief Program to decode the hot-path trace records read from
+ *         /proc/mwlan/trace
+ *
+  *
+  * Copyright 2014-2020 NXP
+  *
+  * This software file (the File) is distributed by NXP
+  * under the terms of the GNU General Public License Version 2, June 1991
+  * (the License).  You may use, redistribute and/or modify the File in
+  * accordance with the terms and conditions of the License, a copy of which
+  * is available by writing to the Free Software Foundation, Inc.,
+  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA or on the
+  * worldwide web at http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+  *
+  * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE
+  * ARE EXPRESSLY DISCLAIMED.  The License provides additional details about
+  * this warranty disclaimer.
+  *
+  */
+/****************************************************************************
+Change log:
+    10/16/2026: Initial creation
+****************************************************************************/
+
+/****************************************************************************
+        Header files
+****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "mlantrace.h"
+
+/****************************************************************************
+        Global variables
+****************************************************************************/
+/**
+ *  Trace points indexed by id, must match mlan_trace_id in
+ *  mlan/mlan_trace.h
+ */
+static const trace_point trace_points[] = {
+	{"NONE", ""},
+	{"INT_STATUS", "sdio_ireg=0x%x"},
+	{"WR_BITMAP", "wr_bitmap=0x%08x curr_wr_port=%u data_sent=%u"},
+	{"RD_BITMAP", "rd_bitmap=0x%08x"},
+	{"RX_PORT", "port=%u rx_len=%u"},
+	{"RX_UPLD", "upld_typ=%u upld_len=%u"},
+	{"TX_DNLD", "port=%u data_len=%u status=%d"},
+	{"TX_DEQUEUE", "bss=%u tid=%u ra_pkts=%u"},
+	{"RX_REORDER", "tid=%u seq_num=%u pkt_type=%u"},
+	{"RX_REORDER_DONE", "tid=%u start_win=%u status=%d"},
+};
+
+/** Number of known trace points */
+#define NUM_TRACE_POINTS \
+	(sizeof(trace_points) / sizeof(trace_points[0]))
+
+static struct option long_opts[] = {
+	{"help", no_argument, NULL, 'h'},
+	{"version", no_argument, NULL, 'v'},
+	{"cpu", required_argument, NULL, 'c'},
+	{NULL, 0, NULL, 0}
+};
+
+/****************************************************************************
+        Local functions
+****************************************************************************/
+/**
+ *  @brief Print usage information
+ *
+ *  @return         N/A
+ */
+static void
+print_usage(void)
+{
+	printf("\n");
+	printf("Usage : mlantrace [-v] [-h] [-c cpu] [file]\n");
+	printf("    -v               : Print version information\n");
+	printf("    -h               : Print help information\n");
+	printf("    -c               : Only print records from this CPU\n");
+	printf("    file             : Raw trace, default %s\n",
+	       MLAN_TRACE_PROC);
+	printf("\n");
+}
+
+/**
+ *  @brief Order records by timestamp
+ *
+ *  @param a        First record
+ *  @param b        Second record
+ *  @return         <0, 0 or >0 as for qsort
+ */
+static int
+trace_rec_cmp(const void *a, const void *b)
+{
+	const trace_rec *ra = a;
+	const trace_rec *rb = b;
+
+	if (ra->ts < rb->ts)
+		return -1;
+	return ra->ts > rb->ts;
+}
+
+/**
+ *  @brief Read all records from a raw trace file
+ *
+ *  @param fp       File to read
+ *  @param pnum     Returns the number of records
+ *  @return         Record array, or NULL on failure
+ */
+static trace_rec *
+read_trace(FILE * fp, size_t *pnum)
+{
+	trace_rec *recs = NULL, *tmp;
+	size_t num = 0, max = 0, n;
+
+	for (;;) {
+		if (num == max) {
+			max = max ? max * 2 : 4096;
+			tmp = realloc(recs, max * sizeof(trace_rec));
+			if (!tmp) {
+				free(recs);
+				return NULL;
+			}
+			recs = tmp;
+		}
+		n = fread(recs + num, sizeof(trace_rec), max - num, fp);
+		num += n;
+		if (num < max)
+			break;
+	}
+	*pnum = num;
+	return recs;
+}
+
+/****************************************************************************
+        Global functions
+****************************************************************************/
+/**
+ *  @brief The main function
+ *
+ *  @param argc     Number of arguments
+ *  @param argv     Pointer to the arguments
+ *  @return         0 or 1
+ */
+int
+main(int argc, char *argv[])
+{
+	int opt;
+	int cpu = -1;
+	const char *fname = MLAN_TRACE_PROC;
+	FILE *fp;
+	trace_rec *recs, *rec;
+	size_t num, i;
+	t_u64 start;
+
+	while ((opt = getopt_long(argc, argv, "hvc:", long_opts, NULL)) > 0) {
+		switch (opt) {
+		case 'h':
+			print_usage();
+			return 0;
+		case 'v':
+			printf("mlantrace version : %s\n", MLAN_TRACE_VERSION);
+			return 0;
+		case 'c':
+			cpu = atoi(optarg);
+			break;
+		default:
+			print_usage();
+			return 1;
+		}
+	}
+	if (optind < argc)
+		fname = argv[optind];
+
+	if (!strcmp(fname, "-"))
+		fp = stdin;
+	else
+		fp = fopen(fname, "rb");
+	if (!fp) {
+		perror(fname);
+		return 1;
+	}
+	recs = read_trace(fp, &num);
+	if (fp != stdin)
+		fclose(fp);
+	if (!recs) {
+		printf("ERR: Cannot allocate memory for trace records\n");
+		return 1;
+	}
+
+	/* Each CPU ring is in order, merge them by time */
+	qsort(recs, num, sizeof(trace_rec), trace_rec_cmp);
+	start = num ? recs[0].ts : 0;
+	for (i = 0; i < num; i++) {
+		rec = &recs[i];
+		if (cpu >= 0 && rec->cpu != cpu)
+			continue;
+		printf("%12.3f [%u] ", (double)(rec->ts - start) / 1000,
+		       rec->cpu);
+		if (rec->id < NUM_TRACE_POINTS) {
+			printf("%-16s ", trace_points[rec->id].name);
+			printf(trace_points[rec->id].fmt, rec->arg[0],
+			       rec->arg[1], rec->arg[2]);
+		} else {
+			printf("ID_%-13u 0x%x 0x%x 0x%x", rec->id, rec->arg[0],
+			       rec->arg[1], rec->arg[2]);
+		}
+		printf("\n");
+	}
+	free(recs);
+	return 0;
+}
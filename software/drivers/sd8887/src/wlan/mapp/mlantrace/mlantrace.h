@@ -0,0 +1,63 @@
+/** @file  mlantrace.h
+ *
+ *  @brief Header file for mlantrace application
+ *
+  *
+  * Copyright 2014-2020 NXP
+  *
+  * This software file (the File) is distributed by NXP
+  * under the terms of the GNU General Public License Version 2, June 1991
+  * (the License).  You may use, redistribute and/or modify the File in
+  * accordance with the terms and conditions of the License, a copy of which
+  * is available by writing to the Free Software Foundation, Inc.,
+  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA or on the
+  * worldwide web at http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+  *
+  * THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE
+  * IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE
+  * ARE EXPRESSLY DISCLAIMED.  The License provides additional details about
+  * this warranty disclaimer.
+  *
+  */
+/************************************************************************
+Change log:
+    10/16/2026: Initial creation
+************************************************************************/
+
+#ifndef _MLAN_TRACE_APP_H
+#define _MLAN_TRACE_APP_H
+
+/** Unsigned short integer */
+typedef unsigned short t_u16;
+/** Unsigned integer */
+typedef unsigned int t_u32;
+/** Unsigned long long integer */
+typedef unsigned long long t_u64;
+
+/** mlantrace version */
+#define MLAN_TRACE_VERSION	"1.0"
+
+/** Default trace file */
+#define MLAN_TRACE_PROC		"/proc/mwlan/trace"
+
+/** Hot-path trace record, as written by mlan/mlan_trace.c */
+typedef struct _trace_rec {
+    /** Timestamp in ns */
+	t_u64 ts;
+    /** Trace point id */
+	t_u16 id;
+    /** CPU the record was written on */
+	t_u16 cpu;
+    /** Trace point arguments */
+	t_u32 arg[3];
+} __attribute__ ((packed)) trace_rec;
+
+/** Trace point description */
+typedef struct _trace_point {
+    /** Trace point name */
+	const char *name;
+    /** printf format for the three arguments */
+	const char *fmt;
+} trace_point;
+
+#endif /* _MLAN_TRACE_APP_H */
@@ -205,6 +205,7 @@ static int process_cfgdata(int argc, char *argv[]);
 static int process_mgmtframetx(int argc, char *argv[]);
 static int process_mgmt_frame_passthrough(int argc, char *argv[]);
 static int process_qconfig(int argc, char *argv[]);
+static int process_aqmcfg(int argc, char *argv[]);
 static int process_addts(int argc, char *argv[]);
 static int process_delts(int argc, char *argv[]);
 static int process_wmm_qstatus(int argc, char *argv[]);
@@ -382,6 +383,7 @@ struct command_node command_list[] = {
 	{"mgmtframetx", process_mgmtframetx},
 	{"mgmtframectrl", process_mgmt_frame_passthrough},
 	{"qconfig", process_qconfig},
+	{"aqmcfg", process_aqmcfg},
 	{"addts", process_addts},
 	{"delts", process_delts},
 	{"ts_status", process_wmm_ts_status},
@@ -494,6 +496,7 @@ static char *usage[] = {
 	"         aggrpriotbl",
 	"         amsduaggrctrl",
 	"         antcfg",
+	"         aqmcfg",
 #ifdef STA_SUPPORT
 	"         arpfilter",
 #endif
@@ -7301,6 +7304,89 @@ process_bcntimeoutcfg(int argc, char *argv[])
 	return 0;
 }
 
+/**
+ *  @brief Process active queue management configuration of a WMM AC
+ *
+ *  Usage:
+ *    mlanutl mlanX aqmcfg <ac> [<mode> [<ecn> [<target> [<interval>]]]]
+ *
+ *  @param argc   Number of arguments
+ *  @param argv   A pointer to arguments array
+ *  @return     MLAN_STATUS_SUCCESS--success, otherwise--fail
+ */
+static int
+process_aqmcfg(int argc, char *argv[])
+{
+	t_u8 *buffer = NULL;
+	struct eth_priv_cmd *cmd = NULL;
+	struct ifreq ifr;
+	int *data;
+	const char *mode_str[] = { "off", "codel", "fq_codel" };
+
+	if (argc < 4 || argc > 8) {
+		printf("ERR:Incorrect number of arguments!\n");
+		printf("Syntax: ./mlanutl mlanX aqmcfg <ac> [<mode> [<ecn> [<target> [<interval>]]]]\n");
+		return MLAN_STATUS_FAILURE;
+	}
+
+	/* Initialize buffer */
+	buffer = (t_u8 *)malloc(BUFFER_LENGTH);
+	if (!buffer) {
+		printf("ERR:Cannot allocate buffer for command!\n");
+		return MLAN_STATUS_FAILURE;
+	}
+
+	prepare_buffer(buffer, argv[2], (argc - 3), &argv[3]);
+
+	cmd = (struct eth_priv_cmd *)malloc(sizeof(struct eth_priv_cmd));
+	if (!cmd) {
+		printf("ERR:Cannot allocate buffer for command!\n");
+		free(buffer);
+		return MLAN_STATUS_FAILURE;
+	}
+
+	/* Fill up buffer */
+#ifdef USERSPACE_32BIT_OVER_KERNEL_64BIT
+	memset(cmd, 0, sizeof(struct eth_priv_cmd));
+	memcpy(&cmd->buf, &buffer, sizeof(buffer));
+#else
+	cmd->buf = buffer;
+#endif
+	cmd->used_len = 0;
+	cmd->total_len = BUFFER_LENGTH;
+
+	/* Perform IOCTL */
+	memset(&ifr, 0, sizeof(struct ifreq));
+	strncpy(ifr.ifr_ifrn.ifrn_name, dev_name, strlen(dev_name));
+	ifr.ifr_ifru.ifru_data = (void *)cmd;
+
+	if (ioctl(sockfd, MLAN_ETH_PRIV, &ifr)) {
+		perror("mlanutl");
+		fprintf(stderr, "mlanutl: aqmcfg fail\n");
+		if (cmd)
+			free(cmd);
+		if (buffer)
+			free(buffer);
+		return MLAN_STATUS_FAILURE;
+	}
+
+	/* Process result */
+	data = (int *)buffer;
+	printf("AC %d: mode %s, ecn %s\n", data[0],
+	       (data[1] >= 0 && data[1] <= 2) ? mode_str[data[1]] : "unknown",
+	       data[2] ? "on" : "off");
+	printf("    target %d us, interval %d us\n", data[3], data[4]);
+	printf("    dropped %u, marked %u\n", (unsigned int)data[5],
+	       (unsigned int)data[6]);
+
+	if (buffer)
+		free(buffer);
+	if (cmd)
+		free(cmd);
+
+	return MLAN_STATUS_SUCCESS;
+}
+
 /**
  *  @brief Process sleeppd configuration
  *  @param argc   Number of arguments
@@ -2735,12 +2735,18 @@ void
 wlan_11n_delete_txbastream_tbl_entry(mlan_private *priv, TxBAStreamTbl *ptx_tbl)
 {
 	pmlan_adapter pmadapter = priv->adapter;
+	TxBAStreamTbl **pprev;
 
 	ENTER();
 
 	if (!ptx_tbl || !wlan_is_txbastreamptr_valid(priv, ptx_tbl))
 		goto exit;
 	PRINTM(MINFO, "Delete BA stream table entry: %p\n", ptx_tbl);
+	pprev = &priv->tx_ba_hash[MLAN_BA_HASH(ptx_tbl->ra, ptx_tbl->tid)];
+	while (*pprev && *pprev != ptx_tbl)
+		pprev = &(*pprev)->hnext;
+	if (*pprev)
+		*pprev = ptx_tbl->hnext;
 	util_unlink_list(pmadapter->pmoal_handle, &priv->tx_ba_stream_tbl_ptr,
 			 (pmlan_linked_list)ptx_tbl, MNULL, MNULL);
 	pmadapter->callbacks.moal_mfree(pmadapter->pmoal_handle,
@@ -2772,6 +2778,7 @@ wlan_11n_deleteall_txbastream_tbl(mlan_private *priv)
 	}
 
 	util_init_list((pmlan_linked_list)&priv->tx_ba_stream_tbl_ptr);
+	memset(priv->adapter, priv->tx_ba_hash, 0, sizeof(priv->tx_ba_hash));
 	wlan_release_ralist_lock(priv);
 	for (i = 0; i < MAX_NUM_TID; ++i) {
 		priv->aggr_prio_tbl[i].ampdu_ap =
@@ -2803,17 +2810,8 @@ wlan_11n_get_txbastream_tbl(mlan_private *priv, int tid, t_u8 *ra, int lock)
 
 	if (lock)
 		wlan_request_ralist_lock(priv);
-	ptx_tbl = (TxBAStreamTbl *)util_peek_list(pmadapter->pmoal_handle,
-						  &priv->tx_ba_stream_tbl_ptr,
-						  MNULL, MNULL);
-	if (!ptx_tbl) {
-		if (lock)
-			wlan_release_ralist_lock(priv);
-		LEAVE();
-		return MNULL;
-	}
-
-	while (ptx_tbl != (TxBAStreamTbl *)&priv->tx_ba_stream_tbl_ptr) {
+	ptx_tbl = priv->tx_ba_hash[MLAN_BA_HASH(ra, tid)];
+	while (ptx_tbl) {
 
 		PRINTM(MDAT_D, "get_txbastream_tbl TID %d\n", ptx_tbl->tid);
 		DBG_HEXDUMP(MDAT_D, "RA", ptx_tbl->ra, MLAN_MAC_ADDR_LENGTH);
@@ -2826,7 +2824,7 @@ wlan_11n_get_txbastream_tbl(mlan_private *priv, int tid, t_u8 *ra, int lock)
 			return ptx_tbl;
 		}
 
-		ptx_tbl = ptx_tbl->pnext;
+		ptx_tbl = ptx_tbl->hnext;
 	}
 	if (lock)
 		wlan_release_ralist_lock(priv);
@@ -2853,6 +2851,7 @@ wlan_11n_create_txbastream_tbl(mlan_private *priv,
 	pmlan_adapter pmadapter = priv->adapter;
 	raListTbl *ra_list = MNULL;
 	int tid_down;
+	int idx;
 
 	ENTER();
 
@@ -2878,6 +2877,9 @@ wlan_11n_create_txbastream_tbl(mlan_private *priv,
 	new_node->tid = tid;
 	new_node->ba_status = ba_status;
 	memcpy(pmadapter, new_node->ra, ra, MLAN_MAC_ADDR_LENGTH);
+	idx = MLAN_BA_HASH(ra, tid);
+	new_node->hnext = priv->tx_ba_hash[idx];
+	priv->tx_ba_hash[idx] = new_node;
 
 	util_enqueue_list_tail(pmadapter->pmoal_handle,
 			       &priv->tx_ba_stream_tbl_ptr,
@@ -3046,7 +3048,10 @@ wlan_get_rxreorder_tbl(mlan_private *priv, rx_reorder_tbl *buf)
 		ptbl->win_size = rx_reorder_tbl_ptr->win_size;
 		ptbl->amsdu = rx_reorder_tbl_ptr->amsdu;
 		for (i = 0; i < rx_reorder_tbl_ptr->win_size; ++i) {
-			if (rx_reorder_tbl_ptr->rx_reorder_ptr[i])
+			if (rx_reorder_tbl_ptr->
+			    rx_reorder_ptr[RX_REORDER_SLOT(rx_reorder_tbl_ptr,
+							   rx_reorder_tbl_ptr->
+							   start_win + i)])
 				ptbl->buffer[i] = MTRUE;
 			else
 				ptbl->buffer[i] = MFALSE;
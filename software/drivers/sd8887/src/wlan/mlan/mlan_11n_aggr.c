@@ -47,21 +47,20 @@ Change log:
 			Local Functions
 ********************************************************/
 /**
- *  @brief Aggregate individual packets into one AMSDU packet
+ *  @brief Form the AMSDU subframe header of one packet
  *
  *  @param pmadapter A pointer to mlan_adapter structure
- *  @param amsdu_buf A pointer to packet buffer
- *  @param data      A pointer to aggregated data packet being formed
- *  @param pkt_len   Length of current packet to aggregate
- *  @param pad       Pad
+ *  @param amsdu_buf A pointer to subframe header being formed
+ *  @param data      A pointer to the packet to aggregate
+ *  @param pkt_len   Length of the packet to aggregate
  *
- *  @return         Final packet size
+ *  @return         Subframe header length
  */
 static int
-wlan_11n_form_amsdu_pkt(pmlan_adapter pmadapter, t_u8 *amsdu_buf, t_u8 *data,
-			int pkt_len, int *pad)
+wlan_11n_form_amsdu_hdr(pmlan_adapter pmadapter, t_u8 *amsdu_buf, t_u8 *data,
+			int pkt_len)
 {
-	int dt_offset, amsdu_buf_offset;
+	int amsdu_buf_offset;
 	Rfc1042Hdr_t snap = {
 		0xaa,		/* LLC DSAP */
 		0xaa,		/* LLC SSAP */
@@ -74,13 +73,10 @@ wlan_11n_form_amsdu_pkt(pmlan_adapter pmadapter, t_u8 *amsdu_buf, t_u8 *data,
 			 */
 	};
 
-	ENTER();
-
 	memcpy(pmadapter, amsdu_buf, data, (MLAN_MAC_ADDR_LENGTH) * 2);
-	dt_offset = amsdu_buf_offset = (MLAN_MAC_ADDR_LENGTH) * 2;
+	amsdu_buf_offset = (MLAN_MAC_ADDR_LENGTH) * 2;
 
-	snap.snap_type = *(t_u16 *)(data + dt_offset);
-	dt_offset += sizeof(t_u16);
+	snap.snap_type = *(t_u16 *)(data + amsdu_buf_offset);
 	*(t_u16 *)(amsdu_buf + amsdu_buf_offset) = mlan_htons(pkt_len +
 							      LLC_SNAP_LEN -
 							      ((2 *
@@ -91,6 +87,32 @@ wlan_11n_form_amsdu_pkt(pmlan_adapter pmadapter, t_u8 *amsdu_buf, t_u8 *data,
 	memcpy(pmadapter, amsdu_buf + amsdu_buf_offset, &snap, LLC_SNAP_LEN);
 	amsdu_buf_offset += LLC_SNAP_LEN;
 
+	return amsdu_buf_offset;
+}
+
+/**
+ *  @brief Aggregate individual packets into one AMSDU packet
+ *
+ *  @param pmadapter A pointer to mlan_adapter structure
+ *  @param amsdu_buf A pointer to packet buffer
+ *  @param data      A pointer to aggregated data packet being formed
+ *  @param pkt_len   Length of current packet to aggregate
+ *  @param pad       Pad
+ *
+ *  @return         Final packet size
+ */
+static int
+wlan_11n_form_amsdu_pkt(pmlan_adapter pmadapter, t_u8 *amsdu_buf, t_u8 *data,
+			int pkt_len, int *pad)
+{
+	int dt_offset, amsdu_buf_offset;
+
+	ENTER();
+
+	amsdu_buf_offset = wlan_11n_form_amsdu_hdr(pmadapter, amsdu_buf, data,
+						   pkt_len);
+	dt_offset = (MLAN_MAC_ADDR_LENGTH) * 2 + sizeof(t_u16);
+
 	memcpy(pmadapter, amsdu_buf + amsdu_buf_offset, data + dt_offset,
 	       pkt_len - dt_offset);
 	*pad = (((pkt_len + LLC_SNAP_LEN) & 3)) ? (4 -
@@ -101,6 +123,54 @@ wlan_11n_form_amsdu_pkt(pmlan_adapter pmadapter, t_u8 *amsdu_buf, t_u8 *data,
 	return pkt_len + LLC_SNAP_LEN + *pad;
 }
 
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+/**
+ *  @brief Add one packet to a scatter-gather AMSDU. The subframe header
+ *  goes into the header arena, the payload stays in the source buffer.
+ *
+ *  @param pmadapter A pointer to mlan_adapter structure
+ *  @param arena     A pointer to the AMSDU header arena
+ *  @param pmbuf_src A pointer to the packet to aggregate
+ *  @param pad       Pad of the previous subframe on entry,
+ *                   pad of this subframe on return
+ *
+ *  @return         Final packet size
+ */
+static int
+wlan_11n_form_amsdu_sg_pkt(pmlan_adapter pmadapter, amsdu_sg_arena *arena,
+			   pmlan_buffer pmbuf_src, int *pad)
+{
+	t_u8 *data = pmbuf_src->pbuf + pmbuf_src->data_offset;
+	int pkt_len = pmbuf_src->data_len;
+	int dt_offset = (MLAN_MAC_ADDR_LENGTH) * 2 + sizeof(t_u16);
+	mlan_buf_frag *frag = &arena->frag[arena->body_frags];
+
+	ENTER();
+
+	if (arena->num_msdu) {
+		/* Previous subframe padding leads this header fragment */
+		frag->pdata = arena->hdr + arena->hdr_len;
+		arena->hdr_len += *pad;
+	}
+	arena->hdr_len += wlan_11n_form_amsdu_hdr(pmadapter,
+						  arena->hdr + arena->hdr_len,
+						  data, pkt_len);
+	frag->len = (t_u32)(arena->hdr + arena->hdr_len - frag->pdata);
+	frag++;
+	frag->pdata = data + dt_offset;
+	frag->len = pkt_len - dt_offset;
+	arena->body_frags += 2;
+	arena->msdu[arena->num_msdu++] = pmbuf_src;
+
+	*pad = (((pkt_len + LLC_SNAP_LEN) & 3)) ? (4 -
+						   (((pkt_len +
+						      LLC_SNAP_LEN)) & 3)) : 0;
+
+	LEAVE();
+	return pkt_len + LLC_SNAP_LEN + *pad;
+}
+#endif /* SDIO_MULTI_PORT_TX_AGGR */
+
 /**
  *  @brief Add TxPD to AMSDU header
  *
@@ -280,9 +350,11 @@ wlan_11n_deaggregate_pkt(mlan_private *priv, pmlan_buffer pmbuf)
 				= (t_u16)0;
 			pkt_len += sizeof(Eth803Hdr_t);
 		}
+		/* Headroom lets uAP forward the MSDU without a copy */
 		daggr_mbuf =
 			wlan_alloc_mlan_buffer(pmadapter,
-					       pkt_len + MLAN_NET_IP_ALIGN, 0,
+					       pkt_len + MLAN_NET_IP_ALIGN,
+					       MLAN_RX_HEADER_LEN,
 					       MOAL_ALLOC_MLAN_BUFFER);
 		if (daggr_mbuf == MNULL) {
 			PRINTM(MERROR, "Error allocating daggr mlan_buffer\n");
@@ -400,6 +472,9 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 	mlan_tx_param tx_param;
 #ifdef STA_SUPPORT
 	TxPD *ptx_pd = MNULL;
+#endif
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+	amsdu_sg_arena *arena = MNULL;
 #endif
 	t_u32 max_amsdu_size = MIN(pra_list->max_amsdu, pmadapter->tx_buf_size);
 	ENTER();
@@ -410,9 +485,19 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 		(pmlan_buffer)util_peek_list(pmadapter->pmoal_handle,
 					     &pra_list->buf_head, MNULL, MNULL);
 	if (pmbuf_src) {
-		pmbuf_aggr = wlan_alloc_mlan_buffer(pmadapter,
-						    pmadapter->tx_buf_size, 0,
-						    MOAL_MALLOC_BUFFER);
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+		/* Payloads stay in the source buffers in TX SG mode */
+		if (pmadapter->amsdu_sg && !pmadapter->mpa_tx.buf)
+			pmbuf_aggr = wlan_alloc_mlan_buffer(pmadapter,
+							    sizeof
+							    (amsdu_sg_arena), 0,
+							    MOAL_MALLOC_BUFFER);
+		else
+#endif
+			pmbuf_aggr = wlan_alloc_mlan_buffer(pmadapter,
+							    pmadapter->
+							    tx_buf_size, 0,
+							    MOAL_MALLOC_BUFFER);
 		if (!pmbuf_aggr) {
 			PRINTM(MERROR, "Error allocating mlan_buffer\n");
 			pmadapter->callbacks.moal_spin_unlock(pmadapter->
@@ -423,7 +508,18 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 			return MLAN_STATUS_FAILURE;
 		}
 
-		data = pmbuf_aggr->pbuf + headroom;
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+		if (pmadapter->amsdu_sg && !pmadapter->mpa_tx.buf) {
+			arena = (amsdu_sg_arena *)pmbuf_aggr->pbuf;
+			memset(pmadapter, arena, 0, sizeof(amsdu_sg_arena));
+			arena->frag[0].pdata = arena->hdr;
+			arena->hdr_len = headroom + sizeof(TxPD);
+			pmbuf_aggr->pfrag = arena->frag;
+			pmbuf_aggr->flags |= MLAN_BUF_FLAG_SG;
+			data = arena->hdr + headroom;
+		} else
+#endif
+			data = pmbuf_aggr->pbuf + headroom;
 		pmbuf_aggr->bss_index = pmbuf_src->bss_index;
 		pmbuf_aggr->buf_type = pmbuf_src->buf_type;
 		pmbuf_aggr->priority = pmbuf_src->priority;
@@ -431,6 +527,12 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 		pmbuf_aggr->data_offset = 0;
 		pmbuf_aggr->in_ts_sec = pmbuf_src->in_ts_sec;
 		pmbuf_aggr->in_ts_usec = pmbuf_src->in_ts_usec;
+		/*
+		 * The AMSDU is stamped on behalf of its MSDUs, which copy
+		 * the stamps back when they complete
+		 */
+		memcpy(pmadapter, pmbuf_aggr->tx_ts, pmbuf_src->tx_ts,
+		       sizeof(pmbuf_aggr->tx_ts));
 		if (pmbuf_src->flags & MLAN_BUF_FLAG_TDLS)
 			pmbuf_aggr->flags |= MLAN_BUF_FLAG_TDLS;
 		if (pmbuf_src->flags & MLAN_BUF_FLAG_TCP_ACK)
@@ -452,7 +554,11 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 	}
 
 	while (pmbuf_src && ((pkt_size + (pmbuf_src->data_len + LLC_SNAP_LEN)
-			      + headroom) <= max_amsdu_size)) {
+			      + headroom) <= max_amsdu_size)
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+	       && (!arena || arena->num_msdu < MLAN_AMSDU_SG_MAX_MSDU)
+#endif
+		) {
 
 		pmbuf_src = (pmlan_buffer)
 			util_dequeue_list(pmadapter->pmoal_handle,
@@ -462,6 +568,7 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 
 		/* decrement for every PDU taken from the list */
 		priv->wmm.pkts_queued[ptrindex]--;
+		wlan_wmm_update_prio_bitmap(priv, ptrindex);
 		util_scalar_decrement(pmadapter->pmoal_handle,
 				      &priv->wmm.tx_pkts_queued, MNULL, MNULL);
 
@@ -469,6 +576,13 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 						      priv->wmm.
 						      ra_list_spinlock);
 
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+		if (pmbuf_src && arena) {
+			/* Completed along with pmbuf_aggr */
+			pkt_size += wlan_11n_form_amsdu_sg_pkt(pmadapter, arena,
+							       pmbuf_src, &pad);
+		} else
+#endif
 		if (pmbuf_src) {
 			pkt_size += wlan_11n_form_amsdu_pkt(pmadapter,
 							    (data + pkt_size),
@@ -480,6 +594,7 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 
 			DBG_HEXDUMP(MDAT_D, "pmbuf_src", pmbuf_src,
 				    sizeof(mlan_buffer));
+			wlan_tx_lat_copy_back(pmbuf_aggr, pmbuf_src);
 			wlan_write_data_complete(pmadapter, pmbuf_src,
 						 MLAN_STATUS_SUCCESS);
 		}
@@ -491,6 +606,8 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 							      pmoal_handle,
 							      priv->wmm.
 							      ra_list_spinlock);
+			wlan_write_data_complete(pmadapter, pmbuf_aggr,
+						 MLAN_STATUS_FAILURE);
 			LEAVE();
 			return MLAN_STATUS_FAILURE;
 		}
@@ -511,6 +628,15 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 	wlan_11n_update_pktlen_amsdu_txpd(priv, pmbuf_aggr);
 	pmbuf_aggr->data_len += headroom;
 	pmbuf_aggr->pbuf = data - headroom;
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+	if (arena) {
+		/* Block padding fragment, sized by the SDIO layer */
+		arena->frag[arena->body_frags].pdata =
+			arena->hdr + arena->hdr_len;
+		arena->body_len = pmbuf_aggr->data_len;
+		pmbuf_aggr->frag_cnt = arena->body_frags;
+	}
+#endif
 	tx_param.next_pkt_len = ((pmbuf_src) ?
 				 pmbuf_src->data_len + sizeof(TxPD) : 0);
 	ret = wlan_sdio_host_to_card(pmadapter, MLAN_TYPE_DATA,
@@ -549,6 +675,7 @@ wlan_11n_aggregate_pkt(mlan_private *priv, raListTbl *pra_list,
 
 		/* add back only one: aggregated packet is requeued as one */
 		priv->wmm.pkts_queued[ptrindex]++;
+		wlan_wmm_update_prio_bitmap(priv, ptrindex);
 		util_scalar_increment(pmadapter->pmoal_handle,
 				      &priv->wmm.tx_pkts_queued, MNULL, MNULL);
 		pmbuf_aggr->flags |= MLAN_BUF_FLAG_REQUEUED_PKT;
@@ -34,6 +34,7 @@ Change log:
 #include "mlan_wmm.h"
 #include "mlan_11n.h"
 #include "mlan_11n_rxreorder.h"
+#include "mlan_trace.h"
 
 /********************************************************
 			Local Variables
@@ -90,16 +91,16 @@ wlan_11n_dispatch_pkt(t_void *priv, t_void *payload,
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 	pmlan_adapter pmadapter = ((pmlan_private)priv)->adapter;
 
-	ENTER();
+	HOT_ENTER();
 	if (payload == (t_void *)RX_PKT_DROPPED_IN_FW) {
-		LEAVE();
+		HOT_LEAVE();
 		return ret;
 	}
 	if (ISSUPP_RSN_REPLAY_DETECTION(pmadapter->fw_cap_info) &&
 	    rx_reor_tbl_ptr &&
 	    wlan_is_rsn_replay_attack((mlan_private *)priv, payload,
 				      rx_reor_tbl_ptr)) {
-		LEAVE();
+		HOT_LEAVE();
 		return ret;
 	}
 #ifdef UAP_SUPPORT
@@ -107,11 +108,11 @@ wlan_11n_dispatch_pkt(t_void *priv, t_void *payload,
 		if (MLAN_STATUS_SUCCESS ==
 		    wlan_11n_dispatch_amsdu_pkt((mlan_private *)priv,
 						(pmlan_buffer)payload)) {
-			LEAVE();
+			HOT_LEAVE();
 			return ret;
 		}
 		ret = wlan_process_uap_rx_packet(priv, (pmlan_buffer)payload);
-		LEAVE();
+		HOT_LEAVE();
 		return ret;
 	}
 #endif /* UAP_SUPPORT */
@@ -120,12 +121,12 @@ wlan_11n_dispatch_pkt(t_void *priv, t_void *payload,
 	if (MLAN_STATUS_SUCCESS ==
 	    wlan_11n_dispatch_amsdu_pkt((mlan_private *)priv,
 					(pmlan_buffer)payload)) {
-		LEAVE();
+		HOT_LEAVE();
 		return ret;
 	}
 	ret = wlan_process_rx_packet(pmadapter, (pmlan_buffer)payload);
 #endif /* STA_SUPPORT */
-	LEAVE();
+	HOT_LEAVE();
 	return ret;
 }
 
@@ -163,6 +164,82 @@ mlan_11n_rxreorder_timer_restart(pmlan_adapter pmadapter,
 	LEAVE();
 }
 
+/**
+ *  @brief This function detaches the packets in the given number of
+ *         slots from start_win into a chain, moving start_win past them.
+ *         Holes and packets dropped in firmware are skipped.
+ *
+ *  Caller must hold rx_pkt_lock.
+ *
+ *  @param rx_reor_tbl_ptr  A pointer to structure RxReorderTbl
+ *  @param count            Number of slots to detach
+ *  @param pkt_cnt          A pointer to return the number of packets
+ *
+ *  @return                 Head of the packet chain or MNULL
+ */
+static pmlan_buffer
+wlan_11n_detach_pkt_chain(RxReorderTbl *rx_reor_tbl_ptr, int count,
+			  int *pkt_cnt)
+{
+	pmlan_buffer head = MNULL, tail = MNULL, pmbuf;
+	int i, slot;
+
+	*pkt_cnt = 0;
+	for (i = 0; i < count; ++i) {
+		slot = RX_REORDER_SLOT(rx_reor_tbl_ptr,
+				       rx_reor_tbl_ptr->start_win + i);
+		pmbuf = (pmlan_buffer)rx_reor_tbl_ptr->rx_reorder_ptr[slot];
+		rx_reor_tbl_ptr->rx_reorder_ptr[slot] = MNULL;
+		if (!pmbuf || pmbuf == (pmlan_buffer)RX_PKT_DROPPED_IN_FW)
+			continue;
+		pmbuf->pnext = MNULL;
+		if (tail)
+			tail->pnext = pmbuf;
+		else
+			head = pmbuf;
+		tail = pmbuf;
+		(*pkt_cnt)++;
+	}
+	return head;
+}
+
+/**
+ *  @brief This function forwards a chain of packets released from the
+ *         reorder window. When more than one packet is released, MOAL
+ *         is asked to deliver them to the stack as a single batch.
+ *
+ *  @param priv             A pointer to mlan_private
+ *  @param pmbuf            Head of the packet chain
+ *  @param pkt_cnt          Number of packets in the chain
+ *  @param rx_reor_tbl_ptr  A pointer to structure RxReorderTbl
+ *
+ *  @return                 N/A
+ */
+static t_void
+wlan_11n_dispatch_pkt_chain(t_void *priv, pmlan_buffer pmbuf, int pkt_cnt,
+			    RxReorderTbl *rx_reor_tbl_ptr)
+{
+	pmlan_adapter pmadapter = ((pmlan_private)priv)->adapter;
+	pmlan_buffer pnext;
+	t_u8 batch;
+
+	ENTER();
+	batch = (pkt_cnt > 1) && pmadapter->callbacks.moal_recv_batch;
+	if (batch)
+		pmadapter->callbacks.moal_recv_batch(pmadapter->pmoal_handle,
+						     MTRUE);
+	while (pmbuf) {
+		pnext = pmbuf->pnext;
+		pmbuf->pnext = MNULL;
+		wlan_11n_dispatch_pkt(priv, pmbuf, rx_reor_tbl_ptr);
+		pmbuf = pnext;
+	}
+	if (batch)
+		pmadapter->callbacks.moal_recv_batch(pmadapter->pmoal_handle,
+						     MFALSE);
+	LEAVE();
+}
+
 /**
  *  @brief This function dispatches all the packets in the buffer.
  *         There could be holes in the buffer.
@@ -178,9 +255,9 @@ wlan_11n_dispatch_pkt_until_start_win(t_void *priv,
 				      RxReorderTbl *rx_reor_tbl_ptr,
 				      int start_win)
 {
-	int no_pkt_to_send, i, xchg;
+	int no_pkt_to_send, pkt_cnt;
 	mlan_status ret = MLAN_STATUS_SUCCESS;
-	void *rx_tmp_ptr = MNULL;
+	pmlan_buffer pmbuf;
 	mlan_private *pmpriv = (mlan_private *)priv;
 
 	ENTER();
@@ -189,42 +266,21 @@ wlan_11n_dispatch_pkt_until_start_win(t_void *priv,
 		MIN((start_win - rx_reor_tbl_ptr->start_win),
 		    rx_reor_tbl_ptr->win_size) : rx_reor_tbl_ptr->win_size;
 
-	for (i = 0; i < no_pkt_to_send; ++i) {
-		pmpriv->adapter->callbacks.moal_spin_lock(pmpriv->adapter->
-							  pmoal_handle,
-							  pmpriv->rx_pkt_lock);
-		rx_tmp_ptr = MNULL;
-		if (rx_reor_tbl_ptr->rx_reorder_ptr[i]) {
-			rx_tmp_ptr = rx_reor_tbl_ptr->rx_reorder_ptr[i];
-			rx_reor_tbl_ptr->rx_reorder_ptr[i] = MNULL;
-		}
-		pmpriv->adapter->callbacks.moal_spin_unlock(pmpriv->adapter->
-							    pmoal_handle,
-							    pmpriv->
-							    rx_pkt_lock);
-		if (rx_tmp_ptr)
-			wlan_11n_dispatch_pkt(priv, rx_tmp_ptr,
-					      rx_reor_tbl_ptr);
-	}
-
-	pmpriv->adapter->callbacks.moal_spin_lock(pmpriv->adapter->pmoal_handle,
-						  pmpriv->rx_pkt_lock);
 	/*
-	 * We don't have a circular buffer, hence use rotation to simulate
-	 * circular buffer
+	 * Slots are indexed by sequence number, so packets still inside
+	 * the new window stay where they are; only start_win moves.
 	 */
-	xchg = rx_reor_tbl_ptr->win_size - no_pkt_to_send;
-	for (i = 0; i < xchg; ++i) {
-		rx_reor_tbl_ptr->rx_reorder_ptr[i] =
-			rx_reor_tbl_ptr->rx_reorder_ptr[no_pkt_to_send + i];
-		rx_reor_tbl_ptr->rx_reorder_ptr[no_pkt_to_send + i] = MNULL;
-	}
-
+	pmpriv->adapter->callbacks.moal_spin_lock(pmpriv->adapter->pmoal_handle,
+						  pmpriv->rx_pkt_lock);
+	pmbuf = wlan_11n_detach_pkt_chain(rx_reor_tbl_ptr, no_pkt_to_send,
+					  &pkt_cnt);
 	rx_reor_tbl_ptr->start_win = start_win;
 	pmpriv->adapter->callbacks.moal_spin_unlock(pmpriv->adapter->
 						    pmoal_handle,
 						    pmpriv->rx_pkt_lock);
 
+	wlan_11n_dispatch_pkt_chain(priv, pmbuf, pkt_cnt, rx_reor_tbl_ptr);
+
 	LEAVE();
 	return ret;
 }
@@ -243,7 +299,7 @@ wlan_11n_display_tbl_ptr(pmlan_adapter pmadapter, RxReorderTbl *rx_reor_tbl_ptr)
 	ENTER();
 
 	DBG_HEXDUMP(MDAT_D, "Reorder ptr", rx_reor_tbl_ptr->rx_reorder_ptr,
-		    sizeof(t_void *) * rx_reor_tbl_ptr->win_size);
+		    sizeof(t_void *) * (rx_reor_tbl_ptr->ring_mask + 1));
 
 	LEAVE();
 }
@@ -261,59 +317,85 @@ wlan_11n_display_tbl_ptr(pmlan_adapter pmadapter, RxReorderTbl *rx_reor_tbl_ptr)
 static mlan_status
 wlan_11n_scan_and_dispatch(t_void *priv, RxReorderTbl *rx_reor_tbl_ptr)
 {
-	int i, j, xchg;
+	int i, pkt_cnt;
 	mlan_status ret = MLAN_STATUS_SUCCESS;
-	void *rx_tmp_ptr = MNULL;
+	pmlan_buffer pmbuf;
 	mlan_private *pmpriv = (mlan_private *)priv;
 
-	ENTER();
-
-	for (i = 0; i < rx_reor_tbl_ptr->win_size; ++i) {
-		pmpriv->adapter->callbacks.moal_spin_lock(pmpriv->adapter->
-							  pmoal_handle,
-							  pmpriv->rx_pkt_lock);
-		if (!rx_reor_tbl_ptr->rx_reorder_ptr[i]) {
-			pmpriv->adapter->callbacks.moal_spin_unlock(pmpriv->
-								    adapter->
-								    pmoal_handle,
-								    pmpriv->
-								    rx_pkt_lock);
-			break;
-		}
-		rx_tmp_ptr = rx_reor_tbl_ptr->rx_reorder_ptr[i];
-		rx_reor_tbl_ptr->rx_reorder_ptr[i] = MNULL;
-		pmpriv->adapter->callbacks.moal_spin_unlock(pmpriv->adapter->
-							    pmoal_handle,
-							    pmpriv->
-							    rx_pkt_lock);
-		wlan_11n_dispatch_pkt(priv, rx_tmp_ptr, rx_reor_tbl_ptr);
-	}
+	HOT_ENTER();
 
 	pmpriv->adapter->callbacks.moal_spin_lock(pmpriv->adapter->pmoal_handle,
 						  pmpriv->rx_pkt_lock);
-	/*
-	 * We don't have a circular buffer, hence use rotation to simulate
-	 * circular buffer
-	 */
-	if (i > 0) {
-		xchg = rx_reor_tbl_ptr->win_size - i;
-		for (j = 0; j < xchg; ++j) {
-			rx_reor_tbl_ptr->rx_reorder_ptr[j] =
-				rx_reor_tbl_ptr->rx_reorder_ptr[i + j];
-			rx_reor_tbl_ptr->rx_reorder_ptr[i + j] = MNULL;
-		}
+	for (i = 0; i < rx_reor_tbl_ptr->win_size; ++i) {
+		if (!rx_reor_tbl_ptr->
+		    rx_reorder_ptr[RX_REORDER_SLOT(rx_reor_tbl_ptr,
+						   rx_reor_tbl_ptr->start_win +
+						   i)])
+			break;
 	}
-
+	pmbuf = wlan_11n_detach_pkt_chain(rx_reor_tbl_ptr, i, &pkt_cnt);
 	rx_reor_tbl_ptr->start_win = (rx_reor_tbl_ptr->start_win + i)
 		& (MAX_TID_VALUE - 1);
-
 	pmpriv->adapter->callbacks.moal_spin_unlock(pmpriv->adapter->
 						    pmoal_handle,
 						    pmpriv->rx_pkt_lock);
-	LEAVE();
+
+	wlan_11n_dispatch_pkt_chain(priv, pmbuf, pkt_cnt, rx_reor_tbl_ptr);
+
+	HOT_LEAVE();
 	return ret;
 }
 
+/**
+ *  @brief This function links a rxreorder table entry into the TA/TID hash
+ *
+ *  @param priv             A pointer to mlan_private
+ *  @param rx_reor_tbl_ptr  A pointer to structure RxReorderTbl
+ *
+ *  @return                 N/A
+ */
+static t_void
+wlan_11n_hash_rxreorder_tbl(mlan_private *priv, RxReorderTbl *rx_reor_tbl_ptr)
+{
+	pmlan_adapter pmadapter = priv->adapter;
+	int idx = MLAN_BA_HASH(rx_reor_tbl_ptr->ta, rx_reor_tbl_ptr->tid);
+
+	pmadapter->callbacks.moal_spin_lock(pmadapter->pmoal_handle,
+					    priv->rx_reorder_tbl_ptr.plock);
+	rx_reor_tbl_ptr->hnext = priv->rx_reorder_hash[idx];
+	priv->rx_reorder_hash[idx] = rx_reor_tbl_ptr;
+	pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
+					      priv->rx_reorder_tbl_ptr.plock);
+}
+
+/**
+ *  @brief This function unlinks a rxreorder table entry from the TA/TID hash
+ *
+ *  @param priv             A pointer to mlan_private
+ *  @param rx_reor_tbl_ptr  A pointer to structure RxReorderTbl
+ *
+ *  @return                 N/A
+ */
+static t_void
+wlan_11n_unhash_rxreorder_tbl(mlan_private *priv,
+			      RxReorderTbl *rx_reor_tbl_ptr)
+{
+	pmlan_adapter pmadapter = priv->adapter;
+	RxReorderTbl **pprev;
+
+	pmadapter->callbacks.moal_spin_lock(pmadapter->pmoal_handle,
+					    priv->rx_reorder_tbl_ptr.plock);
+	pprev = &priv->rx_reorder_hash[MLAN_BA_HASH(rx_reor_tbl_ptr->ta,
+						    rx_reor_tbl_ptr->tid)];
+	while (*pprev && *pprev != rx_reor_tbl_ptr)
+		pprev = &(*pprev)->hnext;
+	if (*pprev)
+		*pprev = rx_reor_tbl_ptr->hnext;
+	rx_reor_tbl_ptr->hnext = MNULL;
+	pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
+					      priv->rx_reorder_tbl_ptr.plock);
+}
+
 /**
  *  @brief This function delete rxreorder table's entry
  *          and free the memory
@@ -358,6 +440,7 @@ wlan_11n_delete_rxreorder_tbl_entry(mlan_private *priv,
 	}
 
 	PRINTM(MDAT_D, "Delete rx_reor_tbl_ptr: %p\n", rx_reor_tbl_ptr);
+	wlan_11n_unhash_rxreorder_tbl(priv, rx_reor_tbl_ptr);
 	util_unlink_list(pmadapter->pmoal_handle,
 			 &priv->rx_reorder_tbl_ptr,
 			 (pmlan_linked_list)rx_reor_tbl_ptr,
@@ -388,7 +471,10 @@ wlan_11n_find_last_seqnum(RxReorderTbl *rx_reorder_tbl_ptr)
 
 	ENTER();
 	for (i = (rx_reorder_tbl_ptr->win_size - 1); i >= 0; --i) {
-		if (rx_reorder_tbl_ptr->rx_reorder_ptr[i]) {
+		if (rx_reorder_tbl_ptr->
+		    rx_reorder_ptr[RX_REORDER_SLOT(rx_reorder_tbl_ptr,
+						   rx_reorder_tbl_ptr->
+						   start_win + i)]) {
 			LEAVE();
 			return i;
 		}
@@ -464,7 +550,7 @@ static t_void
 wlan_11n_create_rxreorder_tbl(mlan_private *priv, t_u8 *ta, int tid,
 			      int win_size, int seq_num)
 {
-	int i;
+	int i, ring_size;
 	pmlan_adapter pmadapter = priv->adapter;
 	RxReorderTbl *rx_reor_tbl_ptr, *new_node;
 	sta_node *sta_ptr = MNULL;
@@ -497,9 +583,13 @@ wlan_11n_create_rxreorder_tbl(mlan_private *priv, t_u8 *ta, int tid,
 	}
 
 	util_init_list((pmlan_linked_list)new_node);
+	/* Power of two ring so a sequence number maps straight to its slot */
+	ring_size = 1;
+	while (ring_size < win_size)
+		ring_size <<= 1;
 	if (pmadapter->callbacks.
 	    moal_malloc(pmadapter->pmoal_handle,
-			sizeof(pmlan_buffer) * win_size, MLAN_MEM_DEF,
+			sizeof(pmlan_buffer) * ring_size, MLAN_MEM_DEF,
 			(t_u8 **)&new_node->rx_reorder_ptr)) {
 		PRINTM(MERROR, "Rx reorder table memory allocation" "failed\n");
 		pmadapter->callbacks.moal_mfree(pmadapter->pmoal_handle,
@@ -524,6 +614,7 @@ wlan_11n_create_rxreorder_tbl(mlan_private *priv, t_u8 *ta, int tid,
 			       pmadapter->callbacks.moal_spin_unlock);
 	new_node->tid = tid;
 	memcpy(pmadapter, new_node->ta, ta, MLAN_MAC_ADDR_LENGTH);
+	wlan_11n_hash_rxreorder_tbl(priv, new_node);
 	new_node->start_win = seq_num;
 	new_node->pkt_count = 0;
 	if (queuing_ra_based(priv)) {
@@ -543,10 +634,11 @@ wlan_11n_create_rxreorder_tbl(mlan_private *priv, t_u8 *ta, int tid,
 	}
 	new_node->last_seq = last_seq;
 	new_node->win_size = win_size;
+	new_node->ring_mask = ring_size - 1;
 	new_node->force_no_drop = MFALSE;
 	new_node->check_start_win = MTRUE;
 	new_node->ba_status = BA_STREAM_SETUP_INPROGRESS;
-	for (i = 0; i < win_size; ++i)
+	for (i = 0; i < ring_size; ++i)
 		new_node->rx_reorder_ptr[i] = MNULL;
 	new_node->hi_curr_rx_count32 = 0xffffffff;
 	new_node->lo_curr_rx_count16 = 0;
@@ -573,29 +665,21 @@ wlan_11n_get_rxreorder_tbl(mlan_private *priv, int tid, t_u8 *ta)
 {
 	RxReorderTbl *rx_reor_tbl_ptr;
 
-	ENTER();
-
-	rx_reor_tbl_ptr =
-		(RxReorderTbl *)util_peek_list(priv->adapter->pmoal_handle,
-					       &priv->rx_reorder_tbl_ptr, MNULL,
-					       MNULL);
-	if (!rx_reor_tbl_ptr) {
-		LEAVE();
-		return MNULL;
-	}
+	HOT_ENTER();
 
-	while (rx_reor_tbl_ptr != (RxReorderTbl *)&priv->rx_reorder_tbl_ptr) {
+	rx_reor_tbl_ptr = priv->rx_reorder_hash[MLAN_BA_HASH(ta, tid)];
+	while (rx_reor_tbl_ptr) {
 		if ((!memcmp
 		     (priv->adapter, rx_reor_tbl_ptr->ta, ta,
 		      MLAN_MAC_ADDR_LENGTH)) && (rx_reor_tbl_ptr->tid == tid)) {
-			LEAVE();
+			HOT_LEAVE();
 			return rx_reor_tbl_ptr;
 		}
 
-		rx_reor_tbl_ptr = rx_reor_tbl_ptr->pnext;
+		rx_reor_tbl_ptr = rx_reor_tbl_ptr->hnext;
 	}
 
-	LEAVE();
+	HOT_LEAVE();
 	return MNULL;
 }
 
@@ -900,19 +984,20 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 		       t_u8 *ta, t_u8 pkt_type, void *payload)
 {
 	RxReorderTbl *rx_reor_tbl_ptr;
-	int prev_start_win, start_win, end_win, win_size;
+	int prev_start_win, start_win, end_win, win_size, slot;
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 	pmlan_adapter pmadapter = ((mlan_private *)priv)->adapter;
 
-	ENTER();
+	HOT_ENTER();
 
+	MTRACE(MTRACE_RX_REORDER, tid, seq_num, pkt_type);
 	rx_reor_tbl_ptr =
 		wlan_11n_get_rxreorder_tbl((mlan_private *)priv, tid, ta);
 	if (!rx_reor_tbl_ptr || rx_reor_tbl_ptr->win_size <= 1) {
 		if (pkt_type != PKT_TYPE_BAR)
 			wlan_11n_dispatch_pkt(priv, payload, rx_reor_tbl_ptr);
 
-		LEAVE();
+		HOT_LEAVE();
 		return ret;
 
 	} else {
@@ -922,13 +1007,13 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 		}
 		if ((pkt_type == PKT_TYPE_AMSDU) && !rx_reor_tbl_ptr->amsdu) {
 			wlan_11n_dispatch_pkt(priv, payload, rx_reor_tbl_ptr);
-			LEAVE();
+			HOT_LEAVE();
 			return ret;
 		}
 		if (pkt_type == PKT_TYPE_BAR)
-			PRINTM(MDAT_D, "BAR ");
+			HOT_PRINTM(MDAT_D, "BAR ");
 		if (pkt_type == PKT_TYPE_AMSDU)
-			PRINTM(MDAT_D, "AMSDU ");
+			HOT_PRINTM(MDAT_D, "AMSDU ");
 
 		if (rx_reor_tbl_ptr->check_start_win) {
 			if (seq_num == rx_reor_tbl_ptr->start_win)
@@ -950,7 +1035,7 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 								(priv, payload,
 								 rx_reor_tbl_ptr);
 					}
-					LEAVE();
+					HOT_LEAVE();
 					return ret;
 				}
 				rx_reor_tbl_ptr->check_start_win = MFALSE;
@@ -973,12 +1058,12 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 					       rx_reor_tbl_ptr->start_win) ||
 					      (rx_reor_tbl_ptr->last_seq <
 					       end_win)))) {
-						PRINTM(MDAT_D,
-						       "Update start_win: last_seq=%d, start_win=%d seq_num=%d\n",
-						       rx_reor_tbl_ptr->
-						       last_seq,
-						       rx_reor_tbl_ptr->
-						       start_win, seq_num);
+						HOT_PRINTM(MDAT_D,
+							   "Update start_win: last_seq=%d, start_win=%d seq_num=%d\n",
+							   rx_reor_tbl_ptr->
+							   last_seq,
+							   rx_reor_tbl_ptr->
+							   start_win, seq_num);
 						rx_reor_tbl_ptr->start_win =
 							rx_reor_tbl_ptr->
 							last_seq + 1;
@@ -987,12 +1072,12 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 						   && (seq_num >
 						       rx_reor_tbl_ptr->
 						       last_seq)) {
-						PRINTM(MDAT_D,
-						       "Update start_win: last_seq=%d, start_win=%d seq_num=%d\n",
-						       rx_reor_tbl_ptr->
-						       last_seq,
-						       rx_reor_tbl_ptr->
-						       start_win, seq_num);
+						HOT_PRINTM(MDAT_D,
+							   "Update start_win: last_seq=%d, start_win=%d seq_num=%d\n",
+							   rx_reor_tbl_ptr->
+							   last_seq,
+							   rx_reor_tbl_ptr->
+							   start_win, seq_num);
 						rx_reor_tbl_ptr->start_win =
 							rx_reor_tbl_ptr->
 							last_seq + 1;
@@ -1019,16 +1104,16 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 		win_size = rx_reor_tbl_ptr->win_size;
 		end_win = ((start_win + win_size) - 1) & (MAX_TID_VALUE - 1);
 
-		PRINTM(MDAT_D, "TID %d, TA " MACSTR "\n", tid, MAC2STR(ta));
-		PRINTM(MDAT_D,
-		       "1:seq_num %d start_win %d win_size %d end_win %d\n",
-		       seq_num, start_win, win_size, end_win);
+		HOT_PRINTM(MDAT_D, "TID %d, TA " MACSTR "\n", tid, MAC2STR(ta));
+		HOT_PRINTM(MDAT_D,
+			   "1:seq_num %d start_win %d win_size %d end_win %d\n",
+			   seq_num, start_win, win_size, end_win);
 		/*
 		 * If seq_num is less then starting win then ignore and drop
 		 * the packet
 		 */
 		if (rx_reor_tbl_ptr->force_no_drop) {
-			PRINTM(MDAT_D, "No drop packet\n");
+			HOT_PRINTM(MDAT_D, "No drop packet\n");
 			rx_reor_tbl_ptr->force_no_drop = MFALSE;
 		} else {
 			/* Wrap */
@@ -1037,19 +1122,19 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 						(MAX_TID_VALUE - 1)) &&
 				    (seq_num < start_win)) {
 					if (pkt_type == PKT_TYPE_BAR)
-						PRINTM(MDAT_D,
-						       "BAR: start_win=%d, end_win=%d, seq_num=%d\n",
-						       start_win, end_win,
-						       seq_num);
+						HOT_PRINTM(MDAT_D,
+							   "BAR: start_win=%d, end_win=%d, seq_num=%d\n",
+							   start_win, end_win,
+							   seq_num);
 					ret = MLAN_STATUS_FAILURE;
 					goto done;
 				}
 			} else if ((seq_num < start_win) ||
 				   (seq_num >= (start_win + (TWOPOW11)))) {
 				if (pkt_type == PKT_TYPE_BAR)
-					PRINTM(MDAT_D,
-					       "BAR: start_win=%d, end_win=%d, seq_num=%d\n",
-					       start_win, end_win, seq_num);
+					HOT_PRINTM(MDAT_D,
+						   "BAR: start_win=%d, end_win=%d, seq_num=%d\n",
+						   start_win, end_win, seq_num);
 				ret = MLAN_STATUS_FAILURE;
 				goto done;
 			}
@@ -1064,9 +1149,9 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 				((seq_num + win_size) - 1) & (MAX_TID_VALUE -
 							      1);
 
-		PRINTM(MDAT_D,
-		       "2:seq_num %d start_win %d win_size %d end_win %d\n",
-		       seq_num, start_win, win_size, end_win);
+		HOT_PRINTM(MDAT_D,
+			   "2:seq_num %d start_win %d win_size %d end_win %d\n",
+			   seq_num, start_win, win_size, end_win);
 
 		if (((end_win < start_win) &&
 		     (seq_num < start_win) && (seq_num > end_win))
@@ -1086,38 +1171,17 @@ mlan_11n_rxreorder_pkt(void *priv, t_u16 seq_num, t_u16 tid,
 				goto done;
 		}
 
-		PRINTM(MDAT_D, "3:seq_num %d start_win %d win_size %d"
-		       " end_win %d\n", seq_num, start_win, win_size, end_win);
+		HOT_PRINTM(MDAT_D, "3:seq_num %d start_win %d win_size %d"
+			   " end_win %d\n", seq_num, start_win, win_size, end_win);
 		if (pkt_type != PKT_TYPE_BAR) {
-			if (seq_num >= start_win) {
-				if (rx_reor_tbl_ptr->rx_reorder_ptr[seq_num
-								    -
-								    start_win])
-				{
-					PRINTM(MDAT_D, "Drop Duplicate Pkt\n");
-					ret = MLAN_STATUS_FAILURE;
-					goto done;
-				}
-				rx_reor_tbl_ptr->rx_reorder_ptr[seq_num
-								- start_win] =
-					payload;
-			} else {	/* Wrap condition */
-				if (rx_reor_tbl_ptr->rx_reorder_ptr[(seq_num
-								     +
-								     (MAX_TID_VALUE))
-								    -
-								    start_win])
-				{
-					PRINTM(MDAT_D, "Drop Duplicate Pkt\n");
-					ret = MLAN_STATUS_FAILURE;
-					goto done;
-				}
-				rx_reor_tbl_ptr->rx_reorder_ptr[(seq_num
-								 +
-								 (MAX_TID_VALUE))
-								- start_win] =
-					payload;
+			/* Ring size divides MAX_TID_VALUE, so wrap is implicit */
+			slot = RX_REORDER_SLOT(rx_reor_tbl_ptr, seq_num);
+			if (rx_reor_tbl_ptr->rx_reorder_ptr[slot]) {
+				HOT_PRINTM(MDAT_D, "Drop Duplicate Pkt\n");
+				ret = MLAN_STATUS_FAILURE;
+				goto done;
 			}
+			rx_reor_tbl_ptr->rx_reorder_ptr[slot] = payload;
 		}
 
 		wlan_11n_display_tbl_ptr(pmadapter, rx_reor_tbl_ptr);
@@ -1138,7 +1202,8 @@ done:
 		mlan_11n_rxreorder_timer_restart(pmadapter, rx_reor_tbl_ptr);
 	}
 
-	LEAVE();
+	MTRACE(MTRACE_RX_REORDER_DONE, tid, rx_reor_tbl_ptr->start_win, ret);
+	HOT_LEAVE();
 	return ret;
 }
 
@@ -1347,6 +1412,8 @@ wlan_11n_cleanup_reorder_tbl(mlan_private *priv)
 	}
 
 	util_init_list((pmlan_linked_list)&priv->rx_reorder_tbl_ptr);
+	memset(priv->adapter, priv->rx_reorder_hash, 0,
+	       sizeof(priv->rx_reorder_hash));
 
 	memset(priv->adapter, priv->rx_seq, 0xff, sizeof(priv->rx_seq));
 	LEAVE();
@@ -33,6 +33,8 @@ Change log:
 #define MAX_TID_VALUE			(2 << 11)
 /** 2^11 = 2048 */
 #define TWOPOW11			(2 << 10)
+/** Reorder ring slot holding sequence number seq */
+#define RX_REORDER_SLOT(tbl, seq)	((seq) & (tbl)->ring_mask)
 
 /** Tid Mask used for extracting TID from BlockAckParamSet */
 #define BLOCKACKPARAM_TID_MASK		0x3C
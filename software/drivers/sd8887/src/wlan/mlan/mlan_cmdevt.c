@@ -237,7 +237,7 @@ wlan_dump_info(mlan_adapter *pmadapter, t_u8 reason)
 	PRINTM(MERROR, "delay_task_flag =%d\n", pmadapter->delay_task_flag);
 	PRINTM(MERROR, "mlan_rx_processing =%d\n",
 	       pmadapter->mlan_rx_processing);
-	PRINTM(MERROR, "rx_pkts_queued=%d\n", pmadapter->rx_pkts_queued);
+	PRINTM(MERROR, "rx_pkts_queued=%d\n", wlan_rx_pkts_queued(pmadapter));
 	PRINTM(MERROR, "more_task_flag = %d\n", pmadapter->more_task_flag);
 	PRINTM(MERROR, "num_cmd_timeout = %d\n", pmadapter->num_cmd_timeout);
 	PRINTM(MERROR, "dbg.num_cmd_timeout = %d\n",
@@ -703,6 +703,7 @@ wlan_clean_cmd_node(pmlan_adapter pmadapter, cmd_ctrl_node *pcmd_node)
 	}
 	pcmd_node->cmd_no = 0;
 	pcmd_node->cmd_flag = 0;
+	pcmd_node->dnld_ns = 0;
 	pcmd_node->pioctl_buf = MNULL;
 	pcmd_node->pdata_buf = MNULL;
 
@@ -880,6 +881,74 @@ wlan_cmd_host_cmd(IN pmlan_private pmpriv,
 	return MLAN_STATUS_SUCCESS;
 }
 
+/**
+ *  @brief This function records the download to response time of
+ *         a command in the per command id latency statistics
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param pcmd_node    A pointer to cmd_ctrl_node structure
+ *
+ *  @return             N/A
+ */
+static t_void
+wlan_update_cmd_lat_stats(mlan_adapter *pmadapter, cmd_ctrl_node *pcmd_node)
+{
+	mlan_callbacks *pcb = (mlan_callbacks *)&pmadapter->callbacks;
+	mlan_cmd_lat_stat *stat = MNULL;
+	t_u64 now = 0;
+	t_u32 lat_us;
+	t_u32 i;
+
+	if (!pcmd_node->dnld_ns)
+		return;
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &now);
+	lat_us = (t_u32)pcb->moal_do_div(now - pcmd_node->dnld_ns, 1000);
+
+	/* An unused entry has no responses counted yet */
+	for (i = 0; i < MLAN_MAX_CMD_LAT_STATS; i++) {
+		stat = &pmadapter->dbg.cmd_lat[i];
+		if (!stat->count || stat->cmd_no == pcmd_node->cmd_no)
+			break;
+	}
+	if (i < MLAN_MAX_CMD_LAT_STATS) {
+		stat->cmd_no = (t_u16)pcmd_node->cmd_no;
+		stat->count++;
+		stat->total_us += lat_us;
+		if (lat_us > stat->max_us)
+			stat->max_us = lat_us;
+	}
+	if (pmadapter->hw_status == WlanHardwareStatusGetHwSpec ||
+	    pmadapter->hw_status == WlanHardwareStatusInitializing) {
+		pmadapter->dbg.init_cmd_cnt++;
+		pmadapter->dbg.init_cmd_us += lat_us;
+	}
+}
+
+/**
+ *  @brief This function records the time firmware init took
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *
+ *  @return             N/A
+ */
+static t_void
+wlan_init_time_done(mlan_adapter *pmadapter)
+{
+	mlan_callbacks *pcb = (mlan_callbacks *)&pmadapter->callbacks;
+	t_u64 now = 0;
+
+	if (!pmadapter->dbg.init_start_ns)
+		return;
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &now);
+	pmadapter->dbg.init_total_us =
+		(t_u32)pcb->moal_do_div(now - pmadapter->dbg.init_start_ns,
+					1000);
+	PRINTM(MMSG,
+	       "wlan: init done in %u us, %u cmds waited %u us for FW\n",
+	       pmadapter->dbg.init_total_us, pmadapter->dbg.init_cmd_cnt,
+	       pmadapter->dbg.init_cmd_us);
+}
+
 /**
  *  @brief This function downloads a command to firmware.
  *
@@ -958,6 +1027,7 @@ wlan_dnld_cmd_to_fw(IN mlan_private *pmpriv, IN cmd_ctrl_node *pcmd_node)
 	pmadapter->callbacks.moal_get_system_time(pmadapter->pmoal_handle,
 						  &pmadapter->dnld_cmd_in_secs,
 						  &age_ts_usec);
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &pcmd_node->dnld_ns);
 
 	PRINTM_GET_SYS_TIME(MCMND, &sec, &usec);
 	PRINTM_NETINTF(MCMND, pmpriv);
@@ -1759,6 +1829,7 @@ wlan_process_cmdresp(mlan_adapter *pmadapter)
 		goto done;
 	}
 	pmadapter->dnld_cmd_in_secs = 0;
+	wlan_update_cmd_lat_stats(pmadapter, pmadapter->curr_cmd);
 	/* Now we got response from FW, cancel the command timer */
 	if (pmadapter->cmd_timer_is_set) {
 		/* Cancel command timeout timer */
@@ -1909,6 +1980,7 @@ wlan_process_cmdresp(mlan_adapter *pmadapter)
 			}
 #endif
 			pmadapter->hw_status = WlanHardwareStatusInitdone;
+			wlan_init_time_done(pmadapter);
 		} else {
 			/* Issue init commands for the next interface */
 			ret = pmpriv_next->ops.init_cmd(pmpriv_next, MFALSE);
@@ -175,7 +175,6 @@ wlan_allocate_adapter(pmlan_adapter pmadapter)
 {
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 #ifdef STA_SUPPORT
-	t_u32 beacon_buffer_size;
 	t_u32 buf_size;
 	BSSDescriptor_t *ptemp_scan_table = MNULL;
 	t_u8 chan_2g[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
@@ -215,19 +214,10 @@ wlan_allocate_adapter(pmlan_adapter pmadapter)
 	}
 	pmadapter->pscan_table = ptemp_scan_table;
 
-	if (pmadapter->fixed_beacon_buffer)
-		beacon_buffer_size = MAX_SCAN_BEACON_BUFFER;
-	else
-		beacon_buffer_size = DEFAULT_SCAN_BEACON_BUFFER;
-	ret = pmadapter->callbacks.moal_malloc(pmadapter->pmoal_handle,
-					       beacon_buffer_size, MLAN_MEM_DEF,
-					       (t_u8 **)&pmadapter->bcn_buf);
-	if (ret != MLAN_STATUS_SUCCESS || !pmadapter->bcn_buf) {
-		PRINTM(MERROR, "Failed to allocate bcn buf\n");
+	if (wlan_bcn_store_init(pmadapter) != MLAN_STATUS_SUCCESS) {
 		LEAVE();
 		return MLAN_STATUS_FAILURE;
 	}
-	pmadapter->bcn_buf_size = beacon_buffer_size;
 
 	pmadapter->num_in_chan_stats = sizeof(chan_2g);
 	pmadapter->num_in_chan_stats += sizeof(chan_5g);
@@ -581,10 +571,19 @@ wlan_init_adapter(pmlan_adapter pmadapter)
 	else
 		pmadapter->mpa_rx.enabled = MTRUE;
 	pmadapter->mpa_rx.pkt_aggr_limit = SDIO_MP_AGGR_DEF_PKT_LIMIT;
+	pmadapter->mpa_rx.max_aggr_limit = SDIO_MP_AGGR_DEF_PKT_LIMIT;
+	pmadapter->mpa_rx.buf_limit = 0;
+	pmadapter->mpa_rx.win_cnt = 0;
+	pmadapter->mpa_rx.win_bytes = 0;
+	pmadapter->mpa_rx.win_lat_ns = 0;
+	pmadapter->mpa_rx.avg_lat_us = 0;
+	memset(pmadapter, pmadapter->mpa_rx.hist_snap, 0,
+	       sizeof(pmadapter->mpa_rx.hist_snap));
 
 #endif /* SDIO_MULTI_PORT_RX_AGGR */
 
-	pmadapter->rx_pkts_queued = 0;
+	pmadapter->rx_ring_head = 0;
+	pmadapter->rx_ring_tail = 0;
 	pmadapter->cmd_resp_received = MFALSE;
 	pmadapter->event_received = MFALSE;
 	pmadapter->data_received = MFALSE;
@@ -621,12 +620,12 @@ wlan_init_adapter(pmlan_adapter pmadapter)
 	pmadapter->num_in_scan_table = 0;
 	memset(pmadapter, pmadapter->pscan_table, 0,
 	       (sizeof(BSSDescriptor_t) * MRVDRV_MAX_BSSID_LIST));
+	wlan_scan_hash_rebuild(pmadapter);
 	pmadapter->active_scan_triggered = MFALSE;
 	pmadapter->ext_scan = MTRUE;
 	pmadapter->scan_probes = DEFAULT_PROBES;
 
-	memset(pmadapter, pmadapter->bcn_buf, 0, pmadapter->bcn_buf_size);
-	pmadapter->pbcn_buf_end = pmadapter->bcn_buf;
+	wlan_bcn_store_reset(pmadapter);
 
 	pmadapter->radio_on = RADIO_ON;
 	if (!pmadapter->multiple_dtim)
@@ -894,9 +893,6 @@ wlan_init_lock_list(IN pmlan_adapter pmadapter)
 		goto error;
 	}
 
-	util_init_list_head((t_void *)pmadapter->pmoal_handle,
-			    &pmadapter->rx_data_queue, MTRUE,
-			    pmadapter->callbacks.moal_init_lock);
 	util_scalar_init((t_void *)pmadapter->pmoal_handle,
 			 &pmadapter->pending_bridge_pkts, 0,
 			 MNULL, pmadapter->callbacks.moal_init_lock);
@@ -975,9 +971,6 @@ wlan_free_lock_list(IN pmlan_adapter pmadapter)
 	}
 
 	/* Free lists */
-	util_free_list_head((t_void *)pmadapter->pmoal_handle,
-			    &pmadapter->rx_data_queue, pcb->moal_free_lock);
-
 	util_scalar_free((t_void *)pmadapter->pmoal_handle,
 			 &pmadapter->pending_bridge_pkts, pcb->moal_free_lock);
 	util_free_list_head((t_void *)pmadapter->pmoal_handle,
@@ -1373,11 +1366,7 @@ wlan_free_adapter(pmlan_adapter pmadapter)
 					(t_u8 *)pmadapter->pchan_stats);
 		pmadapter->pchan_stats = MNULL;
 	}
-	if (pmadapter->bcn_buf) {
-		pcb->moal_mfree(pmadapter->pmoal_handle,
-				(t_u8 *)pmadapter->bcn_buf);
-		pmadapter->bcn_buf = MNULL;
-	}
+	wlan_bcn_store_free(pmadapter);
 #endif
 
 	wlan_11h_cleanup(pmadapter);
@@ -169,6 +169,7 @@ enum _mlan_ioctl_req_id {
 	MLAN_OID_WMM_CFG_QUEUE_STATS = 0x000A0006,
 	MLAN_OID_WMM_CFG_QUEUE_STATUS = 0x000A0007,
 	MLAN_OID_WMM_CFG_TS_STATUS = 0x000A0008,
+	MLAN_OID_WMM_CFG_AQM = 0x000A0009,
 
 	/* WPS Configuration Group */
 	MLAN_IOCTL_WPS_CFG = 0x000B0000,
@@ -2034,6 +2035,20 @@ typedef struct _ralist_info {
 	t_u8 tx_pause;
 } ralist_info;
 
+/** Number of command ids with latency statistics */
+#define MLAN_MAX_CMD_LAT_STATS	32
+/** Command latency statistics */
+typedef struct _mlan_cmd_lat_stat {
+    /** Command id */
+	t_u16 cmd_no;
+    /** Number of responses received */
+	t_u32 count;
+    /** Longest download to response time in us */
+	t_u32 max_us;
+    /** Total download to response time in us */
+	t_u64 total_us;
+} mlan_cmd_lat_stat;
+
 /** mlan_debug_info data structure for MLAN_OID_GET_DEBUG_INFO */
 typedef struct _mlan_debug_info {
 	/* WMM AC_BK count */
@@ -2116,6 +2131,8 @@ typedef struct _mlan_debug_info {
 	t_u32 num_cmd_sleep_cfm_host_to_card_failure;
     /** Number of host to card Tx failures */
 	t_u32 num_tx_host_to_card_failure;
+    /** Tx dequeue batch sizes, index n counts batches of n + 1 pkts */
+	t_u32 num_tx_batch[SDIO_MP_AGGR_DEF_PKT_LIMIT];
     /** Number of allocate buffer failure */
 	t_u32 num_alloc_buffer_failure;
 	/** Number of pkt dropped */
@@ -2165,6 +2182,12 @@ typedef struct _mlan_debug_info {
 #ifdef SDIO_MULTI_PORT_RX_AGGR
     /** Number of packets rx aggr */
 	t_u32 mpa_rx_count[SDIO_MP_AGGR_DEF_PKT_LIMIT];
+    /** Current rx aggr packet limit */
+	t_u32 mpa_rx_pkt_limit;
+    /** Current rx aggr buffer limit */
+	t_u32 mpa_rx_buf_limit;
+    /** Average rx aggr CMD53 read time in us */
+	t_u32 mpa_rx_cmd53_lat_us;
 #endif
     /** Number of deauthentication events */
 	t_u32 num_event_deauth;
@@ -2206,6 +2229,14 @@ typedef struct _mlan_debug_info {
 	t_u16 last_event_index;
     /** Number of no free command node */
 	t_u16 num_no_cmd_node;
+    /** Command latency statistics */
+	mlan_cmd_lat_stat cmd_lat[MLAN_MAX_CMD_LAT_STATS];
+    /** Number of commands completed during init */
+	t_u32 init_cmd_cnt;
+    /** Time spent waiting for init command responses in us */
+	t_u32 init_cmd_us;
+    /** Time from mlan_init_fw to init done in us */
+	t_u32 init_total_us;
     /** pending command id */
 	t_u16 pending_cmd;
     /** time stamp for dnld last cmd */
@@ -3208,6 +3239,32 @@ typedef struct _mlan_ds_wmm_queue_config {
 	t_u8 reserved[10];
 } mlan_ds_wmm_queue_config, *pmlan_ds_wmm_queue_config;
 
+/** AQM disabled */
+#define MLAN_WMM_AQM_OFF        0
+/** CoDel on each RA list */
+#define MLAN_WMM_AQM_CODEL      1
+/** CoDel on each RA list, taking drops from the flow with most bytes queued */
+#define MLAN_WMM_AQM_FQ_CODEL   2
+
+/** Type definition of mlan_ds_wmm_aqm for MLAN_OID_WMM_CFG_AQM */
+typedef struct _mlan_ds_wmm_aqm {
+    /** WMM Access Category: WMM_AC_BK(0) to WMM_AC_VO(3) */
+	mlan_wmm_ac_e access_category;
+    /** AQM mode: MLAN_WMM_AQM_OFF, MLAN_WMM_AQM_CODEL or
+     *  MLAN_WMM_AQM_FQ_CODEL */
+	t_u8 mode;
+    /** Mark ECN capable packets instead of dropping them */
+	t_u8 ecn;
+    /** Target queue delay in microseconds, 0 for default */
+	t_u32 target;
+    /** Interval in microseconds, 0 for default */
+	t_u32 interval;
+    /** Packets dropped, get only */
+	t_u32 drop_cnt;
+    /** Packets marked with CE, get only */
+	t_u32 mark_cnt;
+} mlan_ds_wmm_aqm, *pmlan_ds_wmm_aqm;
+
 /** Type definition of mlan_ds_wmm_cfg for MLAN_IOCTL_WMM_CFG */
 typedef struct _mlan_ds_wmm_cfg {
     /** Sub-command */
@@ -3232,6 +3289,8 @@ typedef struct _mlan_ds_wmm_cfg {
 		mlan_ds_wmm_queue_status q_status;
 	/** WMM TS status for MLAN_OID_WMM_CFG_TS_STATUS */
 		mlan_ds_wmm_ts_status ts_status;
+	/** AQM configuration for MLAN_OID_WMM_CFG_AQM */
+		mlan_ds_wmm_aqm aqm;
 	} param;
 } mlan_ds_wmm_cfg, *pmlan_ds_wmm_cfg;
 
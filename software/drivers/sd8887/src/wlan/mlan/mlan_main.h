@@ -189,6 +189,20 @@ do {                \
 	PRINTM(MENTRY, "Leave: %s\n", __func__);   \
 } while (0)
 
+#ifdef HOTPATH_TRACE
+/** Data-path functions log through MTRACE() instead of printk */
+#define HOT_ENTER()			do {} while (0)
+#define HOT_LEAVE()			do {} while (0)
+#define HOT_PRINTM(level, msg...)	do {} while (0)
+#else
+/** Log entry point of a data-path function */
+#define HOT_ENTER()			ENTER()
+/** Log exit point of a data-path function */
+#define HOT_LEAVE()			LEAVE()
+/** Log debug message from a data-path function */
+#define HOT_PRINTM			PRINTM
+#endif /* HOTPATH_TRACE */
+
 /** Find minimum */
 #ifndef MIN
 #define MIN(a, b)		((a) < (b) ? (a) : (b))
@@ -396,6 +410,8 @@ do {                                    \
 #define HIGH_RX_PENDING         100
 /** low rx pending packets */
 #define LOW_RX_PENDING          80
+/** Rx data ring size, a power of 2 well above HIGH_RX_PENDING + MAX_PORT */
+#define MLAN_RX_RING_SIZE       256
 
 /** Default region code */
 #define MRVDRV_DEFAULT_REGION_CODE      0x10
@@ -430,8 +446,17 @@ do {                                    \
 
 /** Maximum buffer space for beacons retrieved from scan responses */
 #define MAX_SCAN_BEACON_BUFFER          49152
-/** Default buffer space for beacons retrieved from scan responses */
-#define DEFAULT_SCAN_BEACON_BUFFER      4096
+/** Size of one beacon store slab */
+#define BCN_SLAB_SIZE                   4096
+/** Maximum number of beacon store slabs */
+#define BCN_SLAB_MAX                    64
+/** Number of beacon chunk size classes */
+#define BCN_SLAB_NUM_CLASS              13
+/** Slab not carved into chunks yet */
+#define BCN_SLAB_CLASS_NONE             0xff
+
+/** Number of scan table hash buckets, must be a power of 2 */
+#define SCAN_HASH_SIZE                  64
 
 /**
  * @brief Buffer pad space for newly allocated beacons/probe responses
@@ -523,6 +548,8 @@ typedef struct _wlan_dbg {
 	t_u32 num_cmd_sleep_cfm_host_to_card_failure;
     /** Number of host to card Tx failures */
 	t_u32 num_tx_host_to_card_failure;
+    /** Tx dequeue batch sizes, index n counts batches of n + 1 pkts */
+	t_u32 num_tx_batch[SDIO_MP_AGGR_DEF_PKT_LIMIT];
     /** Number of card to host command/event failures */
 	t_u32 num_cmdevt_card_to_host_failure;
     /** Number of card to host Rx failures */
@@ -573,6 +600,16 @@ typedef struct _wlan_dbg {
 	t_u16 last_event_index;
     /** Number of no free command node */
 	t_u16 num_no_cmd_node;
+    /** Command latency statistics */
+	mlan_cmd_lat_stat cmd_lat[MLAN_MAX_CMD_LAT_STATS];
+    /** Number of commands completed during init */
+	t_u32 init_cmd_cnt;
+    /** Time spent waiting for init command responses in us */
+	t_u32 init_cmd_us;
+    /** Time from mlan_init_fw to init done in us */
+	t_u32 init_total_us;
+    /** mlan_init_fw timestamp in ns */
+	t_u64 init_start_ns;
 } wlan_dbg;
 
 /** Hardware status codes */
@@ -615,6 +652,16 @@ typedef enum _PS_STATE {
 /** Tx BA stream table */
 typedef struct _TxBAStreamTbl TxBAStreamTbl;
 
+/** RX reorder table */
+typedef struct _RxReorderTbl RxReorderTbl;
+
+/** Size of the per-interface BA stream hashes, must be a power of 2 */
+#define MLAN_BA_HASH_SIZE 64
+/** BA stream hash bucket for a MAC address/TID pair */
+#define MLAN_BA_HASH(mac, tid) \
+	(((mac)[3] ^ (mac)[4] ^ (mac)[5] ^ ((tid) << 3)) & \
+	 (MLAN_BA_HASH_SIZE - 1))
+
 /** Add BA parameter data structure */
 typedef struct {
     /** Window size for initiator */
@@ -681,8 +728,28 @@ struct _raListTbl {
 	t_u8 is_tdls_link;
 	/** tx_pause flag */
 	t_u8 tx_pause;
+    /** CoDel: time the head packet's sojourn may first cause a drop,
+     *  0 while the sojourn is below target */
+	t_u32 codel_first_above;
+    /** CoDel: time of the next drop in the dropping state */
+	t_u32 codel_drop_next;
+    /** CoDel: drops since the dropping state was entered */
+	t_u32 codel_count;
+    /** CoDel: codel_count when the dropping state was last entered */
+	t_u32 codel_lastcount;
+    /** CoDel: dropping state */
+	t_u8 codel_dropping;
 };
 
+/** Peer index node */
+typedef struct _peer_node peer_node;
+
+/** Size of the per-interface peer hash, must be a power of 2 */
+#define MLAN_PEER_HASH_SIZE 32
+/** Peer hash bucket for a MAC address */
+#define MLAN_PEER_HASH(mac) \
+	(((mac)[3] ^ (mac)[4] ^ (mac)[5]) & (MLAN_PEER_HASH_SIZE - 1))
+
 /** TID table */
 typedef struct _tidTbl {
     /** RA list head */
@@ -703,6 +770,33 @@ typedef struct _tidTbl {
 /** Max driver packet delay in msec */
 #define WMM_DRV_DELAY_MAX	510
 
+/** Default AQM target queue delay in microseconds */
+#define WMM_AQM_DEF_TARGET	5000
+/** Default AQM interval in microseconds */
+#define WMM_AQM_DEF_INTERVAL	100000
+/** Max AQM interval in microseconds */
+#define WMM_AQM_MAX_INTERVAL	1000000
+/** Bits of flow hash used by MLAN_WMM_AQM_FQ_CODEL */
+#define WMM_AQM_FLOW_BITS	4
+/** Number of flow buckets an RA list is hashed into */
+#define WMM_AQM_FLOWS		(1 << WMM_AQM_FLOW_BITS)
+
+/** Per-AC active queue management on the RA lists */
+typedef struct _wmm_aqm_t {
+    /** AQM mode, MLAN_WMM_AQM_* */
+	t_u8 mode;
+    /** Mark ECN capable packets instead of dropping them */
+	t_u8 ecn;
+    /** Target queue delay in microseconds */
+	t_u32 target;
+    /** Interval in microseconds */
+	t_u32 interval;
+    /** Packets dropped */
+	t_u32 drop_cnt;
+    /** Packets marked with CE */
+	t_u32 mark_cnt;
+} wmm_aqm_t;
+
 /** Struct of WMM DESC */
 typedef struct _wmm_desc {
     /** TID table */
@@ -723,6 +817,8 @@ typedef struct _wmm_desc {
 
     /** Max driver packet delay sent to the firmware for expiry eval */
 	t_u32 drv_pkt_delay_max;
+    /** Active queue management per AC */
+	wmm_aqm_t aqm[MAX_AC_QUEUES];
 
     /** WMM queue priority table */
 	t_u8 queue_priority[MAX_AC_QUEUES];
@@ -733,6 +829,8 @@ typedef struct _wmm_desc {
 	mlan_scalar tx_pkts_queued;
     /** Tracks highest priority with a packet queued */
 	mlan_scalar highest_queued_prio;
+    /** Bitmap of priorities (tos_to_tid_inv) with unpaused packets queued */
+	t_u8 prio_bitmap;
 } wmm_desc_t;
 
 /** Security structure */
@@ -1115,6 +1213,8 @@ typedef struct _mlan_private {
 	t_u8 wapi_ie_len;
     /** Pointer to the station table */
 	mlan_list_head sta_list;
+    /** Peer hash indexing sta_list and the RA lists by MAC address */
+	peer_node *peer_hash[MLAN_PEER_HASH_SIZE];
     /** tdls pending queue */
 	mlan_list_head tdls_pending_txq;
 	t_u16 tdls_idle_time;
@@ -1150,6 +1250,8 @@ typedef struct _mlan_private {
 
     /** Pointer to the Transmit BA stream table*/
 	mlan_list_head tx_ba_stream_tbl_ptr;
+    /** Hash indexing tx_ba_stream_tbl_ptr by RA/TID */
+	TxBAStreamTbl *tx_ba_hash[MLAN_BA_HASH_SIZE];
     /** Pointer to the priorities for AMSDU/AMPDU table*/
 	tx_aggr_t aggr_prio_tbl[MAX_NUM_TID];
     /** Pointer to the priorities for AMSDU/AMPDU table*/
@@ -1166,6 +1268,8 @@ typedef struct _mlan_private {
 	t_u16 rx_seq[MAX_NUM_TID];
     /** Pointer to the Receive Reordering table*/
 	mlan_list_head rx_reorder_tbl_ptr;
+    /** Hash indexing rx_reorder_tbl_ptr by TA/TID */
+	RxReorderTbl *rx_reorder_hash[MLAN_BA_HASH_SIZE];
     /** Lock for Rx packets */
 	t_void *rx_pkt_lock;
 
@@ -1239,6 +1343,8 @@ struct _TxBAStreamTbl {
 	TxBAStreamTbl *pprev;
     /** TxBAStreamTbl next node */
 	TxBAStreamTbl *pnext;
+    /** next node in the same hash bucket */
+	TxBAStreamTbl *hnext;
     /** TID */
 	int tid;
     /** RA */
@@ -1248,9 +1354,6 @@ struct _TxBAStreamTbl {
 	t_u8 amsdu;
 };
 
-/** RX reorder table */
-typedef struct _RxReorderTbl RxReorderTbl;
-
 typedef struct {
     /** Timer for flushing */
 	t_void *timer;
@@ -1268,6 +1371,8 @@ struct _RxReorderTbl {
 	RxReorderTbl *pprev;
     /** RxReorderTbl next node */
 	RxReorderTbl *pnext;
+    /** next node in the same hash bucket */
+	RxReorderTbl *hnext;
     /** TID */
 	int tid;
     /** TA */
@@ -1278,7 +1383,9 @@ struct _RxReorderTbl {
 	int last_seq;
     /** Window size */
 	int win_size;
-    /** Pointer to pointer to RxReorderTbl */
+    /** Reorder ring index mask, ring holds (ring_mask + 1) >= win_size slots */
+	int ring_mask;
+    /** Reorder ring, indexed by sequence number & ring_mask */
 	t_void **rx_reorder_ptr;
     /** Timer context */
 	reorder_tmr_cnxt_t timer_context;
@@ -1348,6 +1455,8 @@ struct _cmd_ctrl_node {
 	t_void *pioctl_buf;
     /** pre_allocated mlan_buffer for cmd */
 	mlan_buffer *pmbuf;
+    /** Download timestamp in ns */
+	t_u64 dnld_ns;
 };
 
 /** default tdls wmm qosinfo */
@@ -1432,6 +1541,18 @@ struct _sta_node {
 	sta_stats stats;
 };
 
+/** Peer index node */
+struct _peer_node {
+    /** next node in the same hash bucket */
+	peer_node *hnext;
+    /** peer mac address */
+	t_u8 mac_addr[MLAN_MAC_ADDR_LENGTH];
+    /** station entry, MNULL if none */
+	sta_node *sta_ptr;
+    /** RA list of each TID, MNULL if none */
+	raListTbl *ra_list[MAX_NUM_TID];
+};
+
 /** 802.11h State information kept in the 'mlan_adapter' driver structure */
 typedef struct {
     /** Min TX Power capability sent to FW for 11h use and fw power control */
@@ -1615,11 +1736,40 @@ typedef struct _sdio_mpa_tx {
 	t_u32 buf_size;
 	/** multiport tx aggregation pkt aggr limit */
 	t_u32 pkt_aggr_limit;
+	/** scatter-gather segments in the current aggregation */
+	t_u32 seg_cnt;
+	/** scatter-gather segment limit for one CMD53 */
+	t_u32 seg_limit;
 	/** multiport write info */
 	t_u16 mp_wr_info[SDIO_MP_AGGR_DEF_PKT_LIMIT];
 	/** multiport rx aggregation mbuf array */
 	pmlan_buffer mbuf_arr[SDIO_MP_AGGR_DEF_PKT_LIMIT];
+	/** allocated zero block for SG mode padding */
+	t_u8 *pad_ptr;
+	/** SG mode block padding buffers, one per aggregated packet */
+	mlan_buffer pad_buf[SDIO_MP_AGGR_DEF_PKT_LIMIT];
 } sdio_mpa_tx;
+
+/** Size of the header arena of a scatter-gather AMSDU */
+#define AMSDU_SG_HDR_ARENA_LEN	(2 * MLAN_SDIO_BLOCK_SIZE)
+
+/** Header arena of a scatter-gather AMSDU */
+typedef struct _amsdu_sg_arena {
+	/** fragment list handed to the SDIO layer, must be first */
+	mlan_buf_frag frag[MLAN_BUF_MAX_FRAGS];
+	/** number of fragments before the block padding fragment */
+	t_u32 body_frags;
+	/** length of the AMSDU before block padding */
+	t_u32 body_len;
+	/** source MSDUs, completed along with the AMSDU */
+	pmlan_buffer msdu[MLAN_AMSDU_SG_MAX_MSDU];
+	/** number of source MSDUs */
+	t_u32 num_msdu;
+	/** bytes of hdr in use */
+	t_u32 hdr_len;
+	/** interface header, TxPD, subframe headers and padding */
+	t_u8 hdr[AMSDU_SG_HDR_ARENA_LEN];
+} amsdu_sg_arena;
 #endif
 
 #ifdef SDIO_MULTI_PORT_RX_AGGR
@@ -1649,9 +1799,33 @@ typedef struct _sdio_mpa_rx {
 	t_u32 buf_size;
 	/** multiport rx aggregation pkt aggr limit */
 	t_u32 pkt_aggr_limit;
+	/** configured pkt aggr limit, ceiling for adaptive sizing */
+	t_u32 max_aggr_limit;
+	/** adaptive buffer limit, 0 to use buf_size */
+	t_u32 buf_limit;
+	/** adaptive window: number of timed aggregated reads */
+	t_u32 win_cnt;
+	/** adaptive window: bytes read */
+	t_u32 win_bytes;
+	/** adaptive window: CMD53 read time in ns */
+	t_u64 win_lat_ns;
+	/** average CMD53 read time of the last window in us */
+	t_u32 avg_lat_us;
+	/** mpa_rx_count at the start of the window */
+	t_u32 hist_snap[SDIO_MP_AGGR_DEF_PKT_LIMIT];
 } sdio_mpa_rx;
 #endif /* SDIO_MULTI_PORT_RX_AGGR */
 
+/** Beacon store slab, carved into chunks of one size class */
+typedef struct _bcn_slab {
+    /** Slab memory, MNULL until allocated */
+	t_u8 *buf;
+    /** Size class index, BCN_SLAB_CLASS_NONE when not carved */
+	t_u8 cls;
+    /** Number of chunks handed out */
+	t_u16 inuse;
+} bcn_slab;
+
 /** mlan_init_para structure */
 typedef struct _mlan_init_para {
 #ifdef MFG_CMD_SUPPORT
@@ -1719,8 +1893,6 @@ typedef struct _mlan_adapter {
 	t_void *prx_proc_lock;
     /** rx work enable flag */
 	t_u8 rx_work_flag;
-	/* number of rx pkts queued */
-	t_u16 rx_pkts_queued;
     /** more task flag */
 	t_u32 more_task_flag;
     /** delay task flag */
@@ -1812,6 +1984,8 @@ typedef struct _mlan_adapter {
 #ifdef SDIO_MULTI_PORT_TX_AGGR
 	/** data structure for SDIO MPA TX */
 	sdio_mpa_tx mpa_tx;
+    /** Form AMSDUs as scatter-gather lists when TX SG mode is on */
+	t_u8 amsdu_sg;
     /** packet number for tx aggr */
 	t_u32 mpa_tx_count[SDIO_MP_AGGR_DEF_PKT_LIMIT];
     /** no more packets count*/
@@ -1843,6 +2017,8 @@ typedef struct _mlan_adapter {
 #ifdef SDIO_MULTI_PORT_RX_AGGR
 	/** data structure for SDIO MPA RX */
 	sdio_mpa_rx mpa_rx;
+    /** Tune MPA RX limits from the rx histogram and CMD53 latency */
+	t_u8 mpa_rx_adapt;
     /** packet number for tx aggr */
 	t_u32 mpa_rx_count[SDIO_MP_AGGR_DEF_PKT_LIMIT];
 #endif				/* SDIO_MULTI_PORT_RX_AGGR */
@@ -1975,6 +2151,14 @@ typedef struct _mlan_adapter {
 	wlan_meas_state_t state_meas;
     /** Scan table */
 	BSSDescriptor_t *pscan_table;
+    /** First scan table index per BSSID hash bucket, -1 if empty */
+	t_s16 bssid_hash[SCAN_HASH_SIZE];
+    /** Next scan table index in the same BSSID bucket */
+	t_s16 bssid_hash_next[MRVDRV_MAX_BSSID_LIST];
+    /** First scan table index per SSID hash bucket, -1 if empty */
+	t_s16 ssid_hash[SCAN_HASH_SIZE];
+    /** Next scan table index in the same SSID bucket */
+	t_s16 ssid_hash_next[MRVDRV_MAX_BSSID_LIST];
     /** scan age in secs */
 	t_u32 age_in_secs;
     /** Active scan for hidden ssid triggered */
@@ -2008,13 +2192,18 @@ typedef struct _mlan_adapter {
 	t_u8 scan_block;
     /** Extended scan or legacy scan */
 	t_u8 ext_scan;
-	t_u16 bcn_buf_size;
-    /** Beacon buffer */
-	t_u8 *bcn_buf;
-    /** Pointer to valid beacon buffer end */
-	t_u8 *pbcn_buf_end;
+    /** Beacon store slabs */
+	bcn_slab bcn_slabs[BCN_SLAB_MAX];
+    /** Number of slabs the beacon store may allocate */
+	t_u8 bcn_slab_num;
+    /** Free chunk list per size class */
+	t_u8 *bcn_free[BCN_SLAB_NUM_CLASS];
+    /** Beacon store bytes handed out */
+	t_u32 bcn_used;
     /** allocate fixed scan beacon buffer size*/
 	t_u32 fixed_beacon_buffer;
+    /** Beacon store limit in bytes */
+	t_u32 max_beacon_buffer;
 
     /** F/W supported bands */
 	t_u8 fw_bands;
@@ -2124,8 +2313,13 @@ typedef struct _mlan_adapter {
 
     /** max mgmt IE index in device */
 	t_u16 max_mgmt_ie_index;
-    /** Head of Rx data queue */
-	mlan_list_head rx_data_queue;
+    /** Rx data ring, filled by the main process and drained by the
+     *  rx process without a shared lock */
+	pmlan_buffer rx_ring[MLAN_RX_RING_SIZE];
+    /** Rx ring producer index, written by the main process only */
+	t_u32 rx_ring_head;
+    /** Rx ring consumer index, written by the rx process only */
+	t_u32 rx_ring_tail;
 #ifdef MFG_CMD_SUPPORT
 	t_u32 mfg_mode;
 #endif
@@ -2196,6 +2390,8 @@ typedef struct _mlan_adapter {
 	t_bool mc_policy;
 	/** flag for sdio rx aggr */
 	t_bool sdio_rx_aggr_enable;
+	/** poll for init command responses instead of the SDIO interrupt */
+	t_u8 init_cmd_poll;
 	/** fw rx block size */
 	t_u16 sdio_rx_block_size;
     /**channel param band config */
@@ -2221,6 +2417,10 @@ typedef struct _mlan_adapter {
 #define MLAN_ETHER_PKT_TYPE_WAPI	(0x88B4)
 /** Ethernet packet type offset */
 #define MLAN_ETHER_PKT_TYPE_OFFSET	(12)
+/** Ethernet packet type for IPv4 */
+#define MLAN_ETHER_PKT_TYPE_IPV4	(0x0800)
+/** Ethernet packet type for IPv6 */
+#define MLAN_ETHER_PKT_TYPE_IPV6	(0x86DD)
 
 mlan_status wlan_init_lock_list(IN pmlan_adapter pmadapter);
 mlan_status wlan_init_priv_lock_list(IN pmlan_adapter pmadapter,
@@ -2374,6 +2574,8 @@ t_u8 wlan_check_last_packet_indication(pmlan_private priv);
 
 #define MOAL_ALLOC_MLAN_BUFFER  (0)
 #define MOAL_MALLOC_BUFFER      (1)
+/** moal_alloc_mlan_buffer from the MOAL recycle pool, MLAN must free it */
+#define MOAL_ALLOC_POOL_BUFFER  (2)
 
 /** function to allocate a mlan_buffer */
 pmlan_buffer wlan_alloc_mlan_buffer(mlan_adapter *pmadapter, t_u32 data_len,
@@ -2592,6 +2794,15 @@ mlan_status wlan_ops_sta_init_cmd(IN t_void *priv, IN t_u8 first_bss);
 /** Flush the scan table */
 mlan_status wlan_flush_scan_table(IN pmlan_adapter pmadapter);
 
+/** Allocate the beacon store */
+mlan_status wlan_bcn_store_init(IN pmlan_adapter pmadapter);
+/** Return every beacon chunk to the store */
+t_void wlan_bcn_store_reset(IN pmlan_adapter pmadapter);
+/** Free the beacon store */
+t_void wlan_bcn_store_free(IN pmlan_adapter pmadapter);
+/** Rebuild the scan table hash index */
+t_void wlan_scan_hash_rebuild(IN pmlan_adapter pmadapter);
+
 /** Scan for networks */
 mlan_status wlan_scan_networks(IN mlan_private *pmpriv,
 			       IN t_void *pioctl_buf,
@@ -2856,6 +3067,12 @@ t_void wlan_delete_station_list(pmlan_private priv);
 t_void wlan_delete_station_entry(mlan_private *priv, t_u8 *mac);
 /** add station entry */
 sta_node *wlan_add_station_entry(mlan_private *priv, t_u8 *mac);
+/** get peer index node */
+peer_node *wlan_get_peer_node(mlan_private *priv, t_u8 *mac);
+/** add peer index node */
+peer_node *wlan_add_peer_node(mlan_private *priv, t_u8 *mac);
+/** release peer index node if it is no longer used */
+t_void wlan_release_peer_node(mlan_private *priv, peer_node *peer);
 /** process uap rx packet */
 
 void wlan_check_sta_capability(pmlan_private priv, pmlan_buffer pevent,
@@ -3355,6 +3572,113 @@ wlan_isspace(t_u8 chr)
 	return chr <= ' ' && (chr == ' ' || (chr <= 13 && chr >= 9));
 }
 
+/**
+ *  @brief Stamp a TX latency trace point on a traced packet
+ *
+ *  @param pmadapter        A pointer to mlan_adapter structure
+ *  @param pmbuf            A pointer to mlan_buffer
+ *  @param point            MLAN_TX_TS_* trace point
+ *
+ *  @return                 N/A
+ */
+static INLINE t_void
+wlan_tx_lat_stamp(mlan_adapter *pmadapter, pmlan_buffer pmbuf, t_u8 point)
+{
+	t_u64 ns = 0;
+
+	/* Only packets stamped by the kernel enqueue are traced */
+	if (!pmbuf->tx_ts[MLAN_TX_TS_KERNEL])
+		return;
+	pmadapter->callbacks.moal_get_boot_ktime(pmadapter->pmoal_handle, &ns);
+	pmbuf->tx_ts[point] = (t_u32)(ns >> 10) | 1;
+}
+
+/**
+ *  @brief Copy the TX latency stamps an AMSDU collected back to one of
+ *         its MSDUs, so the MSDU's own completion records them
+ *
+ *  @param pmbuf_aggr       A pointer to the AMSDU mlan_buffer
+ *  @param pmbuf            A pointer to the MSDU mlan_buffer
+ *
+ *  @return                 N/A
+ */
+static INLINE t_void
+wlan_tx_lat_copy_back(pmlan_buffer pmbuf_aggr, pmlan_buffer pmbuf)
+{
+	t_u8 point;
+
+	if (!pmbuf->tx_ts[MLAN_TX_TS_KERNEL])
+		return;
+	for (point = MLAN_TX_TS_DEQUEUE; point < MLAN_TX_TS_NUM; point++)
+		if (pmbuf_aggr->tx_ts[point])
+			pmbuf->tx_ts[point] = pmbuf_aggr->tx_ts[point];
+}
+
+/**
+ *  @brief Get the number of packets in the Rx data ring
+ *
+ *  @param pmadapter        A pointer to mlan_adapter structure
+ *
+ *  @return                 Number of queued packets
+ */
+static INLINE t_u32
+wlan_rx_pkts_queued(mlan_adapter *pmadapter)
+{
+	pmlan_callbacks pcb = &pmadapter->callbacks;
+
+	return pcb->moal_load_acquire(&pmadapter->rx_ring_head) -
+		pcb->moal_load_acquire(&pmadapter->rx_ring_tail);
+}
+
+/**
+ *  @brief Queue a packet to the Rx data ring, from the main process only
+ *
+ *  @param pmadapter        A pointer to mlan_adapter structure
+ *  @param pmbuf            A pointer to mlan_buffer
+ *
+ *  @return                 N/A
+ */
+static INLINE t_void
+wlan_rx_ring_put(mlan_adapter *pmadapter, pmlan_buffer pmbuf)
+{
+	pmlan_callbacks pcb = &pmadapter->callbacks;
+	t_u32 head = pmadapter->rx_ring_head;
+
+	if (head - pcb->moal_load_acquire(&pmadapter->rx_ring_tail) >=
+	    MLAN_RX_RING_SIZE) {
+		PRINTM(MERROR, "Rx data ring full, drop packet\n");
+		pmadapter->dbg.num_pkt_dropped++;
+		wlan_free_mlan_buffer(pmadapter, pmbuf);
+		return;
+	}
+	pmadapter->rx_ring[head & (MLAN_RX_RING_SIZE - 1)] = pmbuf;
+	/* Publish the slot before the new head */
+	pcb->moal_store_release(&pmadapter->rx_ring_head, head + 1);
+}
+
+/**
+ *  @brief Dequeue a packet from the Rx data ring, from the rx process
+ *         or with the rx process blocked
+ *
+ *  @param pmadapter        A pointer to mlan_adapter structure
+ *
+ *  @return                 A pointer to mlan_buffer or MNULL
+ */
+static INLINE pmlan_buffer
+wlan_rx_ring_get(mlan_adapter *pmadapter)
+{
+	pmlan_callbacks pcb = &pmadapter->callbacks;
+	t_u32 tail = pmadapter->rx_ring_tail;
+	pmlan_buffer pmbuf;
+
+	if (pcb->moal_load_acquire(&pmadapter->rx_ring_head) == tail)
+		return MNULL;
+	pmbuf = pmadapter->rx_ring[tail & (MLAN_RX_RING_SIZE - 1)];
+	/* Release the slot only after it has been read */
+	pcb->moal_store_release(&pmadapter->rx_ring_tail, tail + 1);
+	return pmbuf;
+}
+
 /** delay unit */
 typedef enum _delay_unit {
 	USEC,
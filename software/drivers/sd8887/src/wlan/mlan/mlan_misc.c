@@ -528,6 +528,9 @@ wlan_get_info_debug_info(IN pmlan_adapter pmadapter,
 			= pmadapter->dbg.num_cmd_sleep_cfm_host_to_card_failure;
 		debug_info->num_tx_host_to_card_failure
 			= pmadapter->dbg.num_tx_host_to_card_failure;
+		memcpy(pmadapter, debug_info->num_tx_batch,
+		       pmadapter->dbg.num_tx_batch,
+		       sizeof(pmadapter->dbg.num_tx_batch));
 		debug_info->num_alloc_buffer_failure =
 			pmadapter->dbg.num_alloc_buffer_failure;
 		debug_info->num_pkt_dropped = pmadapter->dbg.num_pkt_dropped;
@@ -574,6 +577,11 @@ wlan_get_info_debug_info(IN pmlan_adapter pmadapter,
 		       sizeof(pmadapter->dbg.last_event));
 		debug_info->last_event_index = pmadapter->dbg.last_event_index;
 		debug_info->num_no_cmd_node = pmadapter->dbg.num_no_cmd_node;
+		memcpy(pmadapter, debug_info->cmd_lat, pmadapter->dbg.cmd_lat,
+		       sizeof(pmadapter->dbg.cmd_lat));
+		debug_info->init_cmd_cnt = pmadapter->dbg.init_cmd_cnt;
+		debug_info->init_cmd_us = pmadapter->dbg.init_cmd_us;
+		debug_info->init_total_us = pmadapter->dbg.init_total_us;
 		debug_info->pending_cmd =
 			(pmadapter->curr_cmd) ? pmadapter->dbg.
 			last_cmd_id[pmadapter->dbg.last_cmd_index] : 0;
@@ -618,6 +626,9 @@ wlan_get_info_debug_info(IN pmlan_adapter pmadapter,
 		memcpy(pmadapter, debug_info->mpa_rx_count,
 		       pmadapter->mpa_rx_count,
 		       sizeof(pmadapter->mpa_rx_count));
+		debug_info->mpa_rx_pkt_limit = pmadapter->mpa_rx.pkt_aggr_limit;
+		debug_info->mpa_rx_buf_limit = MP_RX_AGGR_BUF_LIMIT(pmadapter);
+		debug_info->mpa_rx_cmd53_lat_us = pmadapter->mpa_rx.avg_lat_us;
 #endif
 		debug_info->data_sent = pmadapter->data_sent;
 		debug_info->cmd_sent = pmadapter->cmd_sent;
@@ -637,7 +648,7 @@ wlan_get_info_debug_info(IN pmlan_adapter pmadapter,
 		debug_info->fw_hang_report = pmadapter->fw_hang_report;
 		debug_info->mlan_processing = pmadapter->mlan_processing;
 		debug_info->mlan_rx_processing = pmadapter->mlan_rx_processing;
-		debug_info->rx_pkts_queued = pmadapter->rx_pkts_queued;
+		debug_info->rx_pkts_queued = wlan_rx_pkts_queued(pmadapter);
 		debug_info->mlan_adapter = pmadapter;
 		debug_info->mlan_adapter_size = sizeof(mlan_adapter);
 		debug_info->mlan_priv_num = pmadapter->priv_num;
@@ -1017,10 +1028,22 @@ wlan_alloc_mlan_buffer(mlan_adapter *pmadapter, t_u32 data_len, t_u32 head_room,
 		break;
 
 	case MOAL_ALLOC_MLAN_BUFFER:
+	case MOAL_ALLOC_POOL_BUFFER:
 		/* use moal_alloc_mlan_buffer, head_room supported */
-		ret = pcb->moal_alloc_mlan_buffer(pmadapter->pmoal_handle,
-						  data_len + DMA_ALIGNMENT +
-						  head_room, &pmbuf);
+		if (malloc_flag == MOAL_ALLOC_POOL_BUFFER &&
+		    pcb->moal_alloc_pool_mlan_buffer)
+			ret = pcb->moal_alloc_pool_mlan_buffer(pmadapter->
+							       pmoal_handle,
+							       data_len +
+							       DMA_ALIGNMENT +
+							       head_room,
+							       &pmbuf);
+		else
+			ret = pcb->moal_alloc_mlan_buffer(pmadapter->
+							  pmoal_handle,
+							  data_len +
+							  DMA_ALIGNMENT +
+							  head_room, &pmbuf);
 		if ((ret != MLAN_STATUS_SUCCESS) || !pmbuf) {
 			PRINTM(MERROR, "Failed to allocate 'mlan_buffer'\n");
 			goto exit;
@@ -1711,6 +1734,107 @@ wlan_is_station_list_empty(mlan_private *priv)
 	return MFALSE;
 }
 
+/**
+ *  @brief This function will return the peer index node which matches
+ *          the given mac address
+ *
+ *  @param priv    A pointer to mlan_private
+ *  @param mac     mac address to find in peer hash
+ *
+ *  @return	   A pointer to structure peer_node or MNULL
+ */
+peer_node *
+wlan_get_peer_node(mlan_private *priv, t_u8 *mac)
+{
+	peer_node *peer;
+
+	peer = priv->peer_hash[MLAN_PEER_HASH(mac)];
+	while (peer) {
+		if (!memcmp(priv->adapter, peer->mac_addr, mac,
+			    MLAN_MAC_ADDR_LENGTH))
+			return peer;
+		peer = peer->hnext;
+	}
+	return MNULL;
+}
+
+/**
+ *  @brief This function will add a peer index node with the given mac
+ *          address, if it does not exist already
+ *
+ *  Caller must hold ra_list_spinlock.
+ *
+ *  @param priv    A pointer to mlan_private
+ *  @param mac     mac address of the peer
+ *
+ *  @return	   A pointer to structure peer_node or MNULL
+ */
+peer_node *
+wlan_add_peer_node(mlan_private *priv, t_u8 *mac)
+{
+	peer_node *peer;
+	t_u8 idx;
+
+	ENTER();
+	peer = wlan_get_peer_node(priv, mac);
+	if (peer) {
+		LEAVE();
+		return peer;
+	}
+	if (priv->adapter->callbacks.
+	    moal_malloc(priv->adapter->pmoal_handle, sizeof(peer_node),
+			MLAN_MEM_DEF, (t_u8 **)&peer)) {
+		PRINTM(MERROR, "Failed to allocate memory for peer node\n");
+		LEAVE();
+		return MNULL;
+	}
+	memset(priv->adapter, peer, 0, sizeof(peer_node));
+	memcpy(priv->adapter, peer->mac_addr, mac, MLAN_MAC_ADDR_LENGTH);
+	idx = MLAN_PEER_HASH(mac);
+	peer->hnext = priv->peer_hash[idx];
+	priv->peer_hash[idx] = peer;
+	LEAVE();
+	return peer;
+}
+
+/**
+ *  @brief This function will free a peer index node which no longer
+ *          refers to a station entry or any RA list
+ *
+ *  Caller must hold ra_list_spinlock.
+ *
+ *  @param priv    A pointer to mlan_private
+ *  @param peer    A pointer to peer_node
+ *
+ *  @return	   N/A
+ */
+t_void
+wlan_release_peer_node(mlan_private *priv, peer_node *peer)
+{
+	peer_node **pprev;
+	int i;
+
+	ENTER();
+	if (!peer || peer->sta_ptr) {
+		LEAVE();
+		return;
+	}
+	for (i = 0; i < MAX_NUM_TID; i++) {
+		if (peer->ra_list[i]) {
+			LEAVE();
+			return;
+		}
+	}
+	pprev = &priv->peer_hash[MLAN_PEER_HASH(peer->mac_addr)];
+	while (*pprev && *pprev != peer)
+		pprev = &(*pprev)->hnext;
+	if (*pprev)
+		*pprev = peer->hnext;
+	priv->adapter->callbacks.moal_mfree(priv->adapter->pmoal_handle,
+					    (t_u8 *)peer);
+	LEAVE();
+}
+
 /**
  *  @brief This function will return the pointer to station entry in station list
  *          table which matches the give mac address
@@ -1723,7 +1847,7 @@ wlan_is_station_list_empty(mlan_private *priv)
 sta_node *
 wlan_get_station_entry(mlan_private *priv, t_u8 *mac)
 {
-	sta_node *sta_ptr;
+	peer_node *peer;
 
 	ENTER();
 
@@ -1731,20 +1855,9 @@ wlan_get_station_entry(mlan_private *priv, t_u8 *mac)
 		LEAVE();
 		return MNULL;
 	}
-	sta_ptr = (sta_node *)util_peek_list(priv->adapter->pmoal_handle,
-					     &priv->sta_list, MNULL, MNULL);
-
-	while (sta_ptr && (sta_ptr != (sta_node *)&priv->sta_list)) {
-		if (!memcmp
-		    (priv->adapter, sta_ptr->mac_addr, mac,
-		     MLAN_MAC_ADDR_LENGTH)) {
-			LEAVE();
-			return sta_ptr;
-		}
-		sta_ptr = sta_ptr->pnext;
-	}
+	peer = wlan_get_peer_node(priv, mac);
 	LEAVE();
-	return MNULL;
+	return peer ? peer->sta_ptr : MNULL;
 }
 
 /**
@@ -1760,6 +1873,7 @@ sta_node *
 wlan_add_station_entry(mlan_private *priv, t_u8 *mac)
 {
 	sta_node *sta_ptr = MNULL;
+	peer_node *peer = MNULL;
 	mlan_adapter *pmadapter = priv->adapter;
 
 	ENTER();
@@ -1769,10 +1883,19 @@ wlan_add_station_entry(mlan_private *priv, t_u8 *mac)
 	sta_ptr = wlan_get_station_entry(priv, mac);
 	if (sta_ptr)
 		goto done;
+	peer = wlan_add_peer_node(priv, mac);
+	if (!peer) {
+		pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
+						      priv->wmm.
+						      ra_list_spinlock);
+		LEAVE();
+		return MNULL;
+	}
 	if (priv->adapter->callbacks.
 	    moal_malloc(priv->adapter->pmoal_handle, sizeof(sta_node),
 			MLAN_MEM_DEF, (t_u8 **)&sta_ptr)) {
 		PRINTM(MERROR, "Failed to allocate memory for station node\n");
+		wlan_release_peer_node(priv, peer);
 		pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
 						      priv->wmm.
 						      ra_list_spinlock);
@@ -1783,6 +1906,7 @@ wlan_add_station_entry(mlan_private *priv, t_u8 *mac)
 	memcpy(priv->adapter, sta_ptr->mac_addr, mac, MLAN_MAC_ADDR_LENGTH);
 	util_enqueue_list_tail(priv->adapter->pmoal_handle, &priv->sta_list,
 			       (pmlan_linked_list)sta_ptr, MNULL, MNULL);
+	peer->sta_ptr = sta_ptr;
 done:
 	pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
 					      priv->wmm.ra_list_spinlock);
@@ -1803,16 +1927,21 @@ t_void
 wlan_delete_station_entry(mlan_private *priv, t_u8 *mac)
 {
 	sta_node *sta_ptr = MNULL;
+	peer_node *peer = MNULL;
 	mlan_adapter *pmadapter = priv->adapter;
 	ENTER();
 	pmadapter->callbacks.moal_spin_lock(pmadapter->pmoal_handle,
 					    priv->wmm.ra_list_spinlock);
-	sta_ptr = wlan_get_station_entry(priv, mac);
+	peer = wlan_get_peer_node(priv, mac);
+	if (peer)
+		sta_ptr = peer->sta_ptr;
 	if (sta_ptr) {
 		util_unlink_list(priv->adapter->pmoal_handle, &priv->sta_list,
 				 (pmlan_linked_list)sta_ptr, MNULL, MNULL);
 		priv->adapter->callbacks.moal_mfree(priv->adapter->pmoal_handle,
 						    (t_u8 *)sta_ptr);
+		peer->sta_ptr = MNULL;
+		wlan_release_peer_node(priv, peer);
 	}
 	pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
 					      priv->wmm.ra_list_spinlock);
@@ -1831,6 +1960,8 @@ t_void
 wlan_delete_station_list(pmlan_private priv)
 {
 	sta_node *sta_ptr;
+	peer_node *peer;
+	mlan_adapter *pmadapter = priv->adapter;
 
 	ENTER();
 	while ((sta_ptr =
@@ -1840,6 +1971,16 @@ wlan_delete_station_list(pmlan_private priv)
 					      moal_spin_lock,
 					      priv->adapter->callbacks.
 					      moal_spin_unlock))) {
+		pmadapter->callbacks.moal_spin_lock(pmadapter->pmoal_handle,
+						    priv->wmm.ra_list_spinlock);
+		peer = wlan_get_peer_node(priv, sta_ptr->mac_addr);
+		if (peer && peer->sta_ptr == sta_ptr) {
+			peer->sta_ptr = MNULL;
+			wlan_release_peer_node(priv, peer);
+		}
+		pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
+						      priv->wmm.
+						      ra_list_spinlock);
 		priv->adapter->callbacks.moal_mfree(priv->adapter->pmoal_handle,
 						    (t_u8 *)sta_ptr);
 	}
@@ -48,6 +48,10 @@ EXPORT_SYMBOL(mlan_hs_callback);
 
 EXPORT_SYMBOL(mlan_pm_wakeup_card);
 EXPORT_SYMBOL(mlan_is_main_process_running);
+#ifdef HOTPATH_TRACE
+EXPORT_SYMBOL(mlan_trace_enable);
+EXPORT_SYMBOL(mlan_trace_read);
+#endif
 
 MODULE_DESCRIPTION("M-WLAN MLAN Driver");
 MODULE_AUTHOR("NXP");
@@ -97,6 +97,15 @@ typedef union {
 	t_u8 config_alloc_buf[MAX_SCAN_CFG_ALLOC];
 } wlan_scan_cmd_config_tlv;
 
+/**
+ * Beacon store chunk sizes.  Every size is a multiple of 8 so the free
+ * list link kept at the start of a free chunk stays aligned.
+ */
+static const t_u16 bcn_chunk_size[BCN_SLAB_NUM_CLASS] = {
+	128, 192, 256, 320, 384, 448, 512, 640, 768, 1024, 1360, 2048,
+	BCN_SLAB_SIZE
+};
+
 /********************************************************
 			Global Variables
 ********************************************************/
@@ -2502,26 +2511,347 @@ wlan_adjust_ie_in_bss_entry(IN mlan_private *pmpriv,
 }
 
 /**
- *  @brief Store a beacon or probe response for a BSS returned in the scan
+ *  @brief Hash a BSSID into a scan table hash bucket
+ *
+ *  @param pmac         A pointer to the BSSID
+ *
+ *  @return             Bucket index
+ */
+static t_u8
+wlan_scan_bssid_hash(IN t_u8 *pmac)
+{
+	t_u32 hash = 0;
+	t_u8 i;
+
+	for (i = 0; i < MLAN_MAC_ADDR_LENGTH; i++)
+		hash = hash * 31 + pmac[i];
+	return (t_u8)(hash & (SCAN_HASH_SIZE - 1));
+}
+
+/**
+ *  @brief Hash an SSID into a scan table hash bucket
+ *
+ *  @param pssid        A pointer to the SSID
+ *
+ *  @return             Bucket index
+ */
+static t_u8
+wlan_scan_ssid_hash(IN mlan_802_11_ssid *pssid)
+{
+	t_u32 hash = pssid->ssid_len;
+	t_u32 i;
+
+	for (i = 0; i < pssid->ssid_len && i < MLAN_MAX_SSID_LENGTH; i++)
+		hash = hash * 31 + pssid->ssid[i];
+	return (t_u8)(hash & (SCAN_HASH_SIZE - 1));
+}
+
+/**
+ *  @brief Link a scan table index into a hash chain
+ *
+ *  Chains are kept in ascending index order so lookups visit entries in
+ *    the same order as a walk over the whole table would.
+ *
+ *  @param phead        A pointer to the bucket head
+ *  @param pnext        Next index array of the hash
+ *  @param idx          Scan table index
+ *
+ *  @return             N/A
+ */
+static t_void
+wlan_scan_chain_insert(IN t_s16 *phead, IN t_s16 *pnext, IN t_s16 idx)
+{
+	while (*phead >= 0 && *phead < idx)
+		phead = &pnext[*phead];
+	pnext[idx] = *phead;
+	*phead = idx;
+}
+
+/**
+ *  @brief Unlink a scan table index from a hash chain
+ *
+ *  @param phead        A pointer to the bucket head
+ *  @param pnext        Next index array of the hash
+ *  @param idx          Scan table index
+ *
+ *  @return             N/A
+ */
+static t_void
+wlan_scan_chain_remove(IN t_s16 *phead, IN t_s16 *pnext, IN t_s16 idx)
+{
+	while (*phead >= 0 && *phead != idx)
+		phead = &pnext[*phead];
+	if (*phead == idx)
+		*phead = pnext[idx];
+}
+
+/**
+ *  @brief Add a scan table entry to the BSSID and SSID hashes
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param idx          Scan table index
+ *
+ *  @return             N/A
+ */
+static t_void
+wlan_scan_hash_add(IN mlan_adapter *pmadapter, IN t_u32 idx)
+{
+	BSSDescriptor_t *pbss_desc = &pmadapter->pscan_table[idx];
+
+	wlan_scan_chain_insert(&pmadapter->
+			       bssid_hash[wlan_scan_bssid_hash
+					  (pbss_desc->mac_address)],
+			       pmadapter->bssid_hash_next, (t_s16)idx);
+	wlan_scan_chain_insert(&pmadapter->
+			       ssid_hash[wlan_scan_ssid_hash(&pbss_desc->ssid)],
+			       pmadapter->ssid_hash_next, (t_s16)idx);
+}
+
+/**
+ *  @brief Remove a scan table entry from the BSSID and SSID hashes
+ *
+ *  Must be called before the BSSID or SSID of the entry changes.  Nothing
+ *    is done for an entry that is not hashed.
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param idx          Scan table index
+ *
+ *  @return             N/A
+ */
+static t_void
+wlan_scan_hash_del(IN mlan_adapter *pmadapter, IN t_u32 idx)
+{
+	BSSDescriptor_t *pbss_desc = &pmadapter->pscan_table[idx];
+
+	wlan_scan_chain_remove(&pmadapter->
+			       bssid_hash[wlan_scan_bssid_hash
+					  (pbss_desc->mac_address)],
+			       pmadapter->bssid_hash_next, (t_s16)idx);
+	wlan_scan_chain_remove(&pmadapter->
+			       ssid_hash[wlan_scan_ssid_hash(&pbss_desc->ssid)],
+			       pmadapter->ssid_hash_next, (t_s16)idx);
+}
+
+/**
+ *  @brief Find the scan table entry a new scan result replaces
+ *
+ *  A result replaces the entry with the same BSSID and either the same
+ *    SSID or a NULL SSID.
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param pbss_desc    A pointer to the new scan result
+ *  @param num_in_table Number of entries currently in the table
+ *
+ *  @return             Index of the duplicate, num_in_table if none
+ */
+static t_u32
+wlan_scan_find_dup_entry(IN mlan_adapter *pmadapter,
+			 IN BSSDescriptor_t *pbss_desc, IN t_u32 num_in_table)
+{
+	BSSDescriptor_t *pentry;
+	t_u8 null_ssid[MLAN_MAX_SSID_LENGTH] = { 0 };
+	t_s16 idx;
+
+	for (idx = pmadapter->
+	     bssid_hash[wlan_scan_bssid_hash(pbss_desc->mac_address)];
+	     idx >= 0 && (t_u32)idx < num_in_table;
+	     idx = pmadapter->bssid_hash_next[idx]) {
+		pentry = &pmadapter->pscan_table[idx];
+		if (memcmp(pmadapter, pbss_desc->mac_address,
+			   pentry->mac_address, MLAN_MAC_ADDR_LENGTH))
+			continue;
+		/*
+		 * If the SSID matches as well, or the SSID is NULL for the
+		 * same BSSID, replace the old contents in the table
+		 */
+		if ((pbss_desc->ssid.ssid_len == pentry->ssid.ssid_len &&
+		     !memcmp(pmadapter, pbss_desc->ssid.ssid,
+			     pentry->ssid.ssid, pbss_desc->ssid.ssid_len)) ||
+		    !memcmp(pmadapter, pentry->ssid.ssid, null_ssid,
+			    pentry->ssid.ssid_len)) {
+			PRINTM(MINFO, "SCAN_RESP: Duplicate of index: %d\n",
+			       idx);
+			return (t_u32)idx;
+		}
+	}
+	return num_in_table;
+}
+
+/**
+ *  @brief Find the beacon store slab a chunk belongs to
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param pchunk       A pointer to the chunk
+ *
+ *  @return             A pointer to the slab, MNULL if not found
+ */
+static bcn_slab *
+wlan_bcn_find_slab(IN mlan_adapter *pmadapter, IN t_u8 *pchunk)
+{
+	bcn_slab *pslab;
+	t_u8 i;
+
+	for (i = 0; i < pmadapter->bcn_slab_num; i++) {
+		pslab = &pmadapter->bcn_slabs[i];
+		if (pslab->buf && pchunk >= pslab->buf &&
+		    pchunk < pslab->buf + BCN_SLAB_SIZE)
+			return pslab;
+	}
+	return MNULL;
+}
+
+/**
+ *  @brief Carve a slab into chunks of one size class
+ *
+ *  Use a slab that has not been carved yet, allocating it if the store
+ *    limit allows.  Failing that, take back an idle slab from another
+ *    size class.
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param cls          Size class index
+ *
+ *  @return             MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
+ */
+static mlan_status
+wlan_bcn_slab_carve(IN mlan_adapter *pmadapter, IN t_u8 cls)
+{
+	pmlan_callbacks pcb = &pmadapter->callbacks;
+	bcn_slab *pslab = MNULL;
+	t_u8 **pplink;
+	t_u8 *pchunk;
+	t_u16 size = bcn_chunk_size[cls];
+	t_u8 i;
+	mlan_status ret;
+
+	for (i = 0; i < pmadapter->bcn_slab_num; i++) {
+		if (pmadapter->bcn_slabs[i].buf &&
+		    pmadapter->bcn_slabs[i].cls == BCN_SLAB_CLASS_NONE) {
+			pslab = &pmadapter->bcn_slabs[i];
+			break;
+		}
+	}
+	for (i = 0; !pslab && i < pmadapter->bcn_slab_num; i++) {
+		if (pmadapter->bcn_slabs[i].buf)
+			continue;
+		ret = pcb->moal_malloc(pmadapter->pmoal_handle, BCN_SLAB_SIZE,
+				       MLAN_MEM_DEF,
+				       &pmadapter->bcn_slabs[i].buf);
+		if (ret != MLAN_STATUS_SUCCESS || !pmadapter->bcn_slabs[i].buf) {
+			pmadapter->bcn_slabs[i].buf = MNULL;
+			break;
+		}
+		pslab = &pmadapter->bcn_slabs[i];
+		pslab->cls = BCN_SLAB_CLASS_NONE;
+		pslab->inuse = 0;
+	}
+	for (i = 0; !pslab && i < pmadapter->bcn_slab_num; i++) {
+		if (!pmadapter->bcn_slabs[i].buf ||
+		    pmadapter->bcn_slabs[i].inuse ||
+		    pmadapter->bcn_slabs[i].cls == cls)
+			continue;
+		pslab = &pmadapter->bcn_slabs[i];
+		/* Unlink the idle slab's chunks from its old class */
+		pplink = &pmadapter->bcn_free[pslab->cls];
+		while (*pplink) {
+			if (*pplink >= pslab->buf &&
+			    *pplink < pslab->buf + BCN_SLAB_SIZE)
+				*pplink = *(t_u8 **)*pplink;
+			else
+				pplink = (t_u8 **)*pplink;
+		}
+		PRINTM(MINFO, "Beacon store: slab %d class %d -> %d\n", i,
+		       bcn_chunk_size[pslab->cls], size);
+	}
+	if (!pslab)
+		return MLAN_STATUS_FAILURE;
+
+	pslab->cls = cls;
+	for (pchunk = pslab->buf; pchunk + size <= pslab->buf + BCN_SLAB_SIZE;
+	     pchunk += size) {
+		*(t_u8 **)pchunk = pmadapter->bcn_free[cls];
+		pmadapter->bcn_free[cls] = pchunk;
+	}
+	return MLAN_STATUS_SUCCESS;
+}
+
+/**
+ *  @brief Take a chunk from the beacon store
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param size         Number of bytes needed
+ *  @param pchunk_size  Returns the usable size of the chunk
+ *
+ *  @return             A pointer to the chunk, MNULL if the store is full
+ */
+static t_u8 *
+wlan_bcn_chunk_alloc(IN mlan_adapter *pmadapter, IN t_u32 size,
+		     OUT t_u16 *pchunk_size)
+{
+	bcn_slab *pslab;
+	t_u8 *pchunk;
+	t_u8 cls;
+
+	for (cls = 0; cls < BCN_SLAB_NUM_CLASS; cls++) {
+		if (size <= bcn_chunk_size[cls])
+			break;
+	}
+	if (cls == BCN_SLAB_NUM_CLASS)
+		return MNULL;
+	if (!pmadapter->bcn_free[cls] &&
+	    wlan_bcn_slab_carve(pmadapter, cls) != MLAN_STATUS_SUCCESS)
+		return MNULL;
+
+	pchunk = pmadapter->bcn_free[cls];
+	pmadapter->bcn_free[cls] = *(t_u8 **)pchunk;
+	pslab = wlan_bcn_find_slab(pmadapter, pchunk);
+	if (pslab)
+		pslab->inuse++;
+	pmadapter->bcn_used += bcn_chunk_size[cls];
+	*pchunk_size = bcn_chunk_size[cls];
+	return pchunk;
+}
+
+/**
+ *  @brief Return a chunk to the beacon store
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param pchunk       A pointer to the chunk
  *
- *  Store a new scan response or an update for a previous scan response.  New
- *    entries need to verify that they do not exceed the total amount of
- *    memory allocated for the table.
+ *  @return             N/A
+ */
+static t_void
+wlan_bcn_chunk_free(IN mlan_adapter *pmadapter, IN t_u8 *pchunk)
+{
+	bcn_slab *pslab = wlan_bcn_find_slab(pmadapter, pchunk);
 
- *  Replacement entries need to take into consideration the amount of space
- *    currently allocated for the beacon/probe response and adjust the entry
- *    as needed.
+	if (!pslab || pslab->cls == BCN_SLAB_CLASS_NONE || !pslab->inuse) {
+		PRINTM(MERROR, "Beacon store: bad chunk %p\n", pchunk);
+		return;
+	}
+	pslab->inuse--;
+	pmadapter->bcn_used -= bcn_chunk_size[pslab->cls];
+	*(t_u8 **)pchunk = pmadapter->bcn_free[pslab->cls];
+	pmadapter->bcn_free[pslab->cls] = pchunk;
+}
+
+/**
+ *  @brief Store a beacon or probe response for a BSS returned in the scan
+ *
+ *  Store a new scan response or an update for a previous scan response.
+ *    Each entry owns one chunk of the beacon store, so storing or
+ *    replacing an entry never moves the beacon data of other entries.
  *
- *  A small amount of extra pad (SCAN_BEACON_ENTRY_PAD) is generally reserved
- *    for an entry in case it is a beacon since a probe response for the
- *    network will by larger per the standard.  This helps to reduce the
- *    amount of memory copying to fit a new probe response into an entry
- *    already occupied by a network's previously stored beacon.
+ *  Replacement entries are copied over the old data when they fit in the
+ *    chunk already owned by the entry, otherwise they are moved to a
+ *    larger chunk.  If no larger chunk is available the old beacon is kept.
+ *
+ *  A small amount of extra pad (SCAN_BEACON_ENTRY_PAD) is reserved when
+ *    picking the chunk for a new entry in case it is a beacon since a
+ *    probe response for the network will by larger per the standard.
  *
  *  @param pmpriv       A pointer to mlan_private structure
  *  @param beacon_idx   Index in the scan table to store this entry; may be
  *                      replacing an older duplicate entry for this BSS
- *  @param num_of_ent   Number of entries currently in the table
  *  @param pnew_beacon  Pointer to the new beacon/probe response to save
  *
  *  @return           N/A
@@ -2529,19 +2859,15 @@ wlan_adjust_ie_in_bss_entry(IN mlan_private *pmpriv,
 static t_void
 wlan_ret_802_11_scan_store_beacon(IN mlan_private *pmpriv,
 				  IN t_u32 beacon_idx,
-				  IN t_u32 num_of_ent,
 				  IN BSSDescriptor_t *pnew_beacon)
 {
 	mlan_adapter *pmadapter = pmpriv->adapter;
 	t_u8 *pbcn_store;
+	t_u8 *pnew_store;
 	t_u32 new_bcn_size;
 	t_u32 old_bcn_size;
 	t_u32 bcn_space;
-	t_u32 adj_idx;
-	mlan_status ret = MLAN_STATUS_SUCCESS;
-	t_u8 *tmp_buf;
-	t_u16 bcn_size = 0;
-	t_u32 bcn_offset = 0;
+	t_u16 chunk_size = 0;
 
 	ENTER();
 
@@ -2557,172 +2883,43 @@ wlan_ret_802_11_scan_store_beacon(IN mlan_private *pmpriv,
 		/* Set the max to be the same as current entry unless changed below */
 		pnew_beacon->beacon_buf_size_max = bcn_space;
 
-		if (new_bcn_size == old_bcn_size) {
+		if (new_bcn_size <= bcn_space) {
 			/*
-			 * Beacon is the same size as the previous entry.
-			 *   Replace the previous contents with the scan result
+			 * New beacon fits in the chunk we have previously
+			 *   allocated for it, replace the previous contents
 			 */
-			memcpy(pmadapter, pbcn_store,
-			       pnew_beacon->pbeacon_buf,
-			       pnew_beacon->beacon_buf_size);
-
-		} else if (new_bcn_size <= bcn_space) {
-			/*
-			 * New beacon size will fit in the amount of space
-			 *   we have previously allocated for it
-			 */
-
-			/* Copy the new beacon buffer entry over the old one */
 			memcpy(pmadapter, pbcn_store, pnew_beacon->pbeacon_buf,
 			       new_bcn_size);
-
-			/*
-			 *  If the old beacon size was less than the
-			 *  maximum we had allotted for the entry, and
-			 *  the new entry is even smaller, reset the
-			 *  max size to the old beacon entry and compress
-			 *  the storage space (leaving a new pad space of
-			 *  (old_bcn_size - new_bcn_size).
-			 */
-			if (old_bcn_size < bcn_space &&
-			    new_bcn_size <= old_bcn_size) {
-				/*
-				 * Old Beacon size is smaller than the
-				 * allotted storage size. Shrink the
-				 * allotted storage space.
-				 */
-				PRINTM(MINFO,
-				       "AppControl: Smaller Duplicate Beacon (%d), "
-				       "old = %d, new = %d, space = %d, left = %d\n",
-				       beacon_idx, old_bcn_size, new_bcn_size,
-				       bcn_space,
-				       (pmadapter->bcn_buf_size -
-					(pmadapter->pbcn_buf_end -
-					 pmadapter->bcn_buf)));
-
-				/*
-				 * memmove (since the memory overlaps) the data
-				 * after the beacon we just stored to the end
-				 * of the current beacon.  This cleans up any
-				 * unused space the old larger beacon was using
-				 * in the buffer
-				 */
-				memmove(pmadapter,
-					(void *)((t_ptr)pbcn_store +
-						 (t_ptr)old_bcn_size),
-					(void *)((t_ptr)pbcn_store +
-						 (t_ptr)bcn_space),
-					(t_u32)((t_ptr)pmadapter->pbcn_buf_end -
-						((t_ptr)pbcn_store +
-						 (t_ptr)bcn_space)));
-
-				/*
-				 * Decrement the end pointer by the difference
-				 * between the old larger size and the new
-				 * smaller size since we are using less space
-				 * due to the new beacon being smaller
-				 */
-				pmadapter->pbcn_buf_end -=
-					(bcn_space - old_bcn_size);
-
-				/*
-				 * Set the maximum storage size to the old
-				 * beacon size
-				 */
-				pnew_beacon->beacon_buf_size_max = old_bcn_size;
-
-				/* Adjust beacon buffer pointers that are past the current */
-				for (adj_idx = 0; adj_idx < num_of_ent;
-				     adj_idx++) {
-					if (pmadapter->pscan_table[adj_idx].
-					    pbeacon_buf > pbcn_store) {
-						pmadapter->pscan_table[adj_idx].
-							pbeacon_buf -=
-							(bcn_space -
-							 old_bcn_size);
-						wlan_adjust_ie_in_bss_entry
-							(pmpriv,
-							 &pmadapter->
-							 pscan_table[adj_idx]);
-					}
-				}
-			}
-		} else if (pmadapter->pbcn_buf_end + (new_bcn_size - bcn_space)
-			   < (pmadapter->bcn_buf + pmadapter->bcn_buf_size)) {
+		} else if ((pnew_store =
+			    wlan_bcn_chunk_alloc(pmadapter,
+						 new_bcn_size +
+						 SCAN_BEACON_ENTRY_PAD,
+						 &chunk_size))) {
 			/*
-			 * Beacon is larger than space previously allocated
-			 * (bcn_space) and there is enough space left in the
-			 * beaconBuffer to store the additional data
+			 * Beacon is larger than the chunk previously allocated
+			 * (bcn_space), move it to a larger chunk
 			 */
 			PRINTM(MINFO,
 			       "AppControl: Larger Duplicate Beacon (%d), "
-			       "old = %d, new = %d, space = %d, left = %d\n",
+			       "old = %d, new = %d, space = %d, chunk = %d\n",
 			       beacon_idx, old_bcn_size, new_bcn_size,
-			       bcn_space,
-			       (pmadapter->bcn_buf_size -
-				(pmadapter->pbcn_buf_end -
-				 pmadapter->bcn_buf)));
+			       bcn_space, chunk_size);
 
-			/*
-			 * memmove (since the memory overlaps) the data
-			 *  after the beacon we just stored to the end of
-			 *  the current beacon.  This moves the data for
-			 *  the beacons after this further in memory to
-			 *  make space for the new larger beacon we are
-			 *  about to copy in.
-			 */
-			memmove(pmadapter,
-				(void *)((t_ptr)pbcn_store +
-					 (t_ptr)new_bcn_size),
-				(void *)((t_ptr)pbcn_store + (t_ptr)bcn_space),
-				(t_u32)((t_ptr)pmadapter->pbcn_buf_end -
-					((t_ptr)pbcn_store +
-					 (t_ptr)bcn_space)));
-
-			/* Copy the new beacon buffer entry over the old one */
-			memcpy(pmadapter, pbcn_store, pnew_beacon->pbeacon_buf,
+			memcpy(pmadapter, pnew_store, pnew_beacon->pbeacon_buf,
 			       new_bcn_size);
-
-			/*
-			 * Move the beacon end pointer by the amount of new
-			 * beacon data we are adding
-			 */
-			pmadapter->pbcn_buf_end += (new_bcn_size - bcn_space);
-
-			/*
-			 * This entry is bigger than the allotted max space
-			 *  previously reserved.  Increase the max space to
-			 *  be equal to the new beacon size
-			 */
-			pnew_beacon->beacon_buf_size_max = new_bcn_size;
-
-			/* Adjust beacon buffer pointers that are past the current */
-			for (adj_idx = 0; adj_idx < num_of_ent; adj_idx++) {
-				if (pmadapter->pscan_table[adj_idx].
-				    pbeacon_buf > pbcn_store) {
-					pmadapter->pscan_table[adj_idx].
-						pbeacon_buf +=
-						(new_bcn_size - bcn_space);
-					wlan_adjust_ie_in_bss_entry(pmpriv,
-								    &pmadapter->
-								    pscan_table
-								    [adj_idx]);
-				}
-			}
+			wlan_bcn_chunk_free(pmadapter, pbcn_store);
+			pbcn_store = pnew_store;
+			pnew_beacon->beacon_buf_size_max = chunk_size;
 		} else {
 			/*
 			 * Beacon is larger than the previously allocated
-			 * space, but there is not enough free space to
-			 * store the additional data
+			 * chunk, but there is no larger chunk available
 			 */
 			PRINTM(MERROR,
 			       "AppControl: Failed: Larger Duplicate Beacon (%d),"
-			       " old = %d, new = %d, space = %d, left = %d\n",
+			       " old = %d, new = %d, space = %d, used = %d\n",
 			       beacon_idx, old_bcn_size, new_bcn_size,
-			       bcn_space,
-			       (pmadapter->bcn_buf_size -
-				(pmadapter->pbcn_buf_end -
-				 pmadapter->bcn_buf)));
+			       bcn_space, pmadapter->bcn_used);
 
 			/* Storage failure, keep old beacon intact */
 			pnew_beacon->beacon_buf_size = old_bcn_size;
@@ -2795,72 +2992,21 @@ wlan_ret_802_11_scan_store_beacon(IN mlan_private *pmpriv,
 		pnew_beacon->pbeacon_buf = pbcn_store;
 		wlan_adjust_ie_in_bss_entry(pmpriv, pnew_beacon);
 	} else {
-		if ((pmadapter->pbcn_buf_end + pnew_beacon->beacon_buf_size +
-		     SCAN_BEACON_ENTRY_PAD > (pmadapter->bcn_buf +
-					      pmadapter->bcn_buf_size)) &&
-		    (pmadapter->bcn_buf_size < MAX_SCAN_BEACON_BUFFER)) {
-			/* no space for this entry, realloc bcn buffer */
-			ret = pmadapter->callbacks.moal_malloc(pmadapter->
-							       pmoal_handle,
-							       pmadapter->
-							       bcn_buf_size +
-							       DEFAULT_SCAN_BEACON_BUFFER,
-							       MLAN_MEM_DEF,
-							       (t_u8 **)
-							       &tmp_buf);
-
-			if ((ret == MLAN_STATUS_SUCCESS) && (tmp_buf)) {
-				PRINTM(MCMND,
-				       "Realloc Beacon buffer, old size=%d, new_size=%d\n",
-				       pmadapter->bcn_buf_size,
-				       pmadapter->bcn_buf_size +
-				       DEFAULT_SCAN_BEACON_BUFFER);
-				bcn_size =
-					pmadapter->pbcn_buf_end -
-					pmadapter->bcn_buf;
-				memcpy(pmadapter, tmp_buf, pmadapter->bcn_buf,
-				       bcn_size);
-				/* Adjust beacon buffer pointers that are past the current */
-				for (adj_idx = 0; adj_idx < num_of_ent;
-				     adj_idx++) {
-					bcn_offset =
-						pmadapter->pscan_table[adj_idx].
-						pbeacon_buf -
-						pmadapter->bcn_buf;
-					pmadapter->pscan_table[adj_idx].
-						pbeacon_buf =
-						tmp_buf + bcn_offset;
-					wlan_adjust_ie_in_bss_entry(pmpriv,
-								    &pmadapter->
-								    pscan_table
-								    [adj_idx]);
-				}
-				pmadapter->pbcn_buf_end = tmp_buf + bcn_size;
-				pmadapter->callbacks.moal_mfree(pmadapter->
-								pmoal_handle,
-								(t_u8 *)
-								pmadapter->
-								bcn_buf);
-				pmadapter->bcn_buf = tmp_buf;
-				pmadapter->bcn_buf_size +=
-					DEFAULT_SCAN_BEACON_BUFFER;
-			}
-		}
 		/*
-		 * No existing beacon data exists for this entry, check to see
-		 *   if we can fit it in the remaining space
+		 * No existing beacon data exists for this entry, take a chunk
+		 *   for it from the beacon store
 		 */
-		if (pmadapter->pbcn_buf_end + pnew_beacon->beacon_buf_size +
-		    SCAN_BEACON_ENTRY_PAD < (pmadapter->bcn_buf +
-					     pmadapter->bcn_buf_size)) {
-
+		pbcn_store = wlan_bcn_chunk_alloc(pmadapter,
+						  pnew_beacon->beacon_buf_size +
+						  SCAN_BEACON_ENTRY_PAD,
+						  &chunk_size);
+		if (pbcn_store) {
 			/*
 			 * Copy the beacon buffer data from the local entry
-			 * to the adapter dev struct buffer space used to
-			 * store the raw beacon data for each entry in the
-			 * scan table
+			 * to the beacon store chunk used to store the raw
+			 * beacon data for this entry in the scan table
 			 */
-			memcpy(pmadapter, pmadapter->pbcn_buf_end,
+			memcpy(pmadapter, pbcn_store,
 			       pnew_beacon->pbeacon_buf,
 			       pnew_beacon->beacon_buf_size);
 
@@ -2868,36 +3014,25 @@ wlan_ret_802_11_scan_store_beacon(IN mlan_private *pmpriv,
 			 * Update the beacon ptr to point to the table
 			 * save area
 			 */
-			pnew_beacon->pbeacon_buf = pmadapter->pbcn_buf_end;
-			pnew_beacon->beacon_buf_size_max =
-				(pnew_beacon->beacon_buf_size +
-				 SCAN_BEACON_ENTRY_PAD);
+			pnew_beacon->pbeacon_buf = pbcn_store;
+			pnew_beacon->beacon_buf_size_max = chunk_size;
 			wlan_adjust_ie_in_bss_entry(pmpriv, pnew_beacon);
 
-			/* Increment the end pointer by the size reserved */
-			pmadapter->pbcn_buf_end +=
-				pnew_beacon->beacon_buf_size_max;
-
 			PRINTM(MINFO, "AppControl: Beacon[%02d] sz=%03d,"
-			       " used = %04d, left = %04d\n",
+			       " chunk = %04d, used = %05d\n",
 			       beacon_idx,
-			       pnew_beacon->beacon_buf_size,
-			       (pmadapter->pbcn_buf_end - pmadapter->bcn_buf),
-			       (pmadapter->bcn_buf_size -
-				(pmadapter->pbcn_buf_end -
-				 pmadapter->bcn_buf)));
+			       pnew_beacon->beacon_buf_size, chunk_size,
+			       pmadapter->bcn_used);
 		} else {
 			/*
 			 * No space for new beacon
 			 */
 			PRINTM(MCMND, "AppControl: No space beacon (%d): "
-			       MACSTR "; sz=%03d, left=%03d\n",
+			       MACSTR "; sz=%03d, used=%05d\n",
 			       beacon_idx,
 			       MAC2STR(pnew_beacon->mac_address),
 			       pnew_beacon->beacon_buf_size,
-			       (pmadapter->bcn_buf_size -
-				(pmadapter->pbcn_buf_end -
-				 pmadapter->bcn_buf)));
+			       pmadapter->bcn_used);
 
 			/*
 			 * Storage failure; clear storage records
@@ -3054,6 +3189,7 @@ wlan_scan_process_results(IN mlan_private *pmpriv)
 	t_u32 i;
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 	BSSDescriptor_t *bss_new_entry = MNULL;
+	BSSDescriptor_t *pbss_last;
 	pmlan_callbacks pcb = &pmadapter->callbacks;
 
 	ENTER();
@@ -3066,9 +3202,11 @@ wlan_scan_process_results(IN mlan_private *pmpriv)
 					    pmpriv->bss_mode);
 
 		if (j >= 0) {
+			wlan_scan_hash_del(pmadapter, j);
 			memcpy(pmadapter, &pmadapter->pscan_table[j].ssid,
 			       &pmpriv->curr_bss_params.bss_descriptor.ssid,
 			       sizeof(mlan_802_11_ssid));
+			wlan_scan_hash_add(pmadapter, j);
 			pmadapter->callbacks.moal_spin_lock(pmadapter->
 							    pmoal_handle,
 							    pmpriv->
@@ -3162,27 +3300,36 @@ wlan_scan_process_results(IN mlan_private *pmpriv)
 					if (pmadapter->num_in_scan_table <
 					    MRVDRV_MAX_BSSID_LIST)
 						pmadapter->num_in_scan_table++;
-					pmadapter->pscan_table[pmadapter->
-							       num_in_scan_table
-							       -
-							       1].pbeacon_buf =
-						MNULL;
+					pbss_last =
+						&pmadapter->
+						pscan_table[pmadapter->
+							    num_in_scan_table -
+							    1];
+					/* Table full, the last entry is replaced */
+					wlan_scan_hash_del(pmadapter,
+							   pmadapter->
+							   num_in_scan_table -
+							   1);
+					if (pbss_last->pbeacon_buf)
+						wlan_bcn_chunk_free(pmadapter,
+								    pbss_last->
+								    pbeacon_buf);
+					pbss_last->pbeacon_buf = MNULL;
 					wlan_ret_802_11_scan_store_beacon
 						(pmpriv,
 						 pmadapter->num_in_scan_table -
-						 1,
-						 pmadapter->num_in_scan_table,
-						 bss_new_entry);
-					if (bss_new_entry->pbeacon_buf == MNULL)
+						 1, bss_new_entry);
+					if (bss_new_entry->pbeacon_buf == MNULL) {
 						pmadapter->num_in_scan_table--;
-					else
-						memcpy(pmadapter,
-						       &pmadapter->
-						       pscan_table[pmadapter->
-								   num_in_scan_table
-								   - 1],
+					} else {
+						memcpy(pmadapter, pbss_last,
 						       bss_new_entry,
 						       sizeof(BSSDescriptor_t));
+						wlan_scan_hash_add(pmadapter,
+								   pmadapter->
+								   num_in_scan_table
+								   - 1);
+					}
 					pcb->moal_mfree(pmadapter->pmoal_handle,
 							(t_u8 *)bss_new_entry);
 				}
@@ -3212,9 +3359,8 @@ wlan_scan_process_results(IN mlan_private *pmpriv)
 /**
  *  @brief Delete a specific indexed entry from the scan table.
  *
- *  Delete the scan table entry indexed by table_idx.  Compact the remaining
- *    entries and adjust any buffering of beacon/probe response data
- *    if needed.
+ *  Delete the scan table entry indexed by table_idx.  Return its beacon
+ *    chunk to the beacon store and compact the remaining entries.
  *
  *  @param pmpriv       A pointer to mlan_private structure
  *  @param table_idx    Scan table entry index to delete from the table
@@ -3227,249 +3373,32 @@ static t_void
 wlan_scan_delete_table_entry(IN mlan_private *pmpriv, IN t_s32 table_idx)
 {
 	mlan_adapter *pmadapter = pmpriv->adapter;
-	t_u32 del_idx;
-	t_u32 beacon_buf_adj;
-	t_u8 *pbeacon_buf;
 
 	ENTER();
 
-	/*
-	 * Shift the saved beacon buffer data for the scan table back over the
-	 *   entry being removed.  Update the end of buffer pointer.  Save the
-	 *   deleted buffer allocation size for pointer adjustments for entries
-	 *   compacted after the deleted index.
-	 */
-	beacon_buf_adj = pmadapter->pscan_table[table_idx].beacon_buf_size_max;
-
 	PRINTM(MINFO,
 	       "Scan: Delete Entry %d, beacon buffer removal = %d bytes\n",
-	       table_idx, beacon_buf_adj);
+	       table_idx,
+	       pmadapter->pscan_table[table_idx].beacon_buf_size_max);
 
 	/* Check if the table entry had storage allocated for its beacon */
-	if (beacon_buf_adj) {
-		pbeacon_buf = pmadapter->pscan_table[table_idx].pbeacon_buf;
-
-		/*
-		 * Remove the entry's buffer space, decrement the table
-		 * end pointer by the amount we are removing
-		 */
-		pmadapter->pbcn_buf_end -= beacon_buf_adj;
-
-		PRINTM(MINFO,
-		       "Scan: Delete Entry %d, compact data: %p <- %p (sz = %d)\n",
-		       table_idx,
-		       pbeacon_buf,
-		       pbeacon_buf + beacon_buf_adj,
-		       pmadapter->pbcn_buf_end - pbeacon_buf);
-
-		/*
-		 * Compact data storage.  Copy all data after the deleted entry's
-		 *   end address (pbeacon_buf + beacon_buf_adj) back to the original
-		 *   start address (pbeacon_buf).
-		 *
-		 * Scan table entries affected by the move will have their entry
-		 *   pointer adjusted below.
-		 *
-		 * Use memmove since the dest/src memory regions overlap.
-		 */
-		memmove(pmadapter, pbeacon_buf,
-			(void *)((t_ptr)pbeacon_buf + (t_ptr)beacon_buf_adj),
-			(t_u32)((t_ptr)pmadapter->pbcn_buf_end -
-				(t_ptr)pbeacon_buf));
-	}
+	if (pmadapter->pscan_table[table_idx].pbeacon_buf)
+		wlan_bcn_chunk_free(pmadapter,
+				    pmadapter->pscan_table[table_idx].
+				    pbeacon_buf);
 
 	PRINTM(MINFO, "Scan: Delete Entry %d, num_in_scan_table = %d\n",
 	       table_idx, pmadapter->num_in_scan_table);
 
 	/*
 	 * Shift all of the entries after the table_idx back by one, compacting
-	 * the table and removing the requested entry
+	 * the table and removing the requested entry.  The beacon data stays
+	 * where it is, so no beacon or IE pointers need adjusting.
 	 */
-	for (del_idx = table_idx; (del_idx + 1) < pmadapter->num_in_scan_table;
-	     del_idx++) {
-		/* Copy the next entry over this one */
-		memcpy(pmadapter, pmadapter->pscan_table + del_idx,
-		       pmadapter->pscan_table + del_idx + 1,
-		       sizeof(BSSDescriptor_t));
-
-		/*
-		 * Adjust this entry's pointer to its beacon buffer based on the
-		 *   removed/compacted entry from the deleted index.  Don't decrement
-		 *   if the buffer pointer is MNULL (no data stored for this entry).
-		 */
-		if (pmadapter->pscan_table[del_idx].pbeacon_buf) {
-			pmadapter->pscan_table[del_idx].pbeacon_buf -=
-				beacon_buf_adj;
-			if (pmadapter->pscan_table[del_idx].pwpa_ie) {
-				pmadapter->pscan_table[del_idx].pwpa_ie =
-					(IEEEtypes_VendorSpecific_t *)
-					(pmadapter->pscan_table[del_idx].
-					 pbeacon_buf +
-					 pmadapter->pscan_table[del_idx].
-					 wpa_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].prsn_ie) {
-				pmadapter->pscan_table[del_idx].prsn_ie =
-					(IEEEtypes_Generic_t *)
-					(pmadapter->pscan_table[del_idx].
-					 pbeacon_buf +
-					 pmadapter->pscan_table[del_idx].
-					 rsn_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pwapi_ie) {
-				pmadapter->pscan_table[del_idx].pwapi_ie =
-					(IEEEtypes_Generic_t *)
-					(pmadapter->pscan_table[del_idx].
-					 pbeacon_buf +
-					 pmadapter->pscan_table[del_idx].
-					 wapi_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pmd_ie) {
-				pmadapter->pscan_table[del_idx].pmd_ie =
-					(IEEEtypes_MobilityDomain_t *)
-					(pmadapter->pscan_table[del_idx].
-					 pbeacon_buf +
-					 pmadapter->pscan_table[del_idx].
-					 md_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pht_cap) {
-				pmadapter->pscan_table[del_idx].pht_cap =
-					(IEEEtypes_HTCap_t *)(pmadapter->
-							      pscan_table
-							      [del_idx].
-							      pbeacon_buf +
-							      pmadapter->
-							      pscan_table
-							      [del_idx].
-							      ht_cap_offset);
-			}
-
-			if (pmadapter->pscan_table[del_idx].pht_info) {
-				pmadapter->pscan_table[del_idx].pht_info =
-					(IEEEtypes_HTInfo_t *)(pmadapter->
-							       pscan_table
-							       [del_idx].
-							       pbeacon_buf +
-							       pmadapter->
-							       pscan_table
-							       [del_idx].
-							       ht_info_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pbss_co_2040) {
-				pmadapter->pscan_table[del_idx].pbss_co_2040 =
-					(IEEEtypes_2040BSSCo_t *)(pmadapter->
-								  pscan_table
-								  [del_idx].
-								  pbeacon_buf +
-								  pmadapter->
-								  pscan_table
-								  [del_idx].
-								  bss_co_2040_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pext_cap) {
-				pmadapter->pscan_table[del_idx].pext_cap =
-					(IEEEtypes_ExtCap_t *)(pmadapter->
-							       pscan_table
-							       [del_idx].
-							       pbeacon_buf +
-							       pmadapter->
-							       pscan_table
-							       [del_idx].
-							       ext_cap_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].
-			    poverlap_bss_scan_param) {
-				pmadapter->pscan_table[del_idx].
-					poverlap_bss_scan_param =
-					(IEEEtypes_OverlapBSSScanParam_t
-					 *)(pmadapter->pscan_table[del_idx].
-					    pbeacon_buf +
-					    pmadapter->pscan_table[del_idx].
-					    overlap_bss_offset);
-			}
-
-			if (pmadapter->pscan_table[del_idx].pvht_cap) {
-				pmadapter->pscan_table[del_idx].pvht_cap =
-					(IEEEtypes_VHTCap_t *)(pmadapter->
-							       pscan_table
-							       [del_idx].
-							       pbeacon_buf +
-							       pmadapter->
-							       pscan_table
-							       [del_idx].
-							       vht_cap_offset);
-			}
-
-			if (pmadapter->pscan_table[del_idx].pvht_oprat) {
-				pmadapter->pscan_table[del_idx].pvht_oprat =
-					(IEEEtypes_VHTOprat_t *)(pmadapter->
-								 pscan_table
-								 [del_idx].
-								 pbeacon_buf +
-								 pmadapter->
-								 pscan_table
-								 [del_idx].
-								 vht_oprat_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pvht_txpower) {
-				pmadapter->pscan_table[del_idx].pvht_txpower =
-					(IEEEtypes_VHTtxpower_t *)(pmadapter->
-								   pscan_table
-								   [del_idx].
-								   pbeacon_buf +
-								   pmadapter->
-								   pscan_table
-								   [del_idx].
-								   vht_txpower_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pext_pwer) {
-				pmadapter->pscan_table[del_idx].pext_pwer =
-					(IEEEtypes_ExtPwerCons_t *)(pmadapter->
-								    pscan_table
-								    [del_idx].
-								    pbeacon_buf
-								    +
-								    pmadapter->
-								    pscan_table
-								    [del_idx].
-								    ext_pwer_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pext_bssload) {
-				pmadapter->pscan_table[del_idx].pext_bssload =
-					(IEEEtypes_ExtBSSload_t *)(pmadapter->
-								   pscan_table
-								   [del_idx].
-								   pbeacon_buf +
-								   pmadapter->
-								   pscan_table
-								   [del_idx].
-								   ext_bssload_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].pquiet_chan) {
-				pmadapter->pscan_table[del_idx].pquiet_chan =
-					(IEEEtypes_QuietChan_t *)(pmadapter->
-								  pscan_table
-								  [del_idx].
-								  pbeacon_buf +
-								  pmadapter->
-								  pscan_table
-								  [del_idx].
-								  quiet_chan_offset);
-			}
-			if (pmadapter->pscan_table[del_idx].poper_mode) {
-				pmadapter->pscan_table[del_idx].poper_mode =
-					(IEEEtypes_OperModeNtf_t *)(pmadapter->
-								    pscan_table
-								    [del_idx].
-								    pbeacon_buf
-								    +
-								    pmadapter->
-								    pscan_table
-								    [del_idx].
-								    oper_mode_offset);
-			}
-		}
-	}
+	memmove(pmadapter, pmadapter->pscan_table + table_idx,
+		pmadapter->pscan_table + table_idx + 1,
+		sizeof(BSSDescriptor_t) *
+		(pmadapter->num_in_scan_table - table_idx - 1));
 
 	/* The last entry is invalid now that it has been deleted or moved back */
 	memset(pmadapter,
@@ -3478,6 +3407,9 @@ wlan_scan_delete_table_entry(IN mlan_private *pmpriv, IN t_s32 table_idx)
 
 	pmadapter->num_in_scan_table--;
 
+	/* Entries after table_idx have moved, reindex them */
+	wlan_scan_hash_rebuild(pmadapter);
+
 	LEAVE();
 }
 
@@ -3827,6 +3759,122 @@ wlan_is_network_compatible(IN mlan_private *pmpriv,
 	return -1;
 }
 
+/**
+ *  @brief Rebuild the scan table hash index
+ *
+ *  Called whenever the scan table is cleared or compacted.
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *
+ *  @return             N/A
+ */
+t_void
+wlan_scan_hash_rebuild(IN pmlan_adapter pmadapter)
+{
+	t_s32 i;
+
+	memset(pmadapter, pmadapter->bssid_hash, 0xff,
+	       sizeof(pmadapter->bssid_hash));
+	memset(pmadapter, pmadapter->ssid_hash, 0xff,
+	       sizeof(pmadapter->ssid_hash));
+	/* Walk backwards so every insert lands at the head of its chain */
+	for (i = (t_s32)pmadapter->num_in_scan_table - 1; i >= 0; i--)
+		wlan_scan_hash_add(pmadapter, (t_u32)i);
+}
+
+/**
+ *  @brief Allocate the beacon store
+ *
+ *  The store is limited to max_beacon_buffer bytes, rounded up to whole
+ *    slabs.  All slabs are allocated up front if fixed_beacon_buffer is
+ *    set, otherwise only the first one and the rest on demand.
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *
+ *  @return             MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
+ */
+mlan_status
+wlan_bcn_store_init(IN pmlan_adapter pmadapter)
+{
+	pmlan_callbacks pcb = &pmadapter->callbacks;
+	t_u32 limit = pmadapter->max_beacon_buffer;
+	t_u8 num, i;
+	mlan_status ret = MLAN_STATUS_SUCCESS;
+
+	ENTER();
+
+	if (!limit)
+		limit = MAX_SCAN_BEACON_BUFFER;
+	limit = MIN(limit, BCN_SLAB_MAX * BCN_SLAB_SIZE);
+	pmadapter->bcn_slab_num =
+		(t_u8)MAX(1, (limit + BCN_SLAB_SIZE - 1) / BCN_SLAB_SIZE);
+	num = pmadapter->fixed_beacon_buffer ? pmadapter->bcn_slab_num : 1;
+	for (i = 0; i < num; i++) {
+		ret = pcb->moal_malloc(pmadapter->pmoal_handle, BCN_SLAB_SIZE,
+				       MLAN_MEM_DEF,
+				       &pmadapter->bcn_slabs[i].buf);
+		if (ret != MLAN_STATUS_SUCCESS || !pmadapter->bcn_slabs[i].buf) {
+			PRINTM(MERROR, "Failed to allocate bcn buf\n");
+			pmadapter->bcn_slabs[i].buf = MNULL;
+			wlan_bcn_store_free(pmadapter);
+			LEAVE();
+			return MLAN_STATUS_FAILURE;
+		}
+	}
+	PRINTM(MINFO, "Beacon store: %d of %d slabs allocated\n", num,
+	       pmadapter->bcn_slab_num);
+	wlan_bcn_store_reset(pmadapter);
+
+	LEAVE();
+	return ret;
+}
+
+/**
+ *  @brief Return every beacon chunk to the store
+ *
+ *  Called whenever the scan table is cleared.  Slabs stay allocated but
+ *    are no longer tied to a size class.
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *
+ *  @return             N/A
+ */
+t_void
+wlan_bcn_store_reset(IN pmlan_adapter pmadapter)
+{
+	t_u8 i;
+
+	for (i = 0; i < BCN_SLAB_MAX; i++) {
+		pmadapter->bcn_slabs[i].cls = BCN_SLAB_CLASS_NONE;
+		pmadapter->bcn_slabs[i].inuse = 0;
+	}
+	memset(pmadapter, pmadapter->bcn_free, 0, sizeof(pmadapter->bcn_free));
+	pmadapter->bcn_used = 0;
+}
+
+/**
+ *  @brief Free the beacon store
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *
+ *  @return             N/A
+ */
+t_void
+wlan_bcn_store_free(IN pmlan_adapter pmadapter)
+{
+	pmlan_callbacks pcb = &pmadapter->callbacks;
+	t_u8 i;
+
+	for (i = 0; i < BCN_SLAB_MAX; i++) {
+		if (pmadapter->bcn_slabs[i].buf) {
+			pcb->moal_mfree(pmadapter->pmoal_handle,
+					pmadapter->bcn_slabs[i].buf);
+			pmadapter->bcn_slabs[i].buf = MNULL;
+		}
+	}
+	wlan_bcn_store_reset(pmadapter);
+}
+
 /**
  *  @brief Internal function used to flush the scan list
  *
@@ -3845,9 +3893,9 @@ wlan_flush_scan_table(IN pmlan_adapter pmadapter)
 	memset(pmadapter, pmadapter->pscan_table, 0,
 	       (sizeof(BSSDescriptor_t) * MRVDRV_MAX_BSSID_LIST));
 	pmadapter->num_in_scan_table = 0;
+	wlan_scan_hash_rebuild(pmadapter);
 
-	memset(pmadapter, pmadapter->bcn_buf, 0, pmadapter->bcn_buf_size);
-	pmadapter->pbcn_buf_end = pmadapter->bcn_buf;
+	wlan_bcn_store_reset(pmadapter);
 
 	for (i = 0; i < pmadapter->num_in_chan_stats; i++)
 		pmadapter->pchan_stats[i].cca_scan_duration = 0;
@@ -3955,8 +4003,8 @@ wlan_scan_networks(IN mlan_private *pmpriv,
 		memset(pmadapter, pmadapter->pscan_table, 0x00,
 		       sizeof(BSSDescriptor_t) * MRVDRV_MAX_BSSID_LIST);
 		pmadapter->num_in_scan_table = 0;
-		pmadapter->pbcn_buf_end = pmadapter->bcn_buf;
-
+		wlan_scan_hash_rebuild(pmadapter);
+		wlan_bcn_store_reset(pmadapter);
 	}
 	for (i = 0; i < pmadapter->num_in_chan_stats; i++)
 		pmadapter->pchan_stats[i].cca_scan_duration = 0;
@@ -4266,12 +4314,14 @@ wlan_ret_802_11_scan(IN mlan_private *pmpriv,
 	t_u8 band;
 	t_u8 is_bgscan_resp;
 	t_u32 age_ts_usec;
-	t_u8 null_ssid[MLAN_MAX_SSID_LENGTH] = { 0 };
 	t_u32 status_code = 0;
 	pmlan_ioctl_req pscan_ioctl_req = MNULL;
+	t_u64 start_ns = 0, end_ns = 0;
+	t_u32 parse_us = 0;
 
 	ENTER();
 	pcb = (pmlan_callbacks)&pmadapter->callbacks;
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &start_ns);
 
 	is_bgscan_resp = (resp->command == HostCmd_CMD_802_11_BG_SCAN_QUERY);
 	if (is_bgscan_resp)
@@ -4413,53 +4463,9 @@ wlan_ret_802_11_scan(IN mlan_private *pmpriv,
 			/*
 			 * Search the scan table for the same bssid
 			 */
-			for (bss_idx = 0; bss_idx < num_in_table; bss_idx++) {
-				if (!memcmp
-				    (pmadapter, bss_new_entry->mac_address,
-				     pmadapter->pscan_table[bss_idx].
-				     mac_address,
-				     sizeof(bss_new_entry->mac_address))) {
-					/*
-					 * If the SSID matches as well, it is a
-					 * duplicate of this entry.  Keep the
-					 * bss_idx set to this entry so we
-					 * replace the old contents in the table
-					 */
-					if ((bss_new_entry->ssid.ssid_len ==
-					     pmadapter->pscan_table[bss_idx].
-					     ssid.ssid_len)
-					    &&
-					    (!memcmp
-					     (pmadapter,
-					      bss_new_entry->ssid.ssid,
-					      pmadapter->pscan_table[bss_idx].
-					      ssid.ssid,
-					      bss_new_entry->ssid.ssid_len))) {
-						PRINTM(MINFO,
-						       "SCAN_RESP: Duplicate of index: %d\n",
-						       bss_idx);
-
-						break;
-					}
-					/*
-					 * If the SSID is NULL for same BSSID
-					 * keep the bss_idx set to this entry
-					 * so we replace the old contents in
-					 * the table
-					 */
-					if (!memcmp
-					    (pmadapter,
-					     pmadapter->pscan_table[bss_idx].
-					     ssid.ssid, null_ssid,
-					     pmadapter->pscan_table[bss_idx].
-					     ssid.ssid_len)) {
-						PRINTM(MINFO,
-						       "SCAN_RESP: Duplicate of index: %d\n",
-						       bss_idx);
-						break;
-					}
-				}
-			}
+			bss_idx = wlan_scan_find_dup_entry(pmadapter,
+							   bss_new_entry,
+							   num_in_table);
 			/*
 			 * If the bss_idx is equal to the number of entries
 			 * in the table, the new entry was not a duplicate;
@@ -4483,7 +4489,6 @@ wlan_ret_802_11_scan(IN mlan_private *pmpriv,
 			 */
 			wlan_ret_802_11_scan_store_beacon(pmpriv,
 							  bss_idx,
-							  num_in_table,
 							  bss_new_entry);
 			if (bss_new_entry->pbeacon_buf == MNULL) {
 				PRINTM(MCMND,
@@ -4508,9 +4513,11 @@ wlan_ret_802_11_scan(IN mlan_private *pmpriv,
 			}
 
 			/* Copy the locally created bss_new_entry to the scan table */
+			wlan_scan_hash_del(pmadapter, bss_idx);
 			memcpy(pmadapter, &pmadapter->pscan_table[bss_idx],
 			       bss_new_entry,
 			       sizeof(pmadapter->pscan_table[bss_idx]));
+			wlan_scan_hash_add(pmadapter, bss_idx);
 
 		} else {
 			/* Error parsing/interpreting the scan response, skipped */
@@ -4523,6 +4530,13 @@ wlan_ret_802_11_scan(IN mlan_private *pmpriv,
 	       pscan_rsp->number_of_sets,
 	       num_in_table - pmadapter->num_in_scan_table, num_in_table);
 
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &end_ns);
+	if (end_ns > start_ns)
+		parse_us = (t_u32)pcb->moal_do_div(end_ns - start_ns, 1000);
+	PRINTM(MCMND,
+	       "SCAN_RESP: parsed %d APs in %u us, beacon store %d bytes\n",
+	       pscan_rsp->number_of_sets, parse_us, pmadapter->bcn_used);
+
 	/* Update the total number of BSSIDs in the scan table */
 	pmadapter->num_in_scan_table = num_in_table;
 	/* Update the age_in_second */
@@ -4790,10 +4804,12 @@ wlan_parse_ext_scan_result(IN mlan_private *pmpriv,
 	MrvlIEtypes_Bss_Scan_Info_t *pscan_info_tlv = MNULL;
 	t_u8 band;
 	t_u32 age_ts_usec;
-	t_u8 null_ssid[MLAN_MAX_SSID_LENGTH] = { 0 };
+	t_u64 start_ns = 0, end_ns = 0;
+	t_u32 parse_us = 0;
 
 	ENTER();
 	pcb = (pmlan_callbacks)&pmadapter->callbacks;
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &start_ns);
 
 	if (number_of_sets > MRVDRV_MAX_BSSID_LIST) {
 		PRINTM(MERROR,
@@ -4962,52 +4978,9 @@ wlan_parse_ext_scan_result(IN mlan_private *pmpriv,
 			/*
 			 * Search the scan table for the same bssid
 			 */
-			for (bss_idx = 0; bss_idx < num_in_table; bss_idx++) {
-				if (!memcmp
-				    (pmadapter, bss_new_entry->mac_address,
-				     pmadapter->pscan_table[bss_idx].
-				     mac_address,
-				     sizeof(bss_new_entry->mac_address))) {
-					/*
-					 * If the SSID matches as well, it is a
-					 * duplicate of this entry.  Keep the
-					 * bss_idx set to this entry so we
-					 * replace the old contents in the table
-					 */
-					if ((bss_new_entry->ssid.ssid_len ==
-					     pmadapter->pscan_table[bss_idx].
-					     ssid.ssid_len)
-					    &&
-					    (!memcmp
-					     (pmadapter,
-					      bss_new_entry->ssid.ssid,
-					      pmadapter->pscan_table[bss_idx].
-					      ssid.ssid,
-					      bss_new_entry->ssid.ssid_len))) {
-						PRINTM(MINFO,
-						       "EXT_SCAN: Duplicate of index: %d\n",
-						       bss_idx);
-						break;
-					}
-					/*
-					 * If the SSID is NULL for same BSSID
-					 * keep the bss_idx set to this entry
-					 * so we replace the old contents in
-					 * the table
-					 */
-					if (!memcmp
-					    (pmadapter,
-					     pmadapter->pscan_table[bss_idx].
-					     ssid.ssid, null_ssid,
-					     pmadapter->pscan_table[bss_idx].
-					     ssid.ssid_len)) {
-						PRINTM(MINFO,
-						       "EXT_SCAN: Duplicate of index: %d\n",
-						       bss_idx);
-						break;
-					}
-				}
-			}
+			bss_idx = wlan_scan_find_dup_entry(pmadapter,
+							   bss_new_entry,
+							   num_in_table);
 			/*
 			 * If the bss_idx is equal to the number of entries
 			 * in the table, the new entry was not a duplicate;
@@ -5028,7 +5001,6 @@ wlan_parse_ext_scan_result(IN mlan_private *pmpriv,
 			 */
 			wlan_ret_802_11_scan_store_beacon(pmpriv,
 							  bss_idx,
-							  num_in_table,
 							  bss_new_entry);
 			if (bss_new_entry->pbeacon_buf == MNULL) {
 				PRINTM(MCMND,
@@ -5038,9 +5010,11 @@ wlan_parse_ext_scan_result(IN mlan_private *pmpriv,
 			}
 
 			/* Copy the locally created bss_new_entry to the scan table */
+			wlan_scan_hash_del(pmadapter, bss_idx);
 			memcpy(pmadapter, &pmadapter->pscan_table[bss_idx],
 			       bss_new_entry,
 			       sizeof(pmadapter->pscan_table[bss_idx]));
+			wlan_scan_hash_add(pmadapter, bss_idx);
 		} else {
 			/* Error parsing/interpreting the scan response, skipped */
 			PRINTM(MERROR,
@@ -5052,6 +5026,13 @@ wlan_parse_ext_scan_result(IN mlan_private *pmpriv,
 	       number_of_sets, num_in_table - pmadapter->num_in_scan_table,
 	       num_in_table);
 
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &end_ns);
+	if (end_ns > start_ns)
+		parse_us = (t_u32)pcb->moal_do_div(end_ns - start_ns, 1000);
+	PRINTM(MCMND,
+	       "EXT_SCAN: parsed %d APs in %u us, beacon store %d bytes\n",
+	       number_of_sets, parse_us, pmadapter->bcn_used);
+
 	/* Update the total number of BSSIDs in the scan table */
 	pmadapter->num_in_scan_table = num_in_table;
 	/* Update the age_in_second */
@@ -5943,19 +5924,24 @@ wlan_find_ssid_in_list(IN mlan_private *pmpriv,
 	mlan_adapter *pmadapter = pmpriv->adapter;
 	t_s32 net = -1, j;
 	t_u8 best_rssi = 0;
-	t_u32 i;
+	t_s32 i;
 
 	ENTER();
 	PRINTM(MINFO, "Num of entries in scan table = %d\n",
 	       pmadapter->num_in_scan_table);
 
+	if (!ssid) {
+		LEAVE();
+		return -1;
+	}
+
 	/*
-	 * Loop through the table until the maximum is reached or until a match
+	 * Loop through the entries hashed with this SSID until a match
 	 *   is found based on the bssid field comparison
 	 */
-	for (i = 0;
-	     i < pmadapter->num_in_scan_table && (!bssid || (bssid && net < 0));
-	     i++) {
+	for (i = pmadapter->ssid_hash[wlan_scan_ssid_hash(ssid)];
+	     i >= 0 && (!bssid || (bssid && net < 0));
+	     i = pmadapter->ssid_hash_next[i]) {
 		if (!wlan_ssid_cmp
 		    (pmadapter, &pmadapter->pscan_table[i].ssid, ssid) &&
 		    (!bssid ||
@@ -6025,7 +6011,7 @@ wlan_find_bssid_in_list(IN mlan_private *pmpriv, IN t_u8 *bssid, IN t_u32 mode)
 {
 	mlan_adapter *pmadapter = pmpriv->adapter;
 	t_s32 net = -1;
-	t_u32 i;
+	t_s32 i;
 
 	ENTER();
 
@@ -6038,13 +6024,15 @@ wlan_find_bssid_in_list(IN mlan_private *pmpriv, IN t_u8 *bssid, IN t_u32 mode)
 	       pmadapter->num_in_scan_table);
 
 	/*
-	 * Look through the scan table for a compatible match. The ret return
-	 *   variable will be equal to the index in the scan table (greater
-	 *   than zero) if the network is compatible.  The loop will continue
-	 *   past a matched bssid that is not compatible in case there is an
-	 *   AP with multiple SSIDs assigned to the same BSSID
+	 * Look through the entries hashed with this BSSID for a compatible
+	 *   match. The ret return variable will be equal to the index in the
+	 *   scan table (greater than zero) if the network is compatible.
+	 *   The loop will continue past a matched bssid that is not
+	 *   compatible in case there is an AP with multiple SSIDs assigned
+	 *   to the same BSSID
 	 */
-	for (i = 0; net < 0 && i < pmadapter->num_in_scan_table; i++) {
+	for (i = pmadapter->bssid_hash[wlan_scan_bssid_hash(bssid)];
+	     net < 0 && i >= 0; i = pmadapter->bssid_hash_next[i]) {
 		if (!memcmp
 		    (pmadapter, pmadapter->pscan_table[i].mac_address, bssid,
 		     MLAN_MAC_ADDR_LENGTH)) {
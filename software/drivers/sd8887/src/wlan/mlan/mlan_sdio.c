@@ -36,6 +36,7 @@ Change log:
 #include "mlan_wmm.h"
 #include "mlan_11n.h"
 #include "mlan_sdio.h"
+#include "mlan_trace.h"
 
 /********************************************************
 		Local Variables
@@ -187,12 +188,12 @@ wlan_get_rd_port(mlan_adapter *pmadapter, t_u8 *pport)
 	t_u32 rd_bitmap = pmadapter->mp_rd_bitmap;
 	t_u8 max_ports = MAX_PORT;
 
-	ENTER();
+	HOT_ENTER();
 
-	PRINTM(MIF_D, "wlan_get_rd_port: mp_rd_bitmap=0x%08x\n", rd_bitmap);
+	HOT_PRINTM(MIF_D, "wlan_get_rd_port: mp_rd_bitmap=0x%08x\n", rd_bitmap);
 
 	if (!(rd_bitmap & (DATA_PORT_MASK))) {
-		LEAVE();
+		HOT_LEAVE();
 		return MLAN_STATUS_FAILURE;
 	}
 
@@ -206,13 +207,13 @@ wlan_get_rd_port(mlan_adapter *pmadapter, t_u8 *pport)
 			/* port 0 is not reserved for cmd port */
 			pmadapter->curr_rd_port = 0;
 	} else {
-		LEAVE();
+		HOT_LEAVE();
 		return MLAN_STATUS_FAILURE;
 	}
 
-	PRINTM(MIF_D, "port=%d mp_rd_bitmap=0x%08x -> 0x%08x\n",
-	       *pport, rd_bitmap, pmadapter->mp_rd_bitmap);
-	LEAVE();
+	HOT_PRINTM(MIF_D, "port=%d mp_rd_bitmap=0x%08x -> 0x%08x\n",
+		   *pport, rd_bitmap, pmadapter->mp_rd_bitmap);
+	HOT_LEAVE();
 	return MLAN_STATUS_SUCCESS;
 }
 
@@ -228,14 +229,14 @@ wlan_get_wr_port_data(mlan_adapter *pmadapter, t_u8 *pport)
 {
 	t_u32 wr_bitmap = pmadapter->mp_wr_bitmap;
 
-	ENTER();
+	HOT_ENTER();
 
-	PRINTM(MIF_D, "wlan_get_wr_port_data: mp_wr_bitmap=0x%08x\n",
-	       wr_bitmap);
+	HOT_PRINTM(MIF_D, "wlan_get_wr_port_data: mp_wr_bitmap=0x%08x\n",
+		   wr_bitmap);
 
 	if (!(wr_bitmap & pmadapter->mp_data_port_mask)) {
 		pmadapter->data_sent = MTRUE;
-		LEAVE();
+		HOT_LEAVE();
 		return MLAN_STATUS_RESOURCE;
 	}
 
@@ -247,16 +248,38 @@ wlan_get_wr_port_data(mlan_adapter *pmadapter, t_u8 *pport)
 			pmadapter->curr_wr_port = 0;
 	} else {
 		pmadapter->data_sent = MTRUE;
-		LEAVE();
+		HOT_LEAVE();
 		return MLAN_STATUS_RESOURCE;
 	}
 
-	PRINTM(MIF_D, "port=%d mp_wr_bitmap=0x%08x -> 0x%08x\n",
-	       *pport, wr_bitmap, pmadapter->mp_wr_bitmap);
-	LEAVE();
+	HOT_PRINTM(MIF_D, "port=%d mp_wr_bitmap=0x%08x -> 0x%08x\n",
+		   *pport, wr_bitmap, pmadapter->mp_wr_bitmap);
+	HOT_LEAVE();
 	return MLAN_STATUS_SUCCESS;
 }
 
+/**
+ *  @brief This function waits before the next FW download status poll
+ *
+ *  The helper is usually ready again within a few microseconds, so the
+ *  first polls are issued back to back and the delay only grows when the
+ *  card keeps us waiting.
+ *
+ *  @param pmadapter  A pointer to mlan_adapter structure
+ *  @param pdelay     A pointer to the current delay in us, updated for
+ *                    the next call
+ *  @return           Time waited in us
+ */
+static t_u32
+wlan_sdio_fw_dnld_backoff(mlan_adapter *pmadapter, t_u32 *pdelay)
+{
+	t_u32 delay = *pdelay;
+
+	wlan_udelay(pmadapter, delay);
+	*pdelay = MIN(delay << 1, FW_DNLD_POLL_MAX_DELAY);
+	return delay;
+}
+
 /**
  *  @brief This function polls the card status register.
  *
@@ -270,10 +293,12 @@ wlan_sdio_poll_card_status(mlan_adapter *pmadapter, t_u8 bits)
 	pmlan_callbacks pcb = &pmadapter->callbacks;
 	t_u32 tries;
 	t_u32 cs = 0;
+	t_u32 delay = FW_DNLD_POLL_MIN_DELAY;
+	t_u32 waited = 0;
 
 	ENTER();
 
-	for (tries = 0; tries < MAX_POLL_TRIES; tries++) {
+	for (tries = 0; waited < FW_DNLD_POLL_MAX_WAIT; tries++) {
 		if (pcb->moal_read_reg(pmadapter->pmoal_handle,
 				       CARD_TO_HOST_EVENT_REG,
 				       &cs) != MLAN_STATUS_SUCCESS)
@@ -282,7 +307,7 @@ wlan_sdio_poll_card_status(mlan_adapter *pmadapter, t_u8 bits)
 			LEAVE();
 			return MLAN_STATUS_SUCCESS;
 		}
-		wlan_udelay(pmadapter, 10);
+		waited += wlan_sdio_fw_dnld_backoff(pmadapter, &delay);
 	}
 
 	PRINTM(MERROR,
@@ -476,13 +501,19 @@ wlan_prog_fw_w_helper(IN pmlan_adapter pmadapter, t_u8 *fw, t_u32 fw_len)
 	t_u32 firmwarelen = fw_len;
 	t_u32 offset = 0;
 	t_u32 base0, base1;
-	t_void *tmpfwbuf = MNULL;
+	t_void *tmpfwbuf[2] = { MNULL, MNULL };
 	t_u32 tmpfwbufsz;
+	t_u8 *fwbuf_arr[2];
 	t_u8 *fwbuf;
+	t_u8 cur = 0;
+	t_u32 prep_offset = 0, prep_len = 0;
 	mlan_buffer mbuf;
 	t_u16 len = 0;
 	t_u32 txlen = 0, tx_blocks = 0, tries = 0;
 	t_u32 i = 0;
+	t_u32 delay, waited;
+	t_u64 start_ns = 0, end_ns = 0;
+	t_u32 dnld_us = 0;
 	t_u32 read_base_0_reg = READ_BASE_0_REG;
 	t_u32 read_base_1_reg = READ_BASE_1_REG;
 
@@ -497,18 +528,28 @@ wlan_prog_fw_w_helper(IN pmlan_adapter pmadapter, t_u8 *fw, t_u32 fw_len)
 
 	PRINTM(MINFO, "WLAN: Downloading FW image (%d bytes)\n", firmwarelen);
 
+	/* Two bounce buffers: the next block is copied into one while the
+	 * helper is still consuming the block sent from the other */
 	tmpfwbufsz = ALIGN_SZ(WLAN_UPLD_SIZE, DMA_ALIGNMENT);
-	ret = pcb->moal_malloc(pmadapter->pmoal_handle, tmpfwbufsz,
-			       MLAN_MEM_DEF | MLAN_MEM_DMA, (t_u8 **)&tmpfwbuf);
-	if ((ret != MLAN_STATUS_SUCCESS) || !tmpfwbuf) {
-		PRINTM(MERROR,
-		       "Unable to allocate buffer for firmware. Terminating download\n");
-		ret = MLAN_STATUS_FAILURE;
-		goto done;
+	for (cur = 0; cur < 2; cur++) {
+		ret = pcb->moal_malloc(pmadapter->pmoal_handle, tmpfwbufsz,
+				       MLAN_MEM_DEF | MLAN_MEM_DMA,
+				       (t_u8 **)&tmpfwbuf[cur]);
+		if ((ret != MLAN_STATUS_SUCCESS) || !tmpfwbuf[cur]) {
+			PRINTM(MERROR,
+			       "Unable to allocate buffer for firmware. Terminating download\n");
+			ret = MLAN_STATUS_FAILURE;
+			goto done;
+		}
+		memset(pmadapter, tmpfwbuf[cur], 0, tmpfwbufsz);
+		/* Ensure 8-byte aligned firmware buffer */
+		fwbuf_arr[cur] =
+			(t_u8 *)ALIGN_ADDR(tmpfwbuf[cur], DMA_ALIGNMENT);
 	}
-	memset(pmadapter, tmpfwbuf, 0, tmpfwbufsz);
-	/* Ensure 8-byte aligned firmware buffer */
-	fwbuf = (t_u8 *)ALIGN_ADDR(tmpfwbuf, DMA_ALIGNMENT);
+	cur = 0;
+	fwbuf = fwbuf_arr[cur];
+
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &start_ns);
 
 	/* Perform firmware data transfer */
 	do {
@@ -527,7 +568,9 @@ wlan_prog_fw_w_helper(IN pmlan_adapter pmadapter, t_u8 *fw, t_u32 fw_len)
 		if (firmwarelen && offset >= firmwarelen)
 			break;
 
-		for (tries = 0; tries < MAX_POLL_TRIES; tries++) {
+		delay = FW_DNLD_POLL_MIN_DELAY;
+		waited = 0;
+		for (tries = 0; waited < FW_DNLD_POLL_MAX_WAIT; tries++) {
 			ret = pcb->moal_read_reg(pmadapter->pmoal_handle,
 						 read_base_0_reg, &base0);
 			if (ret != MLAN_STATUS_SUCCESS) {
@@ -548,7 +591,7 @@ wlan_prog_fw_w_helper(IN pmlan_adapter pmadapter, t_u8 *fw, t_u32 fw_len)
 
 			if (len)
 				break;
-			wlan_udelay(pmadapter, 10);
+			waited += wlan_sdio_fw_dnld_backoff(pmadapter, &delay);
 		}
 
 		if (!len)
@@ -601,13 +644,28 @@ wlan_prog_fw_w_helper(IN pmlan_adapter pmadapter, t_u8 *fw, t_u32 fw_len)
 				(txlen + MLAN_SDIO_BLOCK_SIZE_FW_DNLD -
 				 1) / MLAN_SDIO_BLOCK_SIZE_FW_DNLD;
 
-			/* Copy payload to buffer */
-			if (firmware)
-				memmove(pmadapter, fwbuf, &firmware[offset],
-					txlen);
-			else
-				pcb->moal_get_fw_data(pmadapter->pmoal_handle,
-						      offset, txlen, fwbuf);
+			/* Keep the last block intact for a CRC resend and use
+			 * the other buffer, which normally already holds this
+			 * block */
+			cur ^= 1;
+			fwbuf = fwbuf_arr[cur];
+			if (prep_len != txlen || prep_offset != offset) {
+				/* Copy payload to buffer */
+				if (firmware)
+					memmove(pmadapter, fwbuf,
+						&firmware[offset], txlen);
+				else if (pcb->moal_get_fw_data(pmadapter->
+							       pmoal_handle,
+							       offset, txlen,
+							       fwbuf)) {
+					PRINTM(MFATAL,
+					       "WLAN: FW data read failure @ %d\n",
+					       offset);
+					ret = MLAN_STATUS_FAILURE;
+					goto done;
+				}
+			}
+			prep_len = 0;
 		}
 
 		/* Send data */
@@ -633,15 +691,40 @@ wlan_prog_fw_w_helper(IN pmlan_adapter pmadapter, t_u8 *fw, t_u32 fw_len)
 		}
 
 		offset += txlen;
+
+		/* Prepare the next block, assuming the helper asks for the same
+		 * length again, while the card handles the one just sent */
+		if (txlen && (!firmwarelen || offset < firmwarelen)) {
+			prep_offset = offset;
+			prep_len = txlen;
+			if (firmwarelen && firmwarelen - offset < prep_len)
+				prep_len = firmwarelen - offset;
+			if (firmware)
+				memmove(pmadapter, fwbuf_arr[cur ^ 1],
+					&firmware[offset], prep_len);
+			else if (pcb->moal_get_fw_data(pmadapter->pmoal_handle,
+						       offset, prep_len,
+						       fwbuf_arr[cur ^ 1]))
+				prep_len = 0;
+		}
 	} while (MTRUE);
 
-	PRINTM(MMSG, "Wlan: FW download over, firmwarelen=%d downloaded %d\n",
-	       firmwarelen, offset);
+	pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &end_ns);
+	if (end_ns > start_ns)
+		dnld_us = (t_u32)pcb->moal_do_div(end_ns - start_ns, 1000);
+	PRINTM(MMSG,
+	       "Wlan: FW download over, firmwarelen=%d downloaded %d in %u us (%u KB/s)\n",
+	       firmwarelen, offset, dnld_us,
+	       dnld_us ? (t_u32)pcb->moal_do_div((t_u64)offset * 1000,
+						 dnld_us) : 0);
 
 	ret = MLAN_STATUS_SUCCESS;
 done:
-	if (tmpfwbuf)
-		pcb->moal_mfree(pmadapter->pmoal_handle, (t_u8 *)tmpfwbuf);
+	for (cur = 0; cur < 2; cur++) {
+		if (tmpfwbuf[cur])
+			pcb->moal_mfree(pmadapter->pmoal_handle,
+					(t_u8 *)tmpfwbuf[cur]);
+	}
 
 	LEAVE();
 	return ret;
@@ -671,41 +754,25 @@ wlan_disable_host_int(pmlan_adapter pmadapter)
  *  @param pmadapter A pointer to mlan_adapter structure
  *  @param pmbuf      A pointer to the SDIO data/cmd buffer
  *  @param upld_typ  Type of rx packet
- *  @param lock_flag  flag for spin_lock.
  *  @return          MLAN_STATUS_SUCCESS
  */
 static mlan_status
 wlan_decode_rx_packet(mlan_adapter *pmadapter, mlan_buffer *pmbuf,
-		      t_u32 upld_typ, t_u8 lock_flag)
+		      t_u32 upld_typ)
 {
 	t_u8 *cmd_buf;
 	t_u32 event;
 
-	ENTER();
+	HOT_ENTER();
 
+	MTRACE(MTRACE_RX_UPLD, upld_typ, pmadapter->upld_len, 0);
 	switch (upld_typ) {
 	case MLAN_TYPE_SPA_DATA:
-		PRINTM(MINFO, "--- Rx: SPA Data packet ---\n");
+		HOT_PRINTM(MINFO, "--- Rx: SPA Data packet ---\n");
 		pmbuf->data_len = pmadapter->upld_len;
 		if (pmadapter->rx_work_flag) {
 			pmbuf->buf_type = MLAN_BUF_TYPE_SPA_DATA;
-			if (lock_flag)
-				pmadapter->callbacks.moal_spin_lock(pmadapter->
-								    pmoal_handle,
-								    pmadapter->
-								    rx_data_queue.
-								    plock);
-			util_enqueue_list_tail(pmadapter->pmoal_handle,
-					       &pmadapter->rx_data_queue,
-					       (pmlan_linked_list)pmbuf, MNULL,
-					       MNULL);
-			pmadapter->rx_pkts_queued++;
-			if (lock_flag)
-				pmadapter->callbacks.
-					moal_spin_unlock(pmadapter->
-							 pmoal_handle,
-							 pmadapter->
-							 rx_data_queue.plock);
+			wlan_rx_ring_put(pmadapter, pmbuf);
 		} else {
 			wlan_decode_spa_buffer(pmadapter,
 					       pmbuf->pbuf + pmbuf->data_offset,
@@ -715,7 +782,7 @@ wlan_decode_rx_packet(mlan_adapter *pmadapter, mlan_buffer *pmbuf,
 		pmadapter->data_received = MTRUE;
 		break;
 	case MLAN_TYPE_DATA:
-		PRINTM(MINFO, "--- Rx: Data packet ---\n");
+		HOT_PRINTM(MINFO, "--- Rx: Data packet ---\n");
 		if (pmadapter->upld_len > pmbuf->data_len) {
 			PRINTM(MERROR,
 			       "SDIO: Drop packet upld_len=%d data_len=%d \n",
@@ -726,23 +793,7 @@ wlan_decode_rx_packet(mlan_adapter *pmadapter, mlan_buffer *pmbuf,
 		pmbuf->data_len = (pmadapter->upld_len - INTF_HEADER_LEN);
 		pmbuf->data_offset += INTF_HEADER_LEN;
 		if (pmadapter->rx_work_flag) {
-			if (lock_flag)
-				pmadapter->callbacks.moal_spin_lock(pmadapter->
-								    pmoal_handle,
-								    pmadapter->
-								    rx_data_queue.
-								    plock);
-			util_enqueue_list_tail(pmadapter->pmoal_handle,
-					       &pmadapter->rx_data_queue,
-					       (pmlan_linked_list)pmbuf, MNULL,
-					       MNULL);
-			pmadapter->rx_pkts_queued++;
-			if (lock_flag)
-				pmadapter->callbacks.
-					moal_spin_unlock(pmadapter->
-							 pmoal_handle,
-							 pmadapter->
-							 rx_data_queue.plock);
+			wlan_rx_ring_put(pmadapter, pmbuf);
 		} else {
 			wlan_handle_rx_packet(pmadapter, pmbuf);
 		}
@@ -750,7 +801,7 @@ wlan_decode_rx_packet(mlan_adapter *pmadapter, mlan_buffer *pmbuf,
 		break;
 
 	case MLAN_TYPE_CMD:
-		PRINTM(MINFO, "--- Rx: Cmd Response ---\n");
+		HOT_PRINTM(MINFO, "--- Rx: Cmd Response ---\n");
 		/* take care of curr_cmd = NULL case */
 		if (!pmadapter->curr_cmd) {
 			cmd_buf = pmadapter->upld_buf;
@@ -788,7 +839,7 @@ wlan_decode_rx_packet(mlan_adapter *pmadapter, mlan_buffer *pmbuf,
 		break;
 
 	case MLAN_TYPE_EVENT:
-		PRINTM(MINFO, "--- Rx: Event ---\n");
+		HOT_PRINTM(MINFO, "--- Rx: Event ---\n");
 		event = *(t_u32 *)&pmbuf->pbuf[pmbuf->data_offset +
 					       INTF_HEADER_LEN];
 		pmadapter->event_cause = wlan_le32_to_cpu(event);
@@ -817,7 +868,7 @@ wlan_decode_rx_packet(mlan_adapter *pmadapter, mlan_buffer *pmbuf,
 		break;
 	}
 
-	LEAVE();
+	HOT_LEAVE();
 	return MLAN_STATUS_SUCCESS;
 }
 
@@ -859,7 +910,7 @@ wlan_receive_single_packet(mlan_adapter *pmadapter)
 		goto done;
 	}
 	pmadapter->mpa_rx_count[0]++;
-	wlan_decode_rx_packet(pmadapter, pmbuf, pkt_type, MTRUE);
+	wlan_decode_rx_packet(pmadapter, pmbuf, pkt_type);
 done:
 	if (ret != MLAN_STATUS_SUCCESS)
 		wlan_free_mlan_buffer(pmadapter, pmbuf);
@@ -868,6 +919,71 @@ done:
 	return ret;
 }
 
+/**
+ *  @brief This function tunes the MP-A RX packet and buffer limits from
+ *         the aggregation histogram and the measured CMD53 read time
+ *
+ *  Called once per aggregated read. Every MPA_RX_ADAPT_WINDOW reads the
+ *  buffer limit is sized to what the bus moves in MPA_RX_ADAPT_LAT_TARGET_US
+ *  and the packet limit follows how full the aggregates were.
+ *
+ *  @param pmadapter A pointer to mlan_adapter structure
+ *  @param lat_ns    Time spent in this CMD53 read, in ns
+ *  @return          N/A
+ */
+static t_void
+wlan_sdio_mpa_rx_adapt(mlan_adapter *pmadapter, t_u64 lat_ns)
+{
+	sdio_mpa_rx *mpa_rx = &pmadapter->mpa_rx;
+	t_u32 delta, rd = 0, pkts = 0, full = 0;
+	t_u32 lat_us, rate, limit, i;
+
+	mpa_rx->win_bytes += mpa_rx->buf_len;
+	mpa_rx->win_lat_ns += lat_ns;
+	if (++mpa_rx->win_cnt < MPA_RX_ADAPT_WINDOW)
+		return;
+
+	for (i = 0; i < SDIO_MP_AGGR_DEF_PKT_LIMIT; i++) {
+		delta = pmadapter->mpa_rx_count[i];
+		/* histogram may have been cleared through the debug proc */
+		if (delta >= mpa_rx->hist_snap[i])
+			delta -= mpa_rx->hist_snap[i];
+		mpa_rx->hist_snap[i] = pmadapter->mpa_rx_count[i];
+		rd += delta;
+		pkts += delta * (i + 1);
+		if (i == mpa_rx->pkt_aggr_limit - 1)
+			full = delta;
+	}
+
+	/* ns >> 10 is close enough to us and avoids a 64-bit divide */
+	lat_us = (t_u32)(mpa_rx->win_lat_ns >> 10);
+	mpa_rx->avg_lat_us = lat_us >> MPA_RX_ADAPT_WINDOW_SHIFT;
+	rate = mpa_rx->win_bytes / MAX(lat_us, 1);
+
+	limit = rate * MPA_RX_ADAPT_LAT_TARGET_US;
+	if (limit < MPA_RX_ADAPT_MIN_BUF)
+		limit = MPA_RX_ADAPT_MIN_BUF;
+	if (limit > mpa_rx->buf_size)
+		limit = mpa_rx->buf_size;
+	mpa_rx->buf_limit = ALIGN_SZ(limit + 1, MLAN_SDIO_BLOCK_SIZE)
+		- MLAN_SDIO_BLOCK_SIZE;
+
+	limit = mpa_rx->pkt_aggr_limit;
+	if (rd && full * 2 >= rd)
+		limit = MIN(limit * 2, mpa_rx->max_aggr_limit);
+	else if (rd && pkts * 4 <= rd * limit)
+		limit = MAX(limit / 2, MPA_RX_ADAPT_MIN_PKT_LIMIT);
+	mpa_rx->pkt_aggr_limit = MIN(limit, mpa_rx->max_aggr_limit);
+
+	PRINTM(MINFO,
+	       "MPA RX adapt: rd=%d pkts=%d full=%d lat=%dus pkt_limit=%d buf_limit=%d\n",
+	       rd, pkts, full, mpa_rx->avg_lat_us, mpa_rx->pkt_aggr_limit,
+	       mpa_rx->buf_limit);
+	mpa_rx->win_cnt = 0;
+	mpa_rx->win_bytes = 0;
+	mpa_rx->win_lat_ns = 0;
+}
+
 /**
  *  @brief This function receives data from the card in aggregate mode.
  *
@@ -887,6 +1003,7 @@ wlan_receive_mp_aggr_buf(mlan_adapter *pmadapter)
 	t_u32 cmd53_port = 0;
 	t_u32 i = 0;
 	t_u32 port_count = 0;
+	t_u64 start_ns = 0, end_ns = 0;
 
 	/* do aggr RX now */
 	PRINTM(MINFO, "do_rx_aggr: num of packets: %d\n",
@@ -916,6 +1033,8 @@ wlan_receive_mp_aggr_buf(mlan_adapter *pmadapter)
 	cmd53_port =
 		(pmadapter->ioport | SDIO_MPA_ADDR_BASE | (port_count << 8))
 		+ pmadapter->mpa_rx.start_port;
+	if (pmadapter->mpa_rx_adapt)
+		pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &start_ns);
 	do {
 		ret = pcb->moal_read_data_sync(pmadapter->pmoal_handle,
 					       &mbuf_aggr, cmd53_port, 0);
@@ -936,6 +1055,8 @@ wlan_receive_mp_aggr_buf(mlan_adapter *pmadapter)
 			}
 		}
 	} while (ret == MLAN_STATUS_FAILURE);
+	if (pmadapter->mpa_rx_adapt)
+		pcb->moal_get_boot_ktime(pmadapter->pmoal_handle, &end_ns);
 	if (!pmadapter->mpa_rx.buf && pmadapter->mpa_rx.pkt_cnt > 1) {
 		for (pind = 0; pind < pmadapter->mpa_rx.pkt_cnt; pind++) {
 			mbuf_deaggr = pmadapter->mpa_rx.mbuf_arr[pind];
@@ -949,8 +1070,7 @@ wlan_receive_mp_aggr_buf(mlan_adapter *pmadapter)
 						  mbuf_deaggr->data_offset +
 						  2));
 			pmadapter->upld_len = pkt_len;
-			wlan_decode_rx_packet(pmadapter, mbuf_deaggr, pkt_type,
-					      MTRUE);
+			wlan_decode_rx_packet(pmadapter, mbuf_deaggr, pkt_type);
 		}
 	} else {
 		DBG_HEXDUMP(MIF_D, "SDIO MP-A Blk Rd", pmadapter->mpa_rx.buf,
@@ -979,7 +1099,7 @@ wlan_receive_mp_aggr_buf(mlan_adapter *pmadapter)
 				pmadapter->upld_len = pkt_len;
 				/* Process de-aggr packet */
 				wlan_decode_rx_packet(pmadapter, mbuf_deaggr,
-						      pkt_type, MTRUE);
+						      pkt_type);
 			} else {
 				PRINTM(MERROR,
 				       "Wrong aggr packet: type=%d, len=%d, max_len=%d\n",
@@ -991,6 +1111,8 @@ wlan_receive_mp_aggr_buf(mlan_adapter *pmadapter)
 		}
 	}
 	pmadapter->mpa_rx_count[pmadapter->mpa_rx.pkt_cnt - 1]++;
+	if (pmadapter->mpa_rx_adapt)
+		wlan_sdio_mpa_rx_adapt(pmadapter, end_ns - start_ns);
 	MP_RX_AGGR_BUF_RESET(pmadapter);
 done:
 	return ret;
@@ -1017,11 +1139,11 @@ wlan_sdio_card_to_host_mp_aggr(mlan_adapter *pmadapter, mlan_buffer
 	t_u32 pind = 0;
 	t_u32 pkt_type = 0;
 
-	ENTER();
+	HOT_ENTER();
 
 	if (!pmadapter->mpa_rx.enabled) {
-		PRINTM(MINFO,
-		       "card_2_host_mp_aggr: rx aggregation disabled !\n");
+		HOT_PRINTM(MINFO,
+			   "card_2_host_mp_aggr: rx aggregation disabled !\n");
 
 		f_do_rx_cur = 1;
 		goto rx_curr_single;
@@ -1029,7 +1151,7 @@ wlan_sdio_card_to_host_mp_aggr(mlan_adapter *pmadapter, mlan_buffer
 
 	if (pmadapter->mp_rd_bitmap & DATA_PORT_MASK) {
 		/* Some more data RX pending */
-		PRINTM(MINFO, "card_2_host_mp_aggr: Not last packet\n");
+		HOT_PRINTM(MINFO, "card_2_host_mp_aggr: Not last packet\n");
 
 		if (MP_RX_AGGR_IN_PROGRESS(pmadapter)) {
 			if (MP_RX_AGGR_BUF_HAS_ROOM(pmadapter, rx_len)) {
@@ -1046,7 +1168,7 @@ wlan_sdio_card_to_host_mp_aggr(mlan_adapter *pmadapter, mlan_buffer
 
 	} else {
 		/* No more data RX pending */
-		PRINTM(MINFO, "card_2_host_mp_aggr: Last packet\n");
+		HOT_PRINTM(MINFO, "card_2_host_mp_aggr: Last packet\n");
 
 		if (MP_RX_AGGR_IN_PROGRESS(pmadapter)) {
 			f_do_rx_aggr = 1;
@@ -1063,15 +1185,15 @@ wlan_sdio_card_to_host_mp_aggr(mlan_adapter *pmadapter, mlan_buffer
 	}
 
 	if (f_aggr_cur) {
-		PRINTM(MINFO, "Current packet aggregation.\n");
+		HOT_PRINTM(MINFO, "Current packet aggregation.\n");
 		/* Curr pkt can be aggregated */
 		MP_RX_AGGR_SETUP(pmadapter, pmbuf, port, rx_len);
 
 		if (MP_RX_AGGR_PKT_LIMIT_REACHED(pmadapter) ||
 		    MP_RX_AGGR_PORT_LIMIT_REACHED(pmadapter)
 			) {
-			PRINTM(MINFO,
-			       "card_2_host_mp_aggr: Aggregation Packet limit reached\n");
+			HOT_PRINTM(MINFO,
+				   "card_2_host_mp_aggr: Aggregation Packet limit reached\n");
 			/* No more pkts allowed in Aggr buf, rx it */
 			f_do_rx_aggr = 1;
 		}
@@ -1086,8 +1208,9 @@ wlan_sdio_card_to_host_mp_aggr(mlan_adapter *pmadapter, mlan_buffer
 	}
 rx_curr_single:
 	if (f_do_rx_cur) {
-		PRINTM(MINFO, "RX: f_do_rx_cur: port: %d rx_len: %d\n", port,
-		       rx_len);
+		HOT_PRINTM(MINFO,
+			   "RX: f_do_rx_cur: port: %d rx_len: %d\n", port,
+			   rx_len);
 
 		if (MLAN_STATUS_SUCCESS !=
 		    wlan_sdio_card_to_host(pmadapter, &pkt_type,
@@ -1108,10 +1231,10 @@ rx_curr_single:
 
 		pmadapter->mpa_rx_count[0]++;
 
-		wlan_decode_rx_packet(pmadapter, pmbuf, pkt_type, MTRUE);
+		wlan_decode_rx_packet(pmadapter, pmbuf, pkt_type);
 	}
 	if (f_post_aggr_cur) {
-		PRINTM(MINFO, "Current packet aggregation.\n");
+		HOT_PRINTM(MINFO, "Current packet aggregation.\n");
 		/* Curr pkt can be aggregated */
 		MP_RX_AGGR_SETUP(pmadapter, pmbuf, port, rx_len);
 	}
@@ -1134,13 +1257,53 @@ done:
 		}
 	}
 
-	LEAVE();
+	HOT_LEAVE();
 	return ret;
 
 }
 #endif
 
 #ifdef SDIO_MULTI_PORT_TX_AGGR
+/**
+ *  @brief This function writes packets to the card in TX SG mode
+ *
+ *  The packets are linked into one CMD53 as they are. A packet whose
+ *  length is not block aligned is followed by a pad buffer pointing
+ *  at the zeroed pad block, so its own tail is never read or copied.
+ *
+ *  @param pmadapter A pointer to mlan_adapter structure
+ *  @param mbuf_arr  A pointer to the array of packets
+ *  @param pkt_cnt   Number of packets in mbuf_arr
+ *  @param port      CMD53 port
+ *  @return          MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
+ */
+static mlan_status
+wlan_write_data_sg(mlan_adapter *pmadapter, mlan_buffer **mbuf_arr,
+		   t_u32 pkt_cnt, t_u32 port)
+{
+	mlan_buffer mbuf_aggr;
+	mlan_buffer *pad;
+	t_u32 blk_len;
+	t_u32 i;
+
+	if (pkt_cnt == 1 && MP_TX_BLK_LEN(mbuf_arr[0]) == mbuf_arr[0]->data_len)
+		return wlan_write_data_sync(pmadapter, mbuf_arr[0], port);
+
+	memset(pmadapter, &mbuf_aggr, 0, sizeof(mlan_buffer));
+	mbuf_aggr.pnext = mbuf_aggr.pprev = &mbuf_aggr;
+	for (i = 0; i < pkt_cnt; i++) {
+		blk_len = MP_TX_BLK_LEN(mbuf_arr[i]);
+		wlan_link_buf_to_aggr(&mbuf_aggr, mbuf_arr[i]);
+		mbuf_aggr.data_len += blk_len;
+		if (blk_len == mbuf_arr[i]->data_len)
+			continue;
+		pad = &pmadapter->mpa_tx.pad_buf[i];
+		pad->data_len = blk_len - mbuf_arr[i]->data_len;
+		wlan_link_buf_to_aggr(&mbuf_aggr, pad);
+	}
+	return wlan_write_data_sync(pmadapter, &mbuf_aggr, port);
+}
+
 /**
  *  @brief This function sends aggr buf
  *
@@ -1169,17 +1332,8 @@ wlan_send_mp_aggr_buf(mlan_adapter *pmadapter)
 
 	memset(pmadapter, &mbuf_aggr, 0, sizeof(mlan_buffer));
 
-	if (!pmadapter->mpa_tx.buf && pmadapter->mpa_tx.pkt_cnt > 1) {
-		mbuf_aggr.data_len = pmadapter->mpa_tx.buf_len;
-		mbuf_aggr.pnext = mbuf_aggr.pprev = &mbuf_aggr;
-		mbuf_aggr.use_count = 0;
-		for (i = 0; i < pmadapter->mpa_tx.pkt_cnt; i++)
-			wlan_link_buf_to_aggr(&mbuf_aggr,
-					      pmadapter->mpa_tx.mbuf_arr[i]);
-	} else {
-		mbuf_aggr.pbuf = (t_u8 *)pmadapter->mpa_tx.buf;
-		mbuf_aggr.data_len = pmadapter->mpa_tx.buf_len;
-	}
+	mbuf_aggr.pbuf = (t_u8 *)pmadapter->mpa_tx.buf;
+	mbuf_aggr.data_len = pmadapter->mpa_tx.buf_len;
 
 	port_count = bitcount(pmadapter->mpa_tx.ports) - 1;
 	cmd53_port =
@@ -1188,11 +1342,9 @@ wlan_send_mp_aggr_buf(mlan_adapter *pmadapter)
 
 	if (pmadapter->mpa_tx.pkt_cnt == 1)
 		cmd53_port = pmadapter->ioport + pmadapter->mpa_tx.start_port;
-    /** only one packet */
-	if (!pmadapter->mpa_tx.buf && pmadapter->mpa_tx.pkt_cnt == 1)
-		ret = wlan_write_data_sync(pmadapter,
-					   pmadapter->mpa_tx.mbuf_arr[0],
-					   cmd53_port);
+	if (!pmadapter->mpa_tx.buf)
+		ret = wlan_write_data_sg(pmadapter, pmadapter->mpa_tx.mbuf_arr,
+					 pmadapter->mpa_tx.pkt_cnt, cmd53_port);
 	else
 		ret = wlan_write_data_sync(pmadapter, &mbuf_aggr, cmd53_port);
 	if (!pmadapter->mpa_tx.buf) {
@@ -1228,6 +1380,24 @@ wlan_send_mp_aggr_buf(mlan_adapter *pmadapter)
 	return ret;
 }
 
+/**
+ *  @brief This function sizes the block padding fragment of a
+ *         scatter-gather buffer to match its block aligned data_len
+ *
+ *  @param pmbuf     A pointer to the scatter-gather mlan_buffer
+ *
+ *  @return          N/A
+ */
+static t_void
+wlan_sdio_pad_sg_buf(mlan_buffer *pmbuf)
+{
+	amsdu_sg_arena *arena = (amsdu_sg_arena *)pmbuf->pfrag;
+	t_u32 pad = pmbuf->data_len - arena->body_len;
+
+	arena->frag[arena->body_frags].len = pad;
+	pmbuf->frag_cnt = arena->body_frags + (pad ? 1 : 0);
+}
+
 /**
  *  @brief This function sends data to the card in SDIO aggregated mode.
  *
@@ -1249,25 +1419,27 @@ wlan_host_to_card_mp_aggr(mlan_adapter *pmadapter, mlan_buffer *mbuf, t_u8 port,
 	t_u8 aggr_sg = 0;
 	t_u8 mp_aggr_pkt_limit = SDIO_MP_AGGR_DEF_PKT_LIMIT;
 
-	ENTER();
+	HOT_ENTER();
 
-	PRINTM(MIF_D, "host_2_card_mp_aggr: next_pkt_len: %d curr_port:%d\n",
-	       next_pkt_len, port);
+	HOT_PRINTM(MIF_D,
+		   "host_2_card_mp_aggr: next_pkt_len: %d curr_port:%d\n",
+		   next_pkt_len, port);
 
 	if (!pmadapter->mpa_tx.enabled) {
-		PRINTM(MINFO,
-		       "host_2_card_mp_aggr: tx aggregation disabled !\n");
+		HOT_PRINTM(MINFO,
+			   "host_2_card_mp_aggr: tx aggregation disabled !\n");
 		f_send_cur_buf = 1;
 		goto tx_curr_single;
 	}
 
 	if (next_pkt_len) {
 		/* More pkt in TX queue */
-		PRINTM(MINFO, "host_2_card_mp_aggr: More packets in Queue.\n");
+		HOT_PRINTM(MINFO,
+			   "host_2_card_mp_aggr: More packets in Queue.\n");
 
 		if (MP_TX_AGGR_IN_PROGRESS(pmadapter)) {
 			if (MP_TX_AGGR_BUF_HAS_ROOM
-			    (pmadapter, mbuf, mbuf->data_len)) {
+			    (pmadapter, mbuf, MP_TX_BLK_LEN(mbuf))) {
 				f_precopy_cur_buf = 1;
 
 				if (!
@@ -1275,8 +1447,8 @@ wlan_host_to_card_mp_aggr(mlan_adapter *pmadapter, mlan_buffer *mbuf, t_u8 port,
 				     mp_wr_bitmap & (1 << pmadapter->
 						     curr_wr_port)) ||
 				    !MP_TX_AGGR_BUF_HAS_ROOM(pmadapter, mbuf,
-							     mbuf->data_len +
-							     next_pkt_len)) {
+							     MP_TX_BLK_LEN(mbuf)
+							     + next_pkt_len)) {
 					f_send_aggr_buf = 1;
 				}
 			} else {
@@ -1294,7 +1466,7 @@ wlan_host_to_card_mp_aggr(mlan_adapter *pmadapter, mlan_buffer *mbuf, t_u8 port,
 			}
 		} else {
 			if (MP_TX_AGGR_BUF_HAS_ROOM
-			    (pmadapter, mbuf, mbuf->data_len) &&
+			    (pmadapter, mbuf, MP_TX_BLK_LEN(mbuf)) &&
 			    (pmadapter->
 			     mp_wr_bitmap & (1 << pmadapter->curr_wr_port)))
 				f_precopy_cur_buf = 1;
@@ -1303,15 +1475,15 @@ wlan_host_to_card_mp_aggr(mlan_adapter *pmadapter, mlan_buffer *mbuf, t_u8 port,
 		}
 	} else {
 		/* Last pkt in TX queue */
-		PRINTM(MINFO,
-		       "host_2_card_mp_aggr: Last packet in Tx Queue.\n");
+		HOT_PRINTM(MINFO,
+			   "host_2_card_mp_aggr: Last packet in Tx Queue.\n");
 
 		if (MP_TX_AGGR_IN_PROGRESS(pmadapter)) {
 			/* some packs in Aggr buf already */
 			f_send_aggr_buf = 1;
 
 			if (MP_TX_AGGR_BUF_HAS_ROOM
-			    (pmadapter, mbuf, mbuf->data_len)) {
+			    (pmadapter, mbuf, MP_TX_BLK_LEN(mbuf))) {
 				f_precopy_cur_buf = 1;
 			} else {
 				/* No room in Aggr buf, send it */
@@ -1324,7 +1496,8 @@ wlan_host_to_card_mp_aggr(mlan_adapter *pmadapter, mlan_buffer *mbuf, t_u8 port,
 	}
 
 	if (f_precopy_cur_buf) {
-		PRINTM(MINFO, "host_2_card_mp_aggr: Precopy current buffer\n");
+		HOT_PRINTM(MINFO,
+			   "host_2_card_mp_aggr: Precopy current buffer\n");
 		if (pmadapter->mpa_buf)
 			memcpy(pmadapter, pmadapter->mpa_buf +
 			       (pmadapter->last_mp_index * mp_aggr_pkt_limit +
@@ -1342,8 +1515,8 @@ wlan_host_to_card_mp_aggr(mlan_adapter *pmadapter, mlan_buffer *mbuf, t_u8 port,
 		if (MP_TX_AGGR_PKT_LIMIT_REACHED(pmadapter) ||
 		    MP_TX_AGGR_PORT_LIMIT_REACHED(pmadapter)
 			) {
-			PRINTM(MIF_D,
-			       "host_2_card_mp_aggr: Aggregation Pkt limit reached\n");
+			HOT_PRINTM(MIF_D,
+				   "host_2_card_mp_aggr: Aggregation Pkt limit reached\n");
 			/* No more pkts allowed in Aggr buf, send it */
 			f_send_aggr_buf = 1;
 		}
@@ -1354,10 +1527,14 @@ wlan_host_to_card_mp_aggr(mlan_adapter *pmadapter, mlan_buffer *mbuf, t_u8 port,
 
 tx_curr_single:
 	if (f_send_cur_buf) {
-		PRINTM(MINFO, "host_2_card_mp_aggr: writing to port #%d\n",
-		       port);
-		ret = wlan_write_data_sync(pmadapter, mbuf,
-					   pmadapter->ioport + port);
+		HOT_PRINTM(MINFO, "host_2_card_mp_aggr: writing to port #%d\n",
+			   port);
+		if (!pmadapter->mpa_tx.buf)
+			ret = wlan_write_data_sg(pmadapter, &mbuf, 1,
+						 pmadapter->ioport + port);
+		else
+			ret = wlan_write_data_sync(pmadapter, mbuf,
+						   pmadapter->ioport + port);
 		if (!(pmadapter->mp_wr_bitmap & (1 << pmadapter->curr_wr_port)))
 			pmadapter->mpa_sent_no_ports++;
 		pmadapter->last_mp_wr_bitmap[pmadapter->last_mp_index] =
@@ -1365,7 +1542,7 @@ tx_curr_single:
 		pmadapter->last_mp_wr_ports[pmadapter->last_mp_index] =
 			pmadapter->ioport + port;
 		pmadapter->last_mp_wr_len[pmadapter->last_mp_index] =
-			mbuf->data_len;
+			MP_TX_BLK_LEN(mbuf);
 		memset(pmadapter,
 		       (t_u8 *)&pmadapter->last_mp_wr_info[pmadapter->
 							   last_mp_index *
@@ -1389,7 +1566,8 @@ tx_curr_single:
 		pmadapter->mpa_tx_count[0]++;
 	}
 	if (f_postcopy_cur_buf) {
-		PRINTM(MINFO, "host_2_card_mp_aggr: Postcopy current buffer\n");
+		HOT_PRINTM(MINFO,
+			   "host_2_card_mp_aggr: Postcopy current buffer\n");
 		if (pmadapter->mpa_buf)
 			memcpy(pmadapter, pmadapter->mpa_buf +
 			       (pmadapter->last_mp_index * mp_aggr_pkt_limit +
@@ -1408,7 +1586,7 @@ tx_curr_single:
 	if (aggr_sg)
 		ret = MLAN_STATUS_PENDING;
 
-	LEAVE();
+	HOT_LEAVE();
 	return ret;
 }
 #endif /* SDIO_MULTI_PORT_TX_AGGR */
@@ -1462,23 +1640,28 @@ wlan_check_fw_status(mlan_adapter *pmadapter, t_u32 pollnum)
 {
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 	t_u16 firmwarestat = 0;
-	t_u32 tries;
+	t_u32 delay = FW_READY_POLL_MIN_DELAY;
+	t_u32 waited = 0;
 
 	ENTER();
 
-	/* Wait for firmware initialization event */
-	for (tries = 0; tries < pollnum; tries++) {
+	/* Wait for firmware initialization event. The total wait is still
+	 * pollnum * FW_READY_POLL_MAX_DELAY ms, but the first polls are
+	 * closer together so firmware downloaded by the other interface
+	 * is picked up soon after it comes up. */
+	do {
 		ret = wlan_sdio_read_fw_status(pmadapter, &firmwarestat);
-		if (MLAN_STATUS_SUCCESS != ret)
-			continue;
-		if (firmwarestat == FIRMWARE_READY) {
-			ret = MLAN_STATUS_SUCCESS;
+		if (MLAN_STATUS_SUCCESS == ret &&
+		    firmwarestat == FIRMWARE_READY)
 			break;
-		} else {
-			wlan_mdelay(pmadapter, 100);
-			ret = MLAN_STATUS_FAILURE;
-		}
-	}
+		ret = MLAN_STATUS_FAILURE;
+		/* A single status check does not need to sleep */
+		if (pollnum <= 1)
+			break;
+		wlan_mdelay(pmadapter, delay);
+		waited += delay;
+		delay = MIN(delay << 1, FW_READY_POLL_MAX_DELAY);
+	} while (waited < pollnum * FW_READY_POLL_MAX_DELAY);
 
 	if (ret != MLAN_STATUS_SUCCESS) {
 		if (pollnum > 1)
@@ -1554,13 +1737,15 @@ wlan_sdio_probe(pmlan_adapter pmadapter)
 }
 
 /**
- *  @brief This function gets interrupt status.
+ *  @brief This function reads the SDIO registers and latches the
+ *         interrupt status into pmadapter->sdio_ireg
  *
  *  @param pmadapter    A pointer to mlan_adapter structure
- *  @return             MLAN_STATUS_SUCCESS
+ *  @param pireg        A pointer to the interrupt status read
+ *  @return             MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
  */
-mlan_status
-wlan_interrupt(pmlan_adapter pmadapter)
+static mlan_status
+wlan_sdio_read_int_status(pmlan_adapter pmadapter, t_u32 *pireg)
 {
 	pmlan_callbacks pcb = &pmadapter->callbacks;
 	mlan_buffer mbuf;
@@ -1570,8 +1755,7 @@ wlan_interrupt(pmlan_adapter pmadapter)
 	t_u8 max_mp_regs = MAX_MP_REGS;
 	t_u8 host_int_status_reg = HOST_INT_STATUS_REG;
 
-	ENTER();
-
+	*pireg = 0;
 	while (max_mp_regs) {
 		memset(pmadapter, &mbuf, 0, sizeof(mlan_buffer));
 		mbuf.pbuf = pmadapter->mp_regs + offset;
@@ -1585,7 +1769,7 @@ wlan_interrupt(pmlan_adapter pmadapter)
 			PRINTM(MERROR,
 			       "moal_read_data_sync: read registers failed\n");
 			pmadapter->dbg.num_int_read_failure++;
-			goto done;
+			return MLAN_STATUS_FAILURE;
 		}
 		offset += mbuf.data_len;
 		max_mp_regs -= mbuf.data_len;
@@ -1603,7 +1787,6 @@ wlan_interrupt(pmlan_adapter pmadapter)
 		 * Clear the interrupt status register
 		 */
 		PRINTM(MINTR, "wlan_interrupt: sdio_ireg = 0x%x\n", sdio_ireg);
-		pmadapter->num_of_irq++;
 		pcb->moal_spin_lock(pmadapter->pmoal_handle,
 				    pmadapter->pint_lock);
 		pmadapter->sdio_ireg |= sdio_ireg;
@@ -1616,14 +1799,77 @@ wlan_interrupt(pmlan_adapter pmadapter)
 			pmadapter->ps_state = PS_STATE_AWAKE;
 			pmadapter->pm_wakeup_card_req = MFALSE;
 		}
-	} else {
-		PRINTM(MMSG, "wlan_interrupt: sdio_ireg = 0x%x\n", sdio_ireg);
 	}
-done:
+	*pireg = sdio_ireg;
+	return MLAN_STATUS_SUCCESS;
+}
+
+/**
+ *  @brief This function gets interrupt status.
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @return             MLAN_STATUS_SUCCESS
+ */
+mlan_status
+wlan_interrupt(pmlan_adapter pmadapter)
+{
+	t_u32 sdio_ireg = 0;
+
+	ENTER();
+
+	if (wlan_sdio_read_int_status(pmadapter, &sdio_ireg) ==
+	    MLAN_STATUS_SUCCESS) {
+		if (sdio_ireg)
+			pmadapter->num_of_irq++;
+		else
+			PRINTM(MMSG, "wlan_interrupt: sdio_ireg = 0x%x\n",
+			       sdio_ireg);
+	}
 	LEAVE();
 	return MLAN_STATUS_SUCCESS;
 }
 
+/**
+ *  @brief This function polls the card for the response to the command
+ *         in flight, backing off between reads of the interrupt status
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @return             MTRUE if the response is ready, otherwise MFALSE
+ */
+t_u8
+wlan_sdio_poll_cmd_resp(pmlan_adapter pmadapter)
+{
+	pmlan_callbacks pcb = &pmadapter->callbacks;
+	t_u32 delay = INIT_CMD_POLL_MIN_DELAY;
+	t_u32 waited = 0;
+	t_u32 sdio_ireg = 0;
+
+	ENTER();
+
+	while (!(pmadapter->sdio_ireg & UP_LD_CMD_PORT_HOST_INT_STATUS)) {
+		if (waited >= INIT_CMD_POLL_MAX_WAIT) {
+			PRINTM(MINFO, "Poll cmd resp: fall back to interrupt\n");
+			LEAVE();
+			return MFALSE;
+		}
+		/* Only the first short steps spin, longer ones sleep */
+		if (delay < INIT_CMD_POLL_SLEEP_MIN)
+			pcb->moal_udelay(pmadapter->pmoal_handle, delay);
+		else
+			pcb->moal_usleep(pmadapter->pmoal_handle, delay,
+					 delay * 2);
+		waited += delay;
+		delay = MIN(delay * 2, INIT_CMD_POLL_MAX_DELAY);
+		if (wlan_sdio_read_int_status(pmadapter, &sdio_ireg) !=
+		    MLAN_STATUS_SUCCESS) {
+			LEAVE();
+			return MFALSE;
+		}
+	}
+	LEAVE();
+	return MTRUE;
+}
+
 /**
  *  @brief This function enables the host interrupts.
  *
@@ -1730,7 +1976,7 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 	t_u8 cmd_rd_len_0 = CMD_RD_LEN_0;
 	t_u8 cmd_rd_len_1 = CMD_RD_LEN_1;
 
-	ENTER();
+	HOT_ENTER();
 
 	pcb->moal_spin_lock(pmadapter->pmoal_handle, pmadapter->pint_lock);
 	sdio_ireg = pmadapter->sdio_ireg;
@@ -1739,18 +1985,19 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 
 	if (!sdio_ireg)
 		goto done;
+	MTRACE(MTRACE_INT_STATUS, sdio_ireg, 0, 0);
 	/* check the command port */
 	if (sdio_ireg & DN_LD_CMD_PORT_HOST_INT_STATUS) {
 		if (pmadapter->cmd_sent)
 			pmadapter->cmd_sent = MFALSE;
-		PRINTM(MINFO, "cmd_sent=%d\n", pmadapter->cmd_sent);
+		HOT_PRINTM(MINFO, "cmd_sent=%d\n", pmadapter->cmd_sent);
 	}
 
 	if (sdio_ireg & UP_LD_CMD_PORT_HOST_INT_STATUS) {
 		/* read the len of control packet */
 		rx_len = ((t_u16)pmadapter->mp_regs[cmd_rd_len_1]) << 8;
 		rx_len |= (t_u16)pmadapter->mp_regs[cmd_rd_len_0];
-		PRINTM(MINFO, "RX: cmd port rx_len=%u\n", rx_len);
+		HOT_PRINTM(MINFO, "RX: cmd port rx_len=%u\n", rx_len);
 		rx_blocks =
 			(rx_len + MLAN_SDIO_BLOCK_SIZE -
 			 1) / MLAN_SDIO_BLOCK_SIZE;
@@ -1768,7 +2015,7 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 			ret = MLAN_STATUS_FAILURE;
 			goto done;
 		}
-		PRINTM(MINFO, "cmd rx buffer rx_len = %d\n", rx_len);
+		HOT_PRINTM(MINFO, "cmd rx buffer rx_len = %d\n", rx_len);
 
 		/* Transfer data from card */
 		if (MLAN_STATUS_SUCCESS !=
@@ -1791,7 +2038,7 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 			       "receive a wrong packet from CMD PORT. type =0x%d\n",
 			       upld_typ);
 
-		wlan_decode_rx_packet(pmadapter, pmbuf, upld_typ, MFALSE);
+		wlan_decode_rx_packet(pmadapter, pmbuf, upld_typ);
 
 		/* We might receive data/sleep_cfm at the same time */
 		/* reset data_receive flag to avoid ps_state change */
@@ -1823,12 +2070,14 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 #ifdef SDIO_MULTI_PORT_TX_AGGR
 		pmadapter->last_recv_wr_bitmap = pmadapter->mp_wr_bitmap;
 #endif
-		PRINTM(MINTR, "DNLD: wr_bitmap=0x%08x\n",
-		       pmadapter->mp_wr_bitmap);
+		HOT_PRINTM(MINTR, "DNLD: wr_bitmap=0x%08x\n",
+			   pmadapter->mp_wr_bitmap);
+		MTRACE(MTRACE_WR_BITMAP, pmadapter->mp_wr_bitmap,
+		       pmadapter->curr_wr_port, pmadapter->data_sent);
 		if (pmadapter->data_sent &&
 		    (pmadapter->
 		     mp_wr_bitmap & (1 << pmadapter->curr_wr_port))) {
-			PRINTM(MINFO, " <--- Tx DONE Interrupt --->\n");
+			HOT_PRINTM(MINFO, " <--- Tx DONE Interrupt --->\n");
 			pmadapter->data_sent = MFALSE;
 		}
 	}
@@ -1842,21 +2091,24 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 			((t_u32)pmadapter->mp_regs[RD_BITMAP_1L]) << 16;
 		pmadapter->mp_rd_bitmap |=
 			((t_u32)pmadapter->mp_regs[RD_BITMAP_1U]) << 24;
-		PRINTM(MINTR, "UPLD: rd_bitmap=0x%08x\n",
-		       pmadapter->mp_rd_bitmap);
+		HOT_PRINTM(MINTR, "UPLD: rd_bitmap=0x%08x\n",
+			   pmadapter->mp_rd_bitmap);
+		MTRACE(MTRACE_RD_BITMAP, pmadapter->mp_rd_bitmap, 0, 0);
 
 		while (MTRUE) {
 			ret = wlan_get_rd_port(pmadapter, &port);
 			if (ret != MLAN_STATUS_SUCCESS) {
-				PRINTM(MINFO,
-				       "no more rd_port to be handled\n");
+				HOT_PRINTM(MINFO,
+					   "no more rd_port to be handled\n");
 				break;
 			}
 			len_reg_l = rd_len_p0_l + (port << 1);
 			len_reg_u = rd_len_p0_u + (port << 1);
 			rx_len = ((t_u16)pmadapter->mp_regs[len_reg_u]) << 8;
 			rx_len |= (t_u16)pmadapter->mp_regs[len_reg_l];
-			PRINTM(MINFO, "RX: port=%d rx_len=%u\n", port, rx_len);
+			HOT_PRINTM(MINFO,
+				   "RX: port=%d rx_len=%u\n", port, rx_len);
+			MTRACE(MTRACE_RX_PORT, port, rx_len, 0);
 			rx_blocks =
 				(rx_len + MLAN_SDIO_BLOCK_SIZE -
 				 1) / MLAN_SDIO_BLOCK_SIZE;
@@ -1874,10 +2126,11 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 				goto done;
 			}
 			rx_len = (t_u16)(rx_blocks * MLAN_SDIO_BLOCK_SIZE);
+			/* AMSDU containers are freed by MLAN after deaggregation */
 			if (rx_len > MRVDRV_ETH_RX_PACKET_BUFFER_SIZE)
 				pmbuf = wlan_alloc_mlan_buffer(pmadapter,
 							       rx_len, 0,
-							       MOAL_MALLOC_BUFFER);
+							       MOAL_ALLOC_POOL_BUFFER);
 			else
 				pmbuf = wlan_alloc_mlan_buffer(pmadapter,
 							       rx_len,
@@ -1897,7 +2150,7 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 				ret = MLAN_STATUS_FAILURE;
 				goto done;
 			}
-			PRINTM(MINFO, "rx_len = %d\n", rx_len);
+			HOT_PRINTM(MINFO, "rx_len = %d\n", rx_len);
 #ifdef SDIO_MULTI_PORT_RX_AGGR
 			if (MLAN_STATUS_SUCCESS !=
 			    wlan_sdio_card_to_host_mp_aggr(pmadapter, pmbuf,
@@ -1923,8 +2176,7 @@ wlan_process_int_status(mlan_adapter *pmadapter)
 				goto term_cmd53;
 			}
 #ifndef SDIO_MULTI_PORT_RX_AGGR
-			wlan_decode_rx_packet(pmadapter, pmbuf, upld_typ,
-					      MTRUE);
+			wlan_decode_rx_packet(pmadapter, pmbuf, upld_typ);
 #endif
 		}
 		/* We might receive data/sleep_cfm at the same time */
@@ -1943,20 +2195,20 @@ term_cmd53:
 						      HOST_TO_CARD_EVENT_REG,
 						      &cr))
 		PRINTM(MERROR, "read CFG reg failed\n");
-	PRINTM(MINFO, "Config Reg val = %d\n", cr);
+	HOT_PRINTM(MINFO, "Config Reg val = %d\n", cr);
 	if (MLAN_STATUS_SUCCESS != pcb->moal_write_reg(pmadapter->pmoal_handle,
 						       HOST_TO_CARD_EVENT_REG,
 						       (cr | HOST_TERM_CMD53)))
 		PRINTM(MERROR, "write CFG reg failed\n");
-	PRINTM(MINFO, "write success\n");
+	HOT_PRINTM(MINFO, "write success\n");
 	if (MLAN_STATUS_SUCCESS != pcb->moal_read_reg(pmadapter->pmoal_handle,
 						      HOST_TO_CARD_EVENT_REG,
 						      &cr))
 		PRINTM(MERROR, "read CFG reg failed\n");
-	PRINTM(MINFO, "Config reg val =%x\n", cr);
+	HOT_PRINTM(MINFO, "Config reg val =%x\n", cr);
 
 done:
-	LEAVE();
+	HOT_LEAVE();
 	return ret;
 }
 
@@ -1981,7 +2233,7 @@ wlan_sdio_host_to_card(mlan_adapter *pmadapter, t_u8 type, mlan_buffer *pmbuf,
 	t_u8 *payload = pmbuf->pbuf + pmbuf->data_offset;
 	t_u16 max_size = 0;
 
-	ENTER();
+	HOT_ENTER();
 
 	/* Allocate buffer and copy payload */
 	blksz = MLAN_SDIO_BLOCK_SIZE;
@@ -2005,6 +2257,7 @@ wlan_sdio_host_to_card(mlan_adapter *pmadapter, t_u8 type, mlan_buffer *pmbuf,
 	 *    MLAN_TYPE_CMD = 1, MLAN_TYPE_EVENT = 3)
 	 */
 	if (type == MLAN_TYPE_DATA) {
+		wlan_tx_lat_stamp(pmadapter, pmbuf, MLAN_TX_TS_SDIO);
 		ret = wlan_get_wr_port_data(pmadapter, &port);
 		if (ret != MLAN_STATUS_SUCCESS) {
 			PRINTM(MERROR,
@@ -2014,7 +2267,15 @@ wlan_sdio_host_to_card(mlan_adapter *pmadapter, t_u8 type, mlan_buffer *pmbuf,
 			goto exit;
 		}
 		/* Transfer data to card */
-		pmbuf->data_len = buf_block_len * blksz;
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+		/* In SG mode a plain buffer is padded from mpa_tx.pad_buf */
+		if (pmadapter->mpa_tx.buf || (pmbuf->flags & MLAN_BUF_FLAG_SG))
+#endif
+			pmbuf->data_len = buf_block_len * blksz;
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+		if (pmbuf->flags & MLAN_BUF_FLAG_SG)
+			wlan_sdio_pad_sg_buf(pmbuf);
+#endif
 
 #ifdef SDIO_MULTI_PORT_TX_AGGR
 		if (tx_param)
@@ -2027,7 +2288,7 @@ wlan_sdio_host_to_card(mlan_adapter *pmadapter, t_u8 type, mlan_buffer *pmbuf,
 		ret = wlan_write_data_sync(pmadapter, pmbuf,
 					   pmadapter->ioport + port);
 #endif /* SDIO_MULTI_PORT_TX_AGGR */
-
+		MTRACE(MTRACE_TX_DNLD, port, pmbuf->data_len, ret);
 	} else {
 		/*Type must be MLAN_TYPE_CMD */
 		pmadapter->cmd_sent = MTRUE;
@@ -2061,7 +2322,7 @@ wlan_sdio_host_to_card(mlan_adapter *pmadapter, t_u8 type, mlan_buffer *pmbuf,
 			    MIN(pmbuf->data_len, MAX_DATA_DUMP_LEN));
 	}
 exit:
-	LEAVE();
+	HOT_LEAVE();
 	return ret;
 }
 
@@ -2072,11 +2333,12 @@ exit:
  *  @param buf	A pointer to aggregated data packet
  *  @param len
  *
- *  @return		N/A
+ *  @return		Number of packets handled
  */
-void
+t_u32
 wlan_decode_spa_buffer(mlan_adapter *pmadapter, t_u8 *buf, t_u32 len)
 {
+	t_u32 pkt_cnt = 0;
 	int total_pkt_len;
 	t_u8 block_num = 0;
 	t_u16 block_size = 0;
@@ -2128,6 +2390,7 @@ wlan_decode_spa_buffer(mlan_adapter *pmadapter, t_u8 *buf, t_u32 len)
 		       pkt_len - INTF_HEADER_LEN);
 		mbuf_deaggr->data_len = pkt_len - INTF_HEADER_LEN;
 		wlan_handle_rx_packet(pmadapter, mbuf_deaggr);
+		pkt_cnt++;
 		data += block_size;
 		total_pkt_len -= block_size;
 		if (total_pkt_len < pmadapter->sdio_rx_block_size)
@@ -2135,7 +2398,7 @@ wlan_decode_spa_buffer(mlan_adapter *pmadapter, t_u8 *buf, t_u32 len)
 	}
 done:
 	LEAVE();
-	return;
+	return pkt_cnt;
 }
 
 /**
@@ -2143,18 +2406,22 @@ done:
  *
  *  @param pmadapter A pointer to mlan_adapter structure
  *  @param pmbuf     A pointer to the SDIO mpa data
- *  @return          N/A
+ *  @return          Number of packets handled
  */
-t_void
+t_u32
 wlan_sdio_deaggr_rx_pkt(IN pmlan_adapter pmadapter, mlan_buffer *pmbuf)
 {
+	t_u32 pkt_cnt = 1;
+
 	if (pmbuf->buf_type == MLAN_BUF_TYPE_SPA_DATA) {
-		wlan_decode_spa_buffer(pmadapter,
-				       pmbuf->pbuf + pmbuf->data_offset,
-				       pmbuf->data_len);
+		pkt_cnt = wlan_decode_spa_buffer(pmadapter,
+						 pmbuf->pbuf +
+						 pmbuf->data_offset,
+						 pmbuf->data_len);
 		wlan_free_mlan_buffer(pmadapter, pmbuf);
 	} else
 		wlan_handle_rx_packet(pmadapter, pmbuf);
+	return pkt_cnt;
 }
 
 #if defined(SDIO_MULTI_PORT_TX_AGGR) || defined(SDIO_MULTI_PORT_RX_AGGR)
@@ -2175,6 +2442,9 @@ wlan_alloc_sdio_mpa_buffers(IN mlan_adapter *pmadapter,
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 	pmlan_callbacks pcb = &pmadapter->callbacks;
 	t_u8 mp_aggr_pkt_limit = SDIO_MP_AGGR_DEF_PKT_LIMIT;
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+	t_u32 i;
+#endif
 
 	ENTER();
 
@@ -2198,6 +2468,27 @@ wlan_alloc_sdio_mpa_buffers(IN mlan_adapter *pmadapter,
 		PRINTM(MMSG, "wlan: Enable TX SG mode\n");
 		pmadapter->mpa_tx.head_ptr = MNULL;
 		pmadapter->mpa_tx.buf = MNULL;
+		pmadapter->mpa_tx.seg_limit =
+			MIN(pmadapter->max_segs, SDIO_MP_SG_MAX_SEGS);
+		ret = pcb->moal_malloc(pmadapter->pmoal_handle,
+				       MLAN_SDIO_BLOCK_SIZE + DMA_ALIGNMENT,
+				       MLAN_MEM_DEF | MLAN_MEM_DMA,
+				       (t_u8 **)&pmadapter->mpa_tx.pad_ptr);
+		if (ret != MLAN_STATUS_SUCCESS || !pmadapter->mpa_tx.pad_ptr) {
+			PRINTM(MERROR,
+			       "Could not allocate SDIO MP TX pad buffer\n");
+			ret = MLAN_STATUS_FAILURE;
+			goto error;
+		}
+		memset(pmadapter, pmadapter->mpa_tx.pad_ptr, 0,
+		       MLAN_SDIO_BLOCK_SIZE + DMA_ALIGNMENT);
+		for (i = 0; i < SDIO_MP_AGGR_DEF_PKT_LIMIT; i++) {
+			memset(pmadapter, &pmadapter->mpa_tx.pad_buf[i], 0,
+			       sizeof(mlan_buffer));
+			pmadapter->mpa_tx.pad_buf[i].pbuf =
+				(t_u8 *)ALIGN_ADDR(pmadapter->mpa_tx.pad_ptr,
+						   DMA_ALIGNMENT);
+		}
 	}
 	pmadapter->mpa_tx.buf_size = mpa_tx_buf_size;
 #endif /* SDIO_MULTI_PORT_TX_AGGR */
@@ -2255,6 +2546,11 @@ wlan_free_sdio_mpa_buffers(IN mlan_adapter *pmadapter)
 		pmadapter->mpa_tx.buf = MNULL;
 		pmadapter->mpa_tx.buf_size = 0;
 	}
+	if (pmadapter->mpa_tx.pad_ptr) {
+		pcb->moal_mfree(pmadapter->pmoal_handle,
+				(t_u8 *)pmadapter->mpa_tx.pad_ptr);
+		pmadapter->mpa_tx.pad_ptr = MNULL;
+	}
 #endif /* SDIO_MULTI_PORT_TX_AGGR */
 
 #ifdef SDIO_MULTI_PORT_RX_AGGR
@@ -293,6 +293,28 @@ Change log:
 /** SDIO byte mode size */
 #define MAX_BYTE_MODE_SIZE             512
 
+/** First delay between init command response polls in us */
+#define INIT_CMD_POLL_MIN_DELAY		20
+/** Delays between init command response polls from this long on sleep
+ *  instead of spinning, in us */
+#define INIT_CMD_POLL_SLEEP_MIN		100
+/** Longest delay between init command response polls in us */
+#define INIT_CMD_POLL_MAX_DELAY		500
+/** Time to poll for one init command response before waiting for
+ *  the SDIO interrupt, in us */
+#define INIT_CMD_POLL_MAX_WAIT		20000
+
+/** First delay between FW download status polls in us */
+#define FW_DNLD_POLL_MIN_DELAY		1
+/** Longest delay between FW download status polls in us */
+#define FW_DNLD_POLL_MAX_DELAY		10
+/** Time to wait for the helper during FW download, in us */
+#define FW_DNLD_POLL_MAX_WAIT		(MAX_POLL_TRIES * FW_DNLD_POLL_MAX_DELAY)
+/** First delay between firmware ready polls in ms */
+#define FW_READY_POLL_MIN_DELAY		5
+/** Longest delay between firmware ready polls in ms */
+#define FW_READY_POLL_MAX_DELAY		100
+
 #if defined(SDIO_MULTI_PORT_TX_AGGR) || defined(SDIO_MULTI_PORT_RX_AGGR)
 /** The base address for packet with multiple ports aggregation */
 #define SDIO_MPA_ADDR_BASE             0x1000
@@ -303,9 +325,22 @@ Change log:
 /** SDIO Tx aggregation in progress ? */
 #define MP_TX_AGGR_IN_PROGRESS(a) (a->mpa_tx.pkt_cnt > 0)
 
+/** Number of scatter-gather segments of an mlan_buffer */
+#define MLAN_BUF_SEG_CNT(mbuf) \
+			(((mbuf)->flags & MLAN_BUF_FLAG_SG) ? (mbuf)->frag_cnt : 1)
+
+/** Block aligned length of an SDIO Tx packet */
+#define MP_TX_BLK_LEN(mbuf) ALIGN_SZ((mbuf)->data_len, MLAN_SDIO_BLOCK_SIZE)
+
+/** Number of SG segments of a Tx packet, counting its padding buffer */
+#define MP_TX_SEG_CNT(mbuf) (MLAN_BUF_SEG_CNT(mbuf) + \
+			((MP_TX_BLK_LEN(mbuf) != (mbuf)->data_len) ? 1 : 0))
+
 /** SDIO Tx aggregation buffer room for next packet ? */
 #define MP_TX_AGGR_BUF_HAS_ROOM(a, mbuf, len) \
-			(((a->mpa_tx.buf_len) + len) <= (a->mpa_tx.buf_size))
+			((((a->mpa_tx.buf_len) + len) <= (a->mpa_tx.buf_size)) \
+			 && (a->mpa_tx.buf || ((a->mpa_tx.seg_cnt + \
+			 MP_TX_SEG_CNT(mbuf)) <= a->mpa_tx.seg_limit)))
 
 /** Copy current packet (SDIO Tx aggregation buffer) to SDIO buffer */
 #define MP_TX_AGGR_BUF_PUT(a, mbuf, port) do {          \
@@ -323,10 +358,11 @@ Change log:
 } while (0)
 
 #define MP_TX_AGGR_BUF_PUT_SG(a, mbuf, port) do {       \
-	a->mpa_tx.buf_len += mbuf->data_len;                \
+	a->mpa_tx.buf_len += MP_TX_BLK_LEN(mbuf);           \
 	a->mpa_tx.mp_wr_info[a->mpa_tx.pkt_cnt] = \
 		*(t_u16 *)(mbuf->pbuf+mbuf->data_offset); \
 	a->mpa_tx.mbuf_arr[a->mpa_tx.pkt_cnt] = mbuf;       \
+	a->mpa_tx.seg_cnt += MP_TX_SEG_CNT(mbuf);           \
 	if (!a->mpa_tx.pkt_cnt) {                           \
 		a->mpa_tx.start_port = port;                    \
 	}                                                   \
@@ -347,6 +383,7 @@ Change log:
 	a->mpa_tx.buf_len = 0;                   \
 	a->mpa_tx.ports = 0;                     \
 	a->mpa_tx.start_port = 0;                \
+	a->mpa_tx.seg_cnt = 0;                   \
 } while (0)
 
 #endif /* SDIO_MULTI_PORT_TX_AGGR */
@@ -355,7 +392,7 @@ Change log:
 
 /** SDIO Rx aggregation limit ? */
 #define MP_RX_AGGR_PKT_LIMIT_REACHED(a) (a->mpa_rx.pkt_cnt \
-		== a->mpa_rx.pkt_aggr_limit)
+		>= a->mpa_rx.pkt_aggr_limit)
 
 /** SDIO Rx aggregation port limit ? */
 /** this is for test only, because port 0 is reserved for control port */
@@ -373,9 +410,25 @@ Change log:
 /** SDIO Rx aggregation in progress ? */
 #define MP_RX_AGGR_IN_PROGRESS(a) (a->mpa_rx.pkt_cnt > 0)
 
+/** SDIO Rx aggregation buffer size in use, adaptive limit if set */
+#define MP_RX_AGGR_BUF_LIMIT(a) \
+	((a->mpa_rx.buf_limit && a->mpa_rx.buf_limit < a->mpa_rx.buf_size) ? \
+	 a->mpa_rx.buf_limit : a->mpa_rx.buf_size)
+
 /** SDIO Rx aggregation buffer room for next packet ? */
 #define MP_RX_AGGR_BUF_HAS_ROOM(a, rx_len)   \
-	((a->mpa_rx.buf_len + rx_len) <= a->mpa_rx.buf_size)
+	((a->mpa_rx.buf_len + rx_len) <= MP_RX_AGGR_BUF_LIMIT(a))
+
+/** Aggregated reads per adaptive MP-A RX sizing window, log2 */
+#define MPA_RX_ADAPT_WINDOW_SHIFT	6
+/** Aggregated reads per adaptive MP-A RX sizing window */
+#define MPA_RX_ADAPT_WINDOW		(1 << MPA_RX_ADAPT_WINDOW_SHIFT)
+/** Target duration of one MP-A RX CMD53 read in us */
+#define MPA_RX_ADAPT_LAT_TARGET_US	1000
+/** Lowest adaptive MP-A RX packet limit */
+#define MPA_RX_ADAPT_MIN_PKT_LIMIT	2
+/** Lowest adaptive MP-A RX buffer limit */
+#define MPA_RX_ADAPT_MIN_BUF		(2 * MLAN_RX_DATA_BUF_SIZE)
 
 /** Prepare to copy current packet from card to SDIO Rx aggregation buffer */
 #define MP_RX_AGGR_SETUP(a, mbuf, port, rx_len) do {   \
@@ -414,12 +467,14 @@ mlan_status wlan_send_mp_aggr_buf(mlan_adapter *pmadapter);
 mlan_status wlan_re_alloc_sdio_rx_mpa_buffer(IN mlan_adapter *pmadapter);
 #endif
 
-void wlan_decode_spa_buffer(mlan_adapter *pmadapter, t_u8 *buf, t_u32 len);
-t_void wlan_sdio_deaggr_rx_pkt(IN pmlan_adapter pmadapter, mlan_buffer *pmbuf);
+t_u32 wlan_decode_spa_buffer(mlan_adapter *pmadapter, t_u8 *buf, t_u32 len);
+t_u32 wlan_sdio_deaggr_rx_pkt(IN pmlan_adapter pmadapter, mlan_buffer *pmbuf);
 /** Firmware status check */
 mlan_status wlan_check_fw_status(mlan_adapter *pmadapter, t_u32 pollnum);
 /** Read interrupt status */
 mlan_status wlan_interrupt(pmlan_adapter pmadapter);
+/** Poll for the response to the command in flight */
+t_u8 wlan_sdio_poll_cmd_resp(pmlan_adapter pmadapter);
 /** Process Interrupt Status */
 mlan_status wlan_process_int_status(mlan_adapter *pmadapter);
 /** Transfer data to card */
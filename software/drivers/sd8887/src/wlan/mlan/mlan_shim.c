@@ -336,11 +336,14 @@ mlan_register(IN pmlan_device pmdevice, OUT t_void **ppmlan_adapter)
 
 #ifdef SDIO_MULTI_PORT_TX_AGGR
 	pmadapter->init_para.mpa_tx_cfg = pmdevice->mpa_tx_cfg;
+	pmadapter->amsdu_sg = pmdevice->amsdu_sg;
 #endif
 #ifdef SDIO_MULTI_PORT_RX_AGGR
 	pmadapter->init_para.mpa_rx_cfg = pmdevice->mpa_rx_cfg;
+	pmadapter->mpa_rx_adapt = pmdevice->mpa_rx_adapt;
 #endif
 	pmadapter->sdio_rx_aggr_enable = pmdevice->sdio_rx_aggr_enable;
+	pmadapter->init_cmd_poll = pmdevice->init_cmd_poll;
 	pmadapter->init_para.auto_ds = pmdevice->auto_ds;
 	pmadapter->init_para.ps_mode = pmdevice->ps_mode;
 	if (pmdevice->max_tx_buf == MLAN_TX_DATA_BUF_SIZE_2K ||
@@ -360,6 +363,7 @@ mlan_register(IN pmlan_device pmdevice, OUT t_void **ppmlan_adapter)
 	pmadapter->rx_work_flag = pmdevice->rx_work;
 
 	pmadapter->fixed_beacon_buffer = pmdevice->fixed_beacon_buffer;
+	pmadapter->max_beacon_buffer = pmdevice->max_beacon_buffer;
 
 	pmadapter->multiple_dtim = pmdevice->multi_dtim;
 	pmadapter->inact_tmo = pmdevice->inact_tmo;
@@ -699,6 +703,8 @@ mlan_init_fw(IN t_void *pmlan_adapter
 	MASSERT(pmlan_adapter);
 
 	pmadapter->hw_status = WlanHardwareStatusGetHwSpec;
+	pmadapter->callbacks.moal_get_boot_ktime(pmadapter->pmoal_handle,
+						 &pmadapter->dbg.init_start_ns);
 
 	/* Initialize firmware, may return PENDING */
 	ret = wlan_init_fw(pmadapter);
@@ -772,15 +778,8 @@ mlan_shutdown_fw(IN t_void *pmlan_adapter
 					 MLAN_STATUS_FAILURE);
 	}
 
-	while ((pmbuf = (pmlan_buffer)util_dequeue_list(pmadapter->pmoal_handle,
-							&pmadapter->
-							rx_data_queue,
-							pcb->moal_spin_lock,
-							pcb->
-							moal_spin_unlock))) {
+	while ((pmbuf = wlan_rx_ring_get(pmadapter)))
 		wlan_free_mlan_buffer(pmadapter, pmbuf);
-	}
-	pmadapter->rx_pkts_queued = 0;
 
 	/* Notify completion */
 	ret = wlan_shutdown_fw_complete(pmadapter);
@@ -920,6 +919,11 @@ mlan_block_rx_process(mlan_adapter *pmadapter, t_u8 block)
 /**
  *  @brief The receive process
  *
+ *  A non-zero *rx_pkts is a packet budget (NAPI poll). Packets
+ *  unpacked from a single port aggregation buffer count against it,
+ *  and a main process throttled on HIGH_RX_PENDING is resumed only
+ *  once the poll drains the queue within budget.
+ *
  *  @param pmlan_adapter	A pointer to mlan_adapter structure
  *  @param rx_pkts		    A pointer to save receive pkts number
  *
@@ -933,7 +937,7 @@ mlan_rx_process(IN t_void *pmlan_adapter, IN t_u8 *rx_pkts)
 	pmlan_callbacks pcb;
 	pmlan_buffer pmbuf;
 	t_u8 limit = 0;
-	t_u8 rx_num = 0;
+	t_u32 rx_num = 0;
 
 	ENTER();
 
@@ -961,38 +965,30 @@ rx_process_start:
 			pmadapter->flush_data = MFALSE;
 			wlan_flush_rxreorder_tbl(pmadapter);
 		}
-		pmadapter->callbacks.moal_spin_lock(pmadapter->pmoal_handle,
-						    pmadapter->rx_data_queue.
-						    plock);
-		pmbuf = (pmlan_buffer)util_dequeue_list(pmadapter->pmoal_handle,
-							&pmadapter->
-							rx_data_queue, MNULL,
-							MNULL);
-		if (!pmbuf) {
-			pmadapter->callbacks.moal_spin_unlock(pmadapter->
-							      pmoal_handle,
-							      pmadapter->
-							      rx_data_queue.
-							      plock);
+		pmbuf = wlan_rx_ring_get(pmadapter);
+		if (!pmbuf)
 			break;
-		}
-		pmadapter->rx_pkts_queued--;
-		rx_num++;
-		pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
-						      pmadapter->rx_data_queue.
-						      plock);
-		if (pmadapter->delay_task_flag &&
-		    (pmadapter->rx_pkts_queued < LOW_RX_PENDING)) {
+		if (!limit &&
+		    pcb->moal_load_acquire(&pmadapter->delay_task_flag) &&
+		    (wlan_rx_pkts_queued(pmadapter) < LOW_RX_PENDING)) {
 			PRINTM(MEVENT, "Run\n");
-			pmadapter->delay_task_flag = MFALSE;
+			pcb->moal_store_release(&pmadapter->delay_task_flag,
+						MFALSE);
 			mlan_queue_main_work(pmadapter);
 		}
-		wlan_sdio_deaggr_rx_pkt(pmadapter, pmbuf);
+		rx_num += wlan_sdio_deaggr_rx_pkt(pmadapter, pmbuf);
 		if (limit && rx_num >= limit)
 			break;
 	}
+	if (limit && rx_num < limit &&
+	    pcb->moal_load_acquire(&pmadapter->delay_task_flag)) {
+		/* Poll completes within budget, re-arm the main process */
+		PRINTM(MEVENT, "Run\n");
+		pcb->moal_store_release(&pmadapter->delay_task_flag, MFALSE);
+		mlan_queue_main_work(pmadapter);
+	}
 	if (rx_pkts)
-		*rx_pkts = rx_num;
+		*rx_pkts = (limit && rx_num > limit) ? limit : (t_u8)rx_num;
 	pcb->moal_spin_lock(pmadapter->pmoal_handle, pmadapter->prx_proc_lock);
 	if (pmadapter->more_rx_task_flag) {
 		pmadapter->more_rx_task_flag = MFALSE;
@@ -1062,9 +1058,12 @@ process_start:
 			pmadapter->pending_disconnect_priv = MNULL;
 		}
 
-		if (pmadapter->rx_pkts_queued > HIGH_RX_PENDING) {
+		if (wlan_rx_pkts_queued(pmadapter) > HIGH_RX_PENDING) {
 			PRINTM(MEVENT, "Pause\n");
-			pmadapter->delay_task_flag = MTRUE;
+			/* Set before kicking the rx process so its drain
+			 * sees the flag and restarts us */
+			pcb->moal_store_release(&pmadapter->delay_task_flag,
+						MTRUE);
 			mlan_queue_rx_work(pmadapter);
 			break;
 		}
@@ -1184,6 +1183,15 @@ process_start:
 				ret = MLAN_STATUS_FAILURE;
 				break;
 			}
+			/* Take init command responses without waiting for
+			   the SDIO interrupt */
+			if (pmadapter->init_cmd_poll && pmadapter->curr_cmd &&
+			    (pmadapter->hw_status ==
+			     WlanHardwareStatusGetHwSpec ||
+			     pmadapter->hw_status ==
+			     WlanHardwareStatusInitializing) &&
+			    wlan_sdio_poll_cmd_resp(pmadapter))
+				continue;
 		}
 
 		if (!pmadapter->data_sent &&
@@ -1270,7 +1278,7 @@ mlan_send_packet(IN t_void *pmlan_adapter, IN pmlan_buffer pmbuf)
 	t_u8 ra[MLAN_MAC_ADDR_LENGTH];
 	tdlsStatus_e tdls_status;
 
-	ENTER();
+	HOT_ENTER();
 	MASSERT(pmlan_adapter &&pmbuf);
 
 	if (!pmlan_adapter ||!pmbuf) {
@@ -1300,14 +1308,14 @@ mlan_send_packet(IN t_void *pmlan_adapter, IN pmlan_buffer pmbuf)
 			    !pmpriv->media_connected)
 				pmbuf->flags |= MLAN_BUF_FLAG_TDLS;
 		}
-		PRINTM(MINFO, "mlan_send_pkt(): enq(bybass_txq)\n");
+		HOT_PRINTM(MINFO, "mlan_send_pkt(): enq(bybass_txq)\n");
 		wlan_add_buf_bypass_txqueue(pmadapter, pmbuf);
 	} else {
 		/* Transmit the packet */
 		wlan_wmm_add_buf_txqueue(pmadapter, pmbuf);
 	}
 
-	LEAVE();
+	HOT_LEAVE();
 	return ret;
 }
 
@@ -3931,7 +3931,6 @@ wlan_misc_ioctl_warm_reset(IN pmlan_adapter pmadapter,
 {
 	pmlan_private pmpriv = pmadapter->priv[pioctl_req->bss_index];
 	mlan_status ret = MLAN_STATUS_SUCCESS;
-	pmlan_callbacks pcb = &pmadapter->callbacks;
 	pmlan_buffer pmbuf;
 	t_s32 i = 0;
 	t_u16 mc_policy = pmadapter->mc_policy;
@@ -3946,15 +3945,8 @@ wlan_misc_ioctl_warm_reset(IN pmlan_adapter pmadapter,
 	for (i = 0; i < pmadapter->priv_num; i++)
 		wlan_free_priv(pmadapter->priv[i]);
 
-	while ((pmbuf = (pmlan_buffer)util_dequeue_list(pmadapter->pmoal_handle,
-							&pmadapter->
-							rx_data_queue,
-							pcb->moal_spin_lock,
-							pcb->
-							moal_spin_unlock))) {
+	while ((pmbuf = wlan_rx_ring_get(pmadapter)))
 		wlan_free_mlan_buffer(pmadapter, pmbuf);
-	}
-	pmadapter->rx_pkts_queued = 0;
 
 	/* Initialize adapter structure */
 	wlan_init_adapter(pmadapter);
@@ -4095,9 +4087,13 @@ wlan_misc_ioctl_sdio_mpa_ctrl(IN pmlan_adapter pmadapter,
 		if (mpa_ctrl->tx_max_ports > 0)
 			pmadapter->mpa_tx.pkt_aggr_limit =
 				mpa_ctrl->tx_max_ports;
-		if (mpa_ctrl->rx_max_ports > 0)
+		if (mpa_ctrl->rx_max_ports > 0) {
 			pmadapter->mpa_rx.pkt_aggr_limit =
 				mpa_ctrl->rx_max_ports;
+			pmadapter->mpa_rx.max_aggr_limit =
+				mpa_ctrl->rx_max_ports;
+		}
+		pmadapter->mpa_rx.buf_limit = 0;
 
 		pmadapter->mpa_tx.enabled = (t_u8)mpa_ctrl->tx_enable;
 		pmadapter->mpa_rx.enabled = (t_u8)mpa_ctrl->rx_enable;
@@ -4110,7 +4106,7 @@ wlan_misc_ioctl_sdio_mpa_ctrl(IN pmlan_adapter pmadapter,
 		mpa_ctrl->tx_max_ports =
 			(t_u16)pmadapter->mpa_tx.pkt_aggr_limit;
 		mpa_ctrl->rx_max_ports =
-			(t_u16)pmadapter->mpa_rx.pkt_aggr_limit;
+			(t_u16)pmadapter->mpa_rx.max_aggr_limit;
 	}
 
 exit:
@@ -5394,7 +5390,8 @@ start_config:
 				       sizeof(BSSDescriptor_t) *
 				       MRVDRV_MAX_BSSID_LIST);
 				pmadapter->num_in_scan_table = 0;
-				pmadapter->pbcn_buf_end = pmadapter->bcn_buf;
+				wlan_scan_hash_rebuild(pmadapter);
+				wlan_bcn_store_reset(pmadapter);
 				status = wlan_prepare_cmd(pmpriv,
 							  HostCmd_CMD_802_11_BG_SCAN_QUERY,
 							  HostCmd_ACT_GEN_GET,
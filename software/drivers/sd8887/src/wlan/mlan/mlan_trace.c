@@ -0,0 +1,203 @@
+/** @file mlan_trace.c
+ *
+ *  @brief This file contains the per-CPU ring behind the hot-path
+ *  trace points
+ *
+ *
+ *  Copyright 2014-2020 NXP
+ *
+ *  This software file (the File) is distributed by NXP
+ *  under the terms of the GNU General Public License Version 2, June 1991
+ *  (the License).  You may use, redistribute and/or modify the File in
+ *  accordance with the terms and conditions of the License, a copy of which
+ *  is available by writing to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA or on the
+ *  worldwide web at http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *  THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE EXPRESSLY DISCLAIMED.  The License provides additional details about
+ *  this warranty disclaimer.
+ *
+ */
+
+/******************************************************
+Change log:
+    10/16/2026: initial version
+******************************************************/
+
+#if defined(LINUX) && defined(HOTPATH_TRACE)
+#include <linux/module.h>
+#include <linux/percpu.h>
+#include <linux/mutex.h>
+#include <linux/irqflags.h>
+#include <linux/smp.h>
+#include <linux/version.h>
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 11, 0)
+#include <linux/sched/clock.h>
+#else
+#include <linux/sched.h>
+#endif
+#include "mlan_decl.h"
+#include "mlan_trace.h"
+
+/********************************************************
+			Local Variables
+********************************************************/
+
+/** Per-CPU trace ring */
+typedef struct _mlan_trace_ring {
+    /** Number of records written on this CPU since tracing was enabled */
+	t_u32 head;
+    /** Records, indexed by head modulo MLAN_TRACE_RING_SIZE */
+	mlan_trace_rec rec[MLAN_TRACE_RING_SIZE];
+} mlan_trace_ring;
+
+/** Rings are allocated on first enable and kept until unload */
+static mlan_trace_ring __percpu *trace_rings;
+/** Serialises enable/disable and readers */
+static DEFINE_MUTEX(trace_mutex);
+
+/********************************************************
+			Global Variables
+********************************************************/
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 3, 0)
+DEFINE_STATIC_KEY_FALSE(mlan_trace_key);
+#else
+t_u8 mlan_trace_on;
+#endif
+
+/********************************************************
+			Global Functions
+********************************************************/
+
+/**
+ *  @brief Write one record into this CPU's trace ring
+ *
+ *  Only reached through MTRACE() while tracing is enabled, so the
+ *  rings are known to be allocated.
+ *
+ *  @param id       Trace point id
+ *  @param arg0     First trace point argument
+ *  @param arg1     Second trace point argument
+ *  @param arg2     Third trace point argument
+ *
+ *  @return         N/A
+ */
+t_void
+mlan_trace_record(t_u16 id, t_u32 arg0, t_u32 arg1, t_u32 arg2)
+{
+	mlan_trace_ring *ring;
+	mlan_trace_rec *prec;
+	unsigned long flags;
+
+	/* Trace points are also hit from the interrupt path */
+	local_irq_save(flags);
+	ring = this_cpu_ptr(trace_rings);
+	prec = &ring->rec[ring->head & (MLAN_TRACE_RING_SIZE - 1)];
+	prec->ts = local_clock();
+	prec->id = id;
+	prec->cpu = (t_u16)smp_processor_id();
+	prec->arg[0] = arg0;
+	prec->arg[1] = arg1;
+	prec->arg[2] = arg2;
+	ring->head++;
+	local_irq_restore(flags);
+}
+
+/**
+ *  @brief Enable or disable the hot-path trace points
+ *
+ *  Enabling clears the rings, so every enable starts a fresh capture.
+ *
+ *  @param enable   MTRUE to enable, MFALSE to disable
+ *
+ *  @return         MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
+ */
+mlan_status
+mlan_trace_enable(IN t_u8 enable)
+{
+	mlan_status ret = MLAN_STATUS_SUCCESS;
+	int cpu;
+
+	mutex_lock(&trace_mutex);
+	if (!enable) {
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 3, 0)
+		static_branch_disable(&mlan_trace_key);
+#else
+		mlan_trace_on = MFALSE;
+#endif
+		goto done;
+	}
+	if (MTRACE_ENABLED())
+		goto done;
+	if (!trace_rings) {
+		trace_rings = alloc_percpu(mlan_trace_ring);
+		if (!trace_rings) {
+			ret = MLAN_STATUS_FAILURE;
+			goto done;
+		}
+	}
+	for_each_possible_cpu(cpu)
+		per_cpu_ptr(trace_rings, cpu)->head = 0;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 3, 0)
+	static_branch_enable(&mlan_trace_key);
+#else
+	smp_wmb();
+	mlan_trace_on = MTRUE;
+#endif
+done:
+	mutex_unlock(&trace_mutex);
+	return ret;
+}
+
+/**
+ *  @brief Copy the trace rings out, oldest record first per CPU
+ *
+ *  Records still being written while tracing is on may be torn;
+ *  disable tracing first for a consistent snapshot.
+ *
+ *  @param prec     Buffer for the records
+ *  @param max_rec  Number of records prec can hold
+ *
+ *  @return         Number of records copied
+ */
+t_u32
+mlan_trace_read(OUT pmlan_trace_rec prec, IN t_u32 max_rec)
+{
+	mlan_trace_ring *ring;
+	t_u32 head, num, i, count = 0;
+	int cpu;
+
+	mutex_lock(&trace_mutex);
+	if (!trace_rings)
+		goto done;
+	for_each_possible_cpu(cpu) {
+		ring = per_cpu_ptr(trace_rings, cpu);
+		head = ring->head;
+		num = min_t(t_u32, head, MLAN_TRACE_RING_SIZE);
+		num = min_t(t_u32, num, max_rec - count);
+		for (i = head - num; i != head; i++)
+			prec[count++] =
+				ring->rec[i & (MLAN_TRACE_RING_SIZE - 1)];
+	}
+done:
+	mutex_unlock(&trace_mutex);
+	return count;
+}
+
+/**
+ *  @brief Release the trace rings on module unload
+ *
+ *  @return         N/A
+ */
+static void __exit
+mlan_trace_exit(void)
+{
+	mlan_trace_enable(MFALSE);
+	free_percpu(trace_rings);
+}
+
+module_exit(mlan_trace_exit);
+#endif /* LINUX && HOTPATH_TRACE */
@@ -0,0 +1,86 @@
+/** @file mlan_trace.h
+ *
+ *  @brief This file contains the hot-path trace point ids and the
+ *  MTRACE() macro used by the data path
+ *
+ *
+ *  Copyright 2014-2020 NXP
+ *
+ *  This software file (the File) is distributed by NXP
+ *  under the terms of the GNU General Public License Version 2, June 1991
+ *  (the License).  You may use, redistribute and/or modify the File in
+ *  accordance with the terms and conditions of the License, a copy of which
+ *  is available by writing to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA or on the
+ *  worldwide web at http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt.
+ *
+ *  THE FILE IS DISTRIBUTED AS-IS, WITHOUT WARRANTY OF ANY KIND, AND THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE EXPRESSLY DISCLAIMED.  The License provides additional details about
+ *  this warranty disclaimer.
+ *
+ */
+
+/******************************************************
+Change log:
+    10/16/2026: initial version
+******************************************************/
+
+#ifndef _MLAN_TRACE_H_
+#define _MLAN_TRACE_H_
+
+/**
+ *  Hot-path trace point ids. The numbering is part of the record format
+ *  read back through /proc/mwlan/trace, keep mapp/mlantrace in sync.
+ */
+typedef enum _mlan_trace_id {
+	MTRACE_NONE = 0,
+	/** sdio_ireg */
+	MTRACE_INT_STATUS = 1,
+	/** mp_wr_bitmap, curr_wr_port, data_sent */
+	MTRACE_WR_BITMAP = 2,
+	/** mp_rd_bitmap */
+	MTRACE_RD_BITMAP = 3,
+	/** port, rx_len */
+	MTRACE_RX_PORT = 4,
+	/** upld_typ, upld_len */
+	MTRACE_RX_UPLD = 5,
+	/** port, data_len, status */
+	MTRACE_TX_DNLD = 6,
+	/** bss_index, tid, total_pkts */
+	MTRACE_TX_DEQUEUE = 7,
+	/** tid, seq_num, pkt_type */
+	MTRACE_RX_REORDER = 8,
+	/** tid, start_win, status */
+	MTRACE_RX_REORDER_DONE = 9,
+	MTRACE_MAX
+} mlan_trace_id;
+
+#if defined(HOTPATH_TRACE) && defined(LINUX)
+#include <linux/version.h>
+#include <linux/jump_label.h>
+
+/** Write one record into this CPU's trace ring */
+t_void mlan_trace_record(t_u16 id, t_u32 arg0, t_u32 arg1, t_u32 arg2);
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 3, 0)
+DECLARE_STATIC_KEY_FALSE(mlan_trace_key);
+/** Trace points are patched in only while tracing is on */
+#define MTRACE_ENABLED()	static_branch_unlikely(&mlan_trace_key)
+#else
+extern t_u8 mlan_trace_on;
+#define MTRACE_ENABLED()	unlikely(mlan_trace_on)
+#endif
+
+/** Record a hot-path trace point */
+#define MTRACE(id, a0, a1, a2)                                  \
+do {                                                            \
+	if (MTRACE_ENABLED())                                   \
+		mlan_trace_record(id, (t_u32)(a0), (t_u32)(a1), \
+				  (t_u32)(a2));                 \
+} while (0)
+#else
+#define MTRACE(id, a0, a1, a2) do {} while (0)
+#endif /* HOTPATH_TRACE && LINUX */
+
+#endif /* !_MLAN_TRACE_H_ */
@@ -69,7 +69,7 @@ wlan_handle_rx_packet(pmlan_adapter pmadapter, pmlan_buffer pmbuf)
 	t_u32 sec = 0, usec = 0;
 #endif
 
-	ENTER();
+	HOT_ENTER();
 
 	prx_pd = (RxPD *)(pmbuf->pbuf + pmbuf->data_offset);
 	/* Get the BSS number from RxPD, get corresponding priv */
@@ -84,11 +84,11 @@ wlan_handle_rx_packet(pmlan_adapter pmadapter, pmlan_buffer pmbuf)
 	pmbuf->bss_index = priv->bss_index;
 	PRINTM_GET_SYS_TIME(MDATA, &sec, &usec);
 	PRINTM_NETINTF(MDATA, priv);
-	PRINTM(MDATA, "%lu.%06lu : Data <= FW\n", sec, usec);
+	HOT_PRINTM(MDATA, "%lu.%06lu : Data <= FW\n", sec, usec);
 	ret = priv->ops.process_rx_packet(pmadapter, pmbuf);
 
 done:
-	LEAVE();
+	HOT_LEAVE();
 	return ret;
 }
 
@@ -187,6 +187,10 @@ wlan_write_data_complete(IN pmlan_adapter pmadapter,
 {
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 	pmlan_callbacks pcb;
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+	amsdu_sg_arena *arena;
+	t_u32 i;
+#endif
 
 	ENTER();
 
@@ -201,6 +205,18 @@ wlan_write_data_complete(IN pmlan_adapter pmadapter,
 	if ((pmbuf->buf_type == MLAN_BUF_TYPE_DATA) ||
 	    (pmbuf->buf_type == MLAN_BUF_TYPE_RAW_DATA)) {
 		PRINTM(MINFO, "wlan_write_data_complete: DATA %p\n", pmbuf);
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+		if (pmbuf->flags & MLAN_BUF_FLAG_SG) {
+			/* Scatter-gather AMSDU owns its source MSDUs */
+			arena = (amsdu_sg_arena *)pmbuf->pfrag;
+			for (i = 0; i < arena->num_msdu; i++) {
+				wlan_tx_lat_copy_back(pmbuf, arena->msdu[i]);
+				wlan_write_data_complete(pmadapter,
+							 arena->msdu[i],
+							 status);
+			}
+		}
+#endif
 		if (pmbuf->flags & MLAN_BUF_FLAG_MOAL_TX_BUF) {
 			/* pmbuf was allocated by MOAL */
 			pcb->moal_send_packet_complete(pmadapter->pmoal_handle,
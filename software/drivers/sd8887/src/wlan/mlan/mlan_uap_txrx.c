@@ -142,6 +142,66 @@ wlan_check_unicast_packet(mlan_private *priv, t_u8 *mac)
 	return ret;
 }
 
+/**
+ *  @brief This function queues a received packet for transmission
+ *          back into the BSS
+ *
+ *  The buffer is sent as is, wlan_ops_uap_process_txpd() writes the
+ *  UapTxPD into the headroom in front of the payload.  Only a buffer
+ *  without room for the UapTxPD is copied into a new one.
+ *
+ *  @param priv      A pointer to mlan_private
+ *  @param pmbuf     A pointer to mlan_buffer, data_offset at the 802.3 header
+ *
+ *  @return          N/A
+ */
+static t_void
+wlan_uap_queue_bridge_pkt(mlan_private *priv, pmlan_buffer pmbuf)
+{
+	pmlan_adapter pmadapter = priv->adapter;
+	pmlan_buffer newbuf = MNULL;
+	t_u32 headroom = sizeof(UapTxPD) + priv->intf_hr_len + DMA_ALIGNMENT;
+
+	ENTER();
+
+	if (pmbuf->data_offset < headroom) {
+		newbuf = wlan_alloc_mlan_buffer(pmadapter,
+						MLAN_TX_DATA_BUF_SIZE_2K, 0,
+						MOAL_MALLOC_BUFFER);
+		if (!newbuf) {
+			wlan_free_mlan_buffer(pmadapter, pmbuf);
+			LEAVE();
+			return;
+		}
+		newbuf->bss_index = pmbuf->bss_index;
+		newbuf->buf_type = pmbuf->buf_type;
+		newbuf->priority = pmbuf->priority;
+		newbuf->in_ts_sec = pmbuf->in_ts_sec;
+		newbuf->in_ts_usec = pmbuf->in_ts_usec;
+		newbuf->data_offset = headroom;
+		memcpy(pmadapter, newbuf->pbuf + newbuf->data_offset,
+		       pmbuf->pbuf + pmbuf->data_offset, pmbuf->data_len);
+		newbuf->data_len = pmbuf->data_len;
+		wlan_free_mlan_buffer(pmadapter, pmbuf);
+		pmbuf = newbuf;
+	}
+	pmbuf->pparent = MNULL;
+	pmbuf->flags |= MLAN_BUF_FLAG_BRIDGE_BUF;
+	util_scalar_increment(pmadapter->pmoal_handle,
+			      &pmadapter->pending_bridge_pkts,
+			      pmadapter->callbacks.moal_spin_lock,
+			      pmadapter->callbacks.moal_spin_unlock);
+	wlan_wmm_add_buf_txqueue(pmadapter, pmbuf);
+	if (util_scalar_read(pmadapter->pmoal_handle,
+			     &pmadapter->pending_bridge_pkts,
+			     pmadapter->callbacks.moal_spin_lock,
+			     pmadapter->callbacks.moal_spin_unlock) >
+	    RX_HIGH_THRESHOLD)
+		wlan_drop_tx_pkts(priv);
+	wlan_recv_event(priv, MLAN_EVENT_ID_DRV_DEFER_HANDLING, MNULL);
+	LEAVE();
+}
+
 /********************************************************
 			Global Functions
 ********************************************************/
@@ -405,7 +465,6 @@ wlan_uap_recv_packet(IN mlan_private *priv, IN pmlan_buffer pmbuf)
 	pmlan_adapter pmadapter = priv->adapter;
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 	RxPacketHdr_t *prx_pkt;
-	pmlan_buffer newbuf = MNULL;
 
 	ENTER();
 
@@ -424,98 +483,25 @@ wlan_uap_recv_packet(IN mlan_private *priv, IN pmlan_buffer pmbuf)
 
 	if (prx_pkt->eth803_hdr.dest_addr[0] & 0x01) {
 		if (!(priv->pkt_fwd & PKT_FWD_INTRA_BCAST)) {
-			/* Multicast pkt */
-			newbuf = wlan_alloc_mlan_buffer(pmadapter,
-							MLAN_TX_DATA_BUF_SIZE_2K,
-							0, MOAL_MALLOC_BUFFER);
-			if (newbuf) {
-				newbuf->bss_index = pmbuf->bss_index;
-				newbuf->buf_type = pmbuf->buf_type;
-				newbuf->priority = pmbuf->priority;
-				newbuf->in_ts_sec = pmbuf->in_ts_sec;
-				newbuf->in_ts_usec = pmbuf->in_ts_usec;
-				newbuf->data_offset =
-					(sizeof(UapTxPD) + priv->intf_hr_len +
-					 DMA_ALIGNMENT);
-				util_scalar_increment(pmadapter->pmoal_handle,
-						      &pmadapter->
-						      pending_bridge_pkts,
-						      pmadapter->callbacks.
-						      moal_spin_lock,
-						      pmadapter->callbacks.
-						      moal_spin_unlock);
-
-				newbuf->flags |= MLAN_BUF_FLAG_BRIDGE_BUF;
-
-				/* copy the data */
-				memcpy(pmadapter,
-				       (t_u8 *)newbuf->pbuf +
-				       newbuf->data_offset,
-				       pmbuf->pbuf + pmbuf->data_offset,
-				       pmbuf->data_len);
-				newbuf->data_len = pmbuf->data_len;
-				wlan_wmm_add_buf_txqueue(pmadapter, newbuf);
-				if (util_scalar_read(pmadapter->pmoal_handle,
-						     &pmadapter->
-						     pending_bridge_pkts,
-						     pmadapter->callbacks.
-						     moal_spin_lock,
-						     pmadapter->callbacks.
-						     moal_spin_unlock) >
-				    RX_HIGH_THRESHOLD)
-					wlan_drop_tx_pkts(priv);
-				wlan_recv_event(priv,
-						MLAN_EVENT_ID_DRV_DEFER_HANDLING,
-						MNULL);
+			/* Multicast pkt, upload a clone and forward the buffer */
+			pmbuf->flags |= MLAN_BUF_FLAG_RX_SHARED;
+			ret = pmadapter->callbacks.moal_recv_packet(pmadapter->
+								    pmoal_handle,
+								    pmbuf);
+			pmbuf->flags &= ~MLAN_BUF_FLAG_RX_SHARED;
+			if (ret != MLAN_STATUS_PENDING) {
+				wlan_uap_queue_bridge_pkt(priv, pmbuf);
+				ret = MLAN_STATUS_PENDING;
 			}
+			goto done;
 		}
 	} else {
 		if ((!(priv->pkt_fwd & PKT_FWD_INTRA_UCAST)) &&
 		    (wlan_get_station_entry
 		     (priv, prx_pkt->eth803_hdr.dest_addr))) {
 			/* Intra BSS packet */
-			newbuf = wlan_alloc_mlan_buffer(pmadapter,
-							MLAN_TX_DATA_BUF_SIZE_2K,
-							0, MOAL_MALLOC_BUFFER);
-			if (newbuf) {
-				newbuf->bss_index = pmbuf->bss_index;
-				newbuf->buf_type = pmbuf->buf_type;
-				newbuf->priority = pmbuf->priority;
-				newbuf->in_ts_sec = pmbuf->in_ts_sec;
-				newbuf->in_ts_usec = pmbuf->in_ts_usec;
-				newbuf->data_offset =
-					(sizeof(UapTxPD) + priv->intf_hr_len +
-					 DMA_ALIGNMENT);
-				util_scalar_increment(pmadapter->pmoal_handle,
-						      &pmadapter->
-						      pending_bridge_pkts,
-						      pmadapter->callbacks.
-						      moal_spin_lock,
-						      pmadapter->callbacks.
-						      moal_spin_unlock);
-				newbuf->flags |= MLAN_BUF_FLAG_BRIDGE_BUF;
-
-				/* copy the data */
-				memcpy(pmadapter,
-				       (t_u8 *)newbuf->pbuf +
-				       newbuf->data_offset,
-				       pmbuf->pbuf + pmbuf->data_offset,
-				       pmbuf->data_len);
-				newbuf->data_len = pmbuf->data_len;
-				wlan_wmm_add_buf_txqueue(pmadapter, newbuf);
-				if (util_scalar_read(pmadapter->pmoal_handle,
-						     &pmadapter->
-						     pending_bridge_pkts,
-						     pmadapter->callbacks.
-						     moal_spin_lock,
-						     pmadapter->callbacks.
-						     moal_spin_unlock) >
-				    RX_HIGH_THRESHOLD)
-					wlan_drop_tx_pkts(priv);
-				wlan_recv_event(priv,
-						MLAN_EVENT_ID_DRV_DEFER_HANDLING,
-						MNULL);
-			}
+			wlan_uap_queue_bridge_pkt(priv, pmbuf);
+			ret = MLAN_STATUS_PENDING;
 			goto done;
 		} else if (MLAN_STATUS_FAILURE ==
 			   wlan_check_unicast_packet(priv,
@@ -552,7 +538,7 @@ wlan_process_uap_rx_packet(IN mlan_private *priv, IN pmlan_buffer pmbuf)
 	mlan_status ret = MLAN_STATUS_SUCCESS;
 	UapRxPD *prx_pd;
 	RxPacketHdr_t *prx_pkt;
-	pmlan_buffer newbuf = MNULL;
+	t_u8 fwd_bcast = MFALSE;
 
 	ENTER();
 
@@ -580,51 +566,9 @@ wlan_process_uap_rx_packet(IN mlan_private *priv, IN pmlan_buffer pmbuf)
 
 	if (prx_pkt->eth803_hdr.dest_addr[0] & 0x01) {
 		if (!(priv->pkt_fwd & PKT_FWD_INTRA_BCAST)) {
-			/* Multicast pkt */
-			newbuf = wlan_alloc_mlan_buffer(pmadapter,
-							MLAN_TX_DATA_BUF_SIZE_2K,
-							0, MOAL_MALLOC_BUFFER);
-			if (newbuf) {
-				newbuf->bss_index = pmbuf->bss_index;
-				newbuf->buf_type = pmbuf->buf_type;
-				newbuf->priority = pmbuf->priority;
-				newbuf->in_ts_sec = pmbuf->in_ts_sec;
-				newbuf->in_ts_usec = pmbuf->in_ts_usec;
-				newbuf->data_offset =
-					(sizeof(UapTxPD) + priv->intf_hr_len +
-					 DMA_ALIGNMENT);
-				util_scalar_increment(pmadapter->pmoal_handle,
-						      &pmadapter->
-						      pending_bridge_pkts,
-						      pmadapter->callbacks.
-						      moal_spin_lock,
-						      pmadapter->callbacks.
-						      moal_spin_unlock);
-				newbuf->flags |= MLAN_BUF_FLAG_BRIDGE_BUF;
-
-				/* copy the data, skip rxpd */
-				memcpy(pmadapter,
-				       (t_u8 *)newbuf->pbuf +
-				       newbuf->data_offset,
-				       pmbuf->pbuf + pmbuf->data_offset +
-				       prx_pd->rx_pkt_offset,
-				       pmbuf->data_len - prx_pd->rx_pkt_offset);
-				newbuf->data_len =
-					pmbuf->data_len - prx_pd->rx_pkt_offset;
-				wlan_wmm_add_buf_txqueue(pmadapter, newbuf);
-				if (util_scalar_read(pmadapter->pmoal_handle,
-						     &pmadapter->
-						     pending_bridge_pkts,
-						     pmadapter->callbacks.
-						     moal_spin_lock,
-						     pmadapter->callbacks.
-						     moal_spin_unlock) >
-				    RX_HIGH_THRESHOLD)
-					wlan_drop_tx_pkts(priv);
-				wlan_recv_event(priv,
-						MLAN_EVENT_ID_DRV_DEFER_HANDLING,
-						MNULL);
-			}
+			/* Multicast pkt, upload a clone and forward the buffer */
+			fwd_bcast = MTRUE;
+			pmbuf->flags |= MLAN_BUF_FLAG_RX_SHARED;
 		}
 	} else {
 		if ((!(priv->pkt_fwd & PKT_FWD_INTRA_UCAST)) &&
@@ -633,24 +577,7 @@ wlan_process_uap_rx_packet(IN mlan_private *priv, IN pmlan_buffer pmbuf)
 			/* Forwarding Intra-BSS packet */
 			pmbuf->data_len -= prx_pd->rx_pkt_offset;
 			pmbuf->data_offset += prx_pd->rx_pkt_offset;
-			pmbuf->flags |= MLAN_BUF_FLAG_BRIDGE_BUF;
-			util_scalar_increment(pmadapter->pmoal_handle,
-					      &pmadapter->pending_bridge_pkts,
-					      pmadapter->callbacks.
-					      moal_spin_lock,
-					      pmadapter->callbacks.
-					      moal_spin_unlock);
-			wlan_wmm_add_buf_txqueue(pmadapter, pmbuf);
-			if (util_scalar_read(pmadapter->pmoal_handle,
-					     &pmadapter->pending_bridge_pkts,
-					     pmadapter->callbacks.
-					     moal_spin_lock,
-					     pmadapter->callbacks.
-					     moal_spin_unlock) >
-			    RX_HIGH_THRESHOLD)
-				wlan_drop_tx_pkts(priv);
-			wlan_recv_event(priv, MLAN_EVENT_ID_DRV_DEFER_HANDLING,
-					MNULL);
+			wlan_uap_queue_bridge_pkt(priv, pmbuf);
 			goto done;
 		} else if (MLAN_STATUS_FAILURE ==
 			   wlan_check_unicast_packet(priv,
@@ -685,7 +612,12 @@ upload:
 		pmbuf->status_code = MLAN_ERROR_PKT_INVALID;
 	}
 
-	if (ret != MLAN_STATUS_PENDING)
+	if (fwd_bcast && ret != MLAN_STATUS_PENDING) {
+		/* The buffer is still ours, send it back into the BSS */
+		pmbuf->flags &= ~MLAN_BUF_FLAG_RX_SHARED;
+		pmbuf->status_code = MLAN_ERROR_NO_ERROR;
+		wlan_uap_queue_bridge_pkt(priv, pmbuf);
+	} else if (ret != MLAN_STATUS_PENDING)
 		wlan_free_mlan_buffer(pmadapter, pmbuf);
 done:
 	LEAVE();
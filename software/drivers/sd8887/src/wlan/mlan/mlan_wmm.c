@@ -35,6 +35,7 @@ Change log:
 #include "mlan_wmm.h"
 #include "mlan_11n.h"
 #include "mlan_sdio.h"
+#include "mlan_trace.h"
 
 /********************************************************
 			Local Variables
@@ -43,6 +44,9 @@ Change log:
 /** Maximum value FW can accept for driver delay in packet transmission */
 #define DRV_PKT_DELAY_TO_FW_MAX   512
 
+/** Maximum number of packets dequeued per ra_list_spinlock hold */
+#define WMM_TX_BATCH_MAX          SDIO_MP_AGGR_DEF_PKT_LIMIT
+
 /*
  * Upper and Lower threshold for packet queuing in the driver
 
@@ -214,12 +218,105 @@ wlan_wmm_allocate_ralist_node(pmlan_adapter pmadapter, t_u8 *ra)
 	ra_list->del_ba_count = 0;
 	ra_list->total_pkts = 0;
 	ra_list->tx_pause = 0;
+	ra_list->codel_first_above = 0;
+	ra_list->codel_drop_next = 0;
+	ra_list->codel_count = 0;
+	ra_list->codel_lastcount = 0;
+	ra_list->codel_dropping = MFALSE;
 	PRINTM(MINFO, "RAList: Allocating buffers for TID %p\n", ra_list);
 done:
 	LEAVE();
 	return ra_list;
 }
 
+/**
+ *  @brief Remove a RA list from the peer index
+ *
+ *  If another RA list of the same TID carries the same RA, the peer
+ *  is rebound to it; otherwise the peer node is released when unused.
+ *
+ *  @param priv        Pointer to the mlan_private driver data struct
+ *  @param tid         TID
+ *  @param ra_list     Pointer to raListTbl
+ *
+ *  @return         N/A
+ */
+static void
+wlan_wmm_unindex_ralist(pmlan_private priv, int tid, raListTbl *ra_list)
+{
+	peer_node *peer;
+	raListTbl *rlist;
+
+	ENTER();
+	peer = wlan_get_peer_node(priv, ra_list->ra);
+	if (!peer) {
+		LEAVE();
+		return;
+	}
+	if (peer->ra_list[tid] == ra_list) {
+		peer->ra_list[tid] = MNULL;
+		rlist = (raListTbl *)util_peek_list(priv->adapter->pmoal_handle,
+						    &priv->wmm.tid_tbl_ptr[tid].
+						    ra_list, MNULL, MNULL);
+		while (rlist && (rlist != (raListTbl *)
+				 &priv->wmm.tid_tbl_ptr[tid].ra_list)) {
+			if (rlist != ra_list &&
+			    !memcmp(priv->adapter, rlist->ra, ra_list->ra,
+				    MLAN_MAC_ADDR_LENGTH)) {
+				peer->ra_list[tid] = rlist;
+				break;
+			}
+			rlist = rlist->pnext;
+		}
+	}
+	wlan_release_peer_node(priv, peer);
+	LEAVE();
+}
+
+/**
+ *  @brief Rebuild the priority bitmap of sendable packets
+ *
+ *  @param priv        Pointer to the mlan_private driver data struct
+ *
+ *  @return         N/A
+ */
+static void
+wlan_wmm_recalc_prio_bitmap(pmlan_private priv)
+{
+	t_u8 tid;
+
+	priv->wmm.prio_bitmap = 0;
+	for (tid = 0; tid < MAX_NUM_TID; tid++) {
+		if (priv->wmm.pkts_queued[tid] > priv->wmm.pkts_paused[tid])
+			priv->wmm.prio_bitmap |= MBIT(tos_to_tid_inv[tid]);
+	}
+}
+
+/**
+ *  @brief Get the highest priority set in a priority bitmap
+ *
+ *  @param bitmap      Priority bitmap, must not be 0
+ *
+ *  @return         Highest priority
+ */
+static INLINE int
+wlan_wmm_highest_prio(t_u8 bitmap)
+{
+	int prio = 0;
+
+	if (bitmap & 0xf0) {
+		bitmap >>= 4;
+		prio += 4;
+	}
+	if (bitmap & 0x0c) {
+		bitmap >>= 2;
+		prio += 2;
+	}
+	if (bitmap & 0x02)
+		prio += 1;
+	return prio;
+}
+
 /**
  *  @brief Add packet to TDLS pending TX queue
  *
@@ -293,6 +390,12 @@ wlan_wmm_queue_priorities_tid(pmlan_private priv, t_u8 queue_priority[])
 	for (i = 0; i < MAX_NUM_TID; i++)
 		tos_to_tid_inv[tos_to_tid[i]] = (t_u8)i;
 
+	/* tos_to_tid_inv is shared, so every interface's bitmap is stale */
+	for (i = 0; i < priv->adapter->priv_num; i++) {
+		if (priv->adapter->priv[i])
+			wlan_wmm_recalc_prio_bitmap(priv->adapter->priv[i]);
+	}
+
 	/* in case priorities have changed, force highest priority so
 	 * next packet will check from top to re-establish the highest
 	 */
@@ -488,6 +591,7 @@ wlan_wmm_cleanup_queues(pmlan_private priv)
 		priv->wmm.pkts_queued[i] = 0;
 		priv->wmm.pkts_paused[i] = 0;
 	}
+	priv->wmm.prio_bitmap = 0;
 	util_scalar_write(priv->adapter->pmoal_handle,
 			  &priv->wmm.tx_pkts_queued, 0, MNULL, MNULL);
 	util_scalar_write(priv->adapter->pmoal_handle,
@@ -508,11 +612,23 @@ static void
 wlan_wmm_delete_all_ralist(pmlan_private priv)
 {
 	raListTbl *ra_list;
+	peer_node *peer, *peer_next;
 	int i;
 	pmlan_adapter pmadapter = priv->adapter;
 
 	ENTER();
 
+	for (i = 0; i < MLAN_PEER_HASH_SIZE; ++i) {
+		peer = priv->peer_hash[i];
+		while (peer) {
+			peer_next = peer->hnext;
+			memset(pmadapter, peer->ra_list, 0,
+			       sizeof(peer->ra_list));
+			wlan_release_peer_node(priv, peer);
+			peer = peer_next;
+		}
+	}
+
 	for (i = 0; i < MAX_NUM_TID; ++i) {
 		PRINTM(MINFO, "RAList: Freeing buffers for TID %d\n", i);
 		while ((ra_list =
@@ -668,10 +784,11 @@ wlan_wmm_get_highest_priolist_ptr(pmlan_adapter pmadapter,
 	tid_tbl_t *tid_ptr;
 	int i, j;
 	int next_prio = 0;
-	int next_tid = 0;
-	ENTER();
+	int start_prio;
+	t_u8 prio_mask;
+	HOT_ENTER();
 
-	PRINTM(MDAT_D, "POP\n");
+	HOT_PRINTM(MDAT_D, "POP\n");
 	for (j = pmadapter->priv_num - 1; j >= 0; --j) {
 		if (!(util_peek_list(pmadapter->pmoal_handle,
 				     &pmadapter->bssprio_tbl[j].bssprio_head,
@@ -693,30 +810,42 @@ wlan_wmm_get_highest_priolist_ptr(pmlan_adapter pmadapter,
 
 			if ((priv_tmp->port_ctrl_mode == MTRUE)
 			    && (priv_tmp->port_open == MFALSE)) {
-				PRINTM(MINFO, "get_highest_prio_ptr(): "
-				       "PORT_CLOSED Ignore pkts from BSS%d\n",
-				       priv_tmp->bss_index);
+				HOT_PRINTM(MINFO, "get_highest_prio_ptr(): "
+					   "PORT_CLOSED Ignore pkts from BSS%d\n",
+					   priv_tmp->bss_index);
 				/* Ignore data pkts from a BSS if port is closed */
 				goto next_intf;
 			}
 			if (priv_tmp->tx_pause == MTRUE) {
-				PRINTM(MINFO, "get_highest_prio_ptr(): "
-				       "TX PASUE Ignore pkts from BSS%d\n",
-				       priv_tmp->bss_index);
+				HOT_PRINTM(MINFO, "get_highest_prio_ptr(): "
+					   "TX PASUE Ignore pkts from BSS%d\n",
+					   priv_tmp->bss_index);
 				/* Ignore data pkts from a BSS if tx pause */
 				goto next_intf;
 			}
+			/* Nothing sendable on this BSS, skip it without
+			 * taking its ra_list_spinlock */
+			if (!priv_tmp->wmm.prio_bitmap)
+				goto next_intf;
 
 			pmadapter->callbacks.moal_spin_lock(pmadapter->
 							    pmoal_handle,
 							    priv_tmp->wmm.
 							    ra_list_spinlock);
 
-			for (i = util_scalar_read(pmadapter->pmoal_handle,
-						  &priv_tmp->wmm.
-						  highest_queued_prio, MNULL,
-						  MNULL); i >= LOW_PRIO_TID;
-			     --i) {
+			start_prio = util_scalar_read(pmadapter->pmoal_handle,
+						      &priv_tmp->wmm.
+						      highest_queued_prio,
+						      MNULL, MNULL);
+			if (start_prio >= LOW_PRIO_TID)
+				prio_mask = priv_tmp->wmm.prio_bitmap &
+					(t_u8)(MBIT(start_prio + 1) - 1);
+			else
+				prio_mask = 0;
+
+			while (prio_mask) {
+				i = wlan_wmm_highest_prio(prio_mask);
+				prio_mask &= ~MBIT(i);
 
 				tid_ptr =
 					&(priv_tmp)->wmm.
@@ -743,18 +872,9 @@ wlan_wmm_get_highest_priolist_ptr(pmlan_adapter pmadapter,
 							   MNULL, MNULL)) {
 						/* Because WMM only support BK/BE/VI/VO, we have 8 tid
 						 * We should balance the traffic of the same AC */
-						if (i % 2)
-							next_prio = i - 1;
-						else
-							next_prio = i + 1;
-						next_tid =
-							tos_to_tid[next_prio];
-						if (priv_tmp->wmm.
-						    pkts_queued[next_tid] &&
-						    (priv_tmp->wmm.
-						     pkts_queued[next_tid] >
-						     priv_tmp->wmm.
-						     pkts_paused[next_tid]))
+						next_prio = i ^ 1;
+						if (priv_tmp->wmm.prio_bitmap &
+						    MBIT(next_prio))
 							util_scalar_write
 								(pmadapter->
 								 pmoal_handle,
@@ -775,10 +895,13 @@ wlan_wmm_get_highest_priolist_ptr(pmlan_adapter pmadapter,
 						*priv = priv_tmp;
 						*tid = tos_to_tid[i];
 						/* hold priv->ra_list_spinlock to maintain ptr */
-						PRINTM(MDAT_D,
-						       "get highest prio ptr %p, tid %d\n",
-						       ptr, *tid);
-						LEAVE();
+						HOT_PRINTM(MDAT_D,
+							   "get highest prio ptr %p, tid %d\n",
+							   ptr, *tid);
+						MTRACE(MTRACE_TX_DEQUEUE,
+						       priv_tmp->bss_index,
+						       *tid, ptr->total_pkts);
+						HOT_LEAVE();
 						return ptr;
 					}
 
@@ -820,7 +943,7 @@ next_intf:
 		} while (bssprio_node != bssprio_head);
 	}
 
-	LEAVE();
+	HOT_LEAVE();
 	return MNULL;
 }
 
@@ -856,7 +979,30 @@ wlan_num_pkts_in_txq(mlan_private *priv, raListTbl *ptr, int max_buf_size)
 }
 
 /**
- *  @brief This function sends a single packet
+ *  @brief This function gets the number of packets which can be drained
+ *         from one RA list in a single batch
+ *
+ *  @param pmadapter    A pointer to mlan_adapter
+ *
+ *  @return             Batch budget, at least 1
+ */
+static INLINE t_u32
+wlan_wmm_tx_batch_budget(pmlan_adapter pmadapter)
+{
+	t_u32 budget;
+
+	budget = bitcount(pmadapter->mp_wr_bitmap &
+			  pmadapter->mp_data_port_mask);
+	if (budget > WMM_TX_BATCH_MAX)
+		budget = WMM_TX_BATCH_MAX;
+	if (!budget)
+		budget = 1;
+	return budget;
+}
+
+/**
+ *  @brief This function dequeues a batch of packets from one RA list
+ *         under a single ra_list_spinlock hold and sends them
  *
  *  @param priv         A pointer to mlan_private
  *  @param ptr          A pointer to RA list table
@@ -865,96 +1011,109 @@ wlan_num_pkts_in_txq(mlan_private *priv, raListTbl *ptr, int max_buf_size)
  *  @return             N/A
  */
 static INLINE void
-wlan_send_single_packet(pmlan_private priv, raListTbl *ptr, int ptrindex)
+wlan_send_batch_packets(pmlan_private priv, raListTbl *ptr, int ptrindex)
 {
-	pmlan_buffer pmbuf;
+	pmlan_buffer batch[WMM_TX_BATCH_MAX];
 	pmlan_buffer pmbuf_next;
 	mlan_tx_param tx_param;
 	pmlan_adapter pmadapter = priv->adapter;
 	mlan_status status = MLAN_STATUS_SUCCESS;
+	t_u32 budget;
+	t_u32 count = 0;
+	t_u32 sent = 0;
+	t_u32 i;
 
 	ENTER();
 
-	pmbuf = (pmlan_buffer)util_dequeue_list(pmadapter->pmoal_handle,
-						&ptr->buf_head, MNULL, MNULL);
-	if (pmbuf) {
-		PRINTM(MINFO, "Dequeuing the packet %p %p\n", ptr, pmbuf);
-		priv->wmm.pkts_queued[ptrindex]--;
-		util_scalar_decrement(pmadapter->pmoal_handle,
-				      &priv->wmm.tx_pkts_queued, MNULL, MNULL);
-		ptr->total_pkts--;
-		pmbuf_next =
-			(pmlan_buffer)util_peek_list(pmadapter->pmoal_handle,
-						     &ptr->buf_head, MNULL,
-						     MNULL);
+	budget = wlan_wmm_tx_batch_budget(pmadapter);
+	while (count < budget) {
+		batch[count] =
+			(pmlan_buffer)util_dequeue_list(pmadapter->pmoal_handle,
+							&ptr->buf_head, MNULL,
+							MNULL);
+		if (!batch[count])
+			break;
+		PRINTM(MINFO, "Dequeuing the packet %p %p\n", ptr,
+		       batch[count]);
+		count++;
+	}
+	if (!count) {
 		pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
 						      priv->wmm.
 						      ra_list_spinlock);
+		PRINTM(MINFO, "Nothing to send\n");
+		LEAVE();
+		return;
+	}
+	priv->wmm.pkts_queued[ptrindex] -= count;
+	wlan_wmm_update_prio_bitmap(priv, ptrindex);
+	util_scalar_offset(pmadapter->pmoal_handle, &priv->wmm.tx_pkts_queued,
+			   -(t_s32)count, MNULL, MNULL);
+	ptr->total_pkts -= count;
+	pmbuf_next = (pmlan_buffer)util_peek_list(pmadapter->pmoal_handle,
+						  &ptr->buf_head, MNULL, MNULL);
+	pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
+					      priv->wmm.ra_list_spinlock);
+	pmadapter->dbg.num_tx_batch[count - 1]++;
 
-		tx_param.next_pkt_len = ((pmbuf_next)
-					 ? pmbuf_next->data_len +
-					 sizeof(TxPD) : 0);
-		status = wlan_process_tx(priv, pmbuf, &tx_param);
-
+	for (i = 0; i < count; i++) {
+		if (i && (pmadapter->data_sent || pmadapter->tx_lock_flag)) {
+			status = MLAN_STATUS_RESOURCE;
+			break;
+		}
+		if (i + 1 < count)
+			tx_param.next_pkt_len =
+				batch[i + 1]->data_len + sizeof(TxPD);
+		else
+			tx_param.next_pkt_len = ((pmbuf_next)
+						 ? pmbuf_next->data_len +
+						 sizeof(TxPD) : 0);
+		status = wlan_process_tx(priv, batch[i], &tx_param);
 		if (status == MLAN_STATUS_RESOURCE) {
-	    /** Queue the packet back at the head */
-			PRINTM(MDAT_D, "Queuing pkt back to raList %p %p\n",
-			       ptr, pmbuf);
-			pmadapter->callbacks.moal_spin_lock(pmadapter->
-							    pmoal_handle,
-							    priv->wmm.
-							    ra_list_spinlock);
-
-			if (!wlan_is_ralist_valid(priv, ptr, ptrindex)) {
-				pmadapter->callbacks.
-					moal_spin_unlock(pmadapter->
-							 pmoal_handle,
-							 priv->wmm.
-							 ra_list_spinlock);
-				wlan_write_data_complete(pmadapter, pmbuf,
-							 MLAN_STATUS_FAILURE);
-				LEAVE();
-				return;
-			}
-			priv->wmm.pkts_queued[ptrindex]++;
-			util_scalar_increment(pmadapter->pmoal_handle,
-					      &priv->wmm.tx_pkts_queued, MNULL,
-					      MNULL);
-			util_enqueue_list_head(pmadapter->pmoal_handle,
-					       &ptr->buf_head,
-					       (pmlan_linked_list)pmbuf, MNULL,
-					       MNULL);
-
-			ptr->total_pkts++;
-			pmbuf->flags |= MLAN_BUF_FLAG_REQUEUED_PKT;
-			pmadapter->callbacks.moal_spin_unlock(pmadapter->
-							      pmoal_handle,
-							      priv->wmm.
-							      ra_list_spinlock);
-		} else {
-			pmadapter->callbacks.moal_spin_lock(pmadapter->
-							    pmoal_handle,
-							    priv->wmm.
-							    ra_list_spinlock);
-			if (wlan_is_ralist_valid(priv, ptr, ptrindex)) {
-				priv->wmm.packets_out[ptrindex]++;
-				priv->wmm.tid_tbl_ptr[ptrindex].ra_list_curr =
-					ptr;
-			}
-			pmadapter->bssprio_tbl[priv->bss_priority].bssprio_cur =
-				pmadapter->bssprio_tbl[priv->bss_priority].
-				bssprio_cur->pnext;
-			pmadapter->callbacks.moal_spin_unlock(pmadapter->
-							      pmoal_handle,
-							      priv->wmm.
-							      ra_list_spinlock);
+			/* Processed by process_txpd, must not be redone */
+			batch[i]->flags |= MLAN_BUF_FLAG_REQUEUED_PKT;
+			break;
 		}
-	} else {
+		sent++;
+	}
+
+	pmadapter->callbacks.moal_spin_lock(pmadapter->pmoal_handle,
+					    priv->wmm.ra_list_spinlock);
+	if (!wlan_is_ralist_valid(priv, ptr, ptrindex)) {
 		pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
 						      priv->wmm.
 						      ra_list_spinlock);
-		PRINTM(MINFO, "Nothing to send\n");
+		for (i = sent; i < count; i++)
+			wlan_write_data_complete(pmadapter, batch[i],
+						 MLAN_STATUS_FAILURE);
+		LEAVE();
+		return;
+	}
+	if (sent < count) {
+	    /** Queue the unsent packets back at the head, in order */
+		PRINTM(MDAT_D, "Queuing %d pkts back to raList %p\n",
+		       count - sent, ptr);
+		for (i = count; i > sent; i--)
+			util_enqueue_list_head(pmadapter->pmoal_handle,
+					       &ptr->buf_head,
+					       (pmlan_linked_list)batch[i - 1],
+					       MNULL, MNULL);
+		priv->wmm.pkts_queued[ptrindex] += count - sent;
+		wlan_wmm_update_prio_bitmap(priv, ptrindex);
+		util_scalar_offset(pmadapter->pmoal_handle,
+				   &priv->wmm.tx_pkts_queued,
+				   (t_s32)(count - sent), MNULL, MNULL);
+		ptr->total_pkts += count - sent;
+	}
+	if (sent) {
+		priv->wmm.packets_out[ptrindex] += sent;
+		priv->wmm.tid_tbl_ptr[ptrindex].ra_list_curr = ptr;
+		pmadapter->bssprio_tbl[priv->bss_priority].bssprio_cur =
+			pmadapter->bssprio_tbl[priv->bss_priority].bssprio_cur->
+			pnext;
 	}
+	pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
+					      priv->wmm.ra_list_spinlock);
 
 	LEAVE();
 }
@@ -1015,7 +1174,7 @@ wlan_send_processed_packet(pmlan_private priv, raListTbl *ptr, int ptrindex)
 					     &tx_param);
 		switch (ret) {
 		case MLAN_STATUS_RESOURCE:
-			PRINTM(MINFO, "MLAN_STATUS_RESOURCE is returned\n");
+			HOT_PRINTM(MINFO, "MLAN_STATUS_RESOURCE is returned\n");
 			pmadapter->callbacks.moal_spin_lock(pmadapter->
 							    pmoal_handle,
 							    priv->wmm.
@@ -1029,7 +1188,7 @@ wlan_send_processed_packet(pmlan_private priv, raListTbl *ptr, int ptrindex)
 							 ra_list_spinlock);
 				wlan_write_data_complete(pmadapter, pmbuf,
 							 MLAN_STATUS_FAILURE);
-				LEAVE();
+				HOT_LEAVE();
 				return;
 			}
 			util_enqueue_list_head(pmadapter->pmoal_handle,
@@ -1077,6 +1236,7 @@ wlan_send_processed_packet(pmlan_private priv, raListTbl *ptr, int ptrindex)
 				pmadapter->bssprio_tbl[priv->bss_priority].
 				bssprio_cur->pnext;
 			priv->wmm.pkts_queued[ptrindex]--;
+			wlan_wmm_update_prio_bitmap(priv, ptrindex);
 			util_scalar_decrement(pmadapter->pmoal_handle,
 					      &priv->wmm.tx_pkts_queued,
 					      MNULL, MNULL);
@@ -1092,6 +1252,324 @@ wlan_send_processed_packet(pmlan_private priv, raListTbl *ptr, int ptrindex)
 	}
 }
 
+/**
+ *  @brief Integer square root, for the CoDel control law
+ *
+ *  @param val      Value
+ *
+ *  @return         Square root of val, rounded down
+ */
+static t_u32
+wlan_aqm_sqrt(t_u32 val)
+{
+	t_u32 res = 0;
+	t_u32 bit = MBIT(30);
+
+	while (bit > val)
+		bit >>= 2;
+	while (bit) {
+		if (val >= res + bit) {
+			val -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+	return res;
+}
+
+/**
+ *  @brief Get the AQM clock, microseconds modulo 2^32
+ *
+ *  @param pmadapter    A pointer to mlan_adapter
+ *
+ *  @return             Current time in microseconds
+ */
+static INLINE t_u32
+wlan_aqm_time(pmlan_adapter pmadapter)
+{
+	t_u32 sec, usec;
+
+	pmadapter->callbacks.moal_get_system_time(pmadapter->pmoal_handle,
+						  &sec, &usec);
+	return sec * 1000000 + usec;
+}
+
+/** Read 4 bytes of packet data for flow hashing, byte order does not matter */
+#define wlan_aqm_get32(pos) \
+	(((t_u32)(pos)[0] << 24) | ((t_u32)(pos)[1] << 16) | \
+	 ((t_u32)(pos)[2] << 8) | (t_u32)(pos)[3])
+
+/**
+ *  @brief Hash the flow of a queued packet into one of WMM_AQM_FLOWS
+ *         buckets
+ *
+ *  IPv4 and IPv6 packets are hashed on addresses, protocol and, for TCP
+ *  and UDP, ports; other packets are hashed on the ethernet type.
+ *
+ *  @param pmbuf        A pointer to mlan_buffer
+ *
+ *  @return             Flow bucket
+ */
+static t_u32
+wlan_aqm_flow_hash(pmlan_buffer pmbuf)
+{
+	t_u8 *pos = pmbuf->pbuf + pmbuf->data_offset;
+	t_u32 len = pmbuf->data_len;
+	t_u32 hash;
+	t_u32 hdr_len = 0;
+	t_u16 eth_type;
+	t_u8 proto = 0;
+	int i;
+
+	if (len < MLAN_ETHER_PKT_TYPE_OFFSET + 2)
+		return 0;
+	eth_type = (pos[MLAN_ETHER_PKT_TYPE_OFFSET] << 8) |
+		pos[MLAN_ETHER_PKT_TYPE_OFFSET + 1];
+	pos += MLAN_ETHER_PKT_TYPE_OFFSET + 2;
+	len -= MLAN_ETHER_PKT_TYPE_OFFSET + 2;
+	hash = eth_type;
+	if (eth_type == MLAN_ETHER_PKT_TYPE_IPV4 && len >= 20) {
+		proto = pos[9];
+		hash ^= wlan_aqm_get32(pos + 12) ^ wlan_aqm_get32(pos + 16);
+		/* Only the first fragment carries the ports */
+		if (!(pos[6] & 0x1f) && !pos[7])
+			hdr_len = (pos[0] & 0x0f) << 2;
+	} else if (eth_type == MLAN_ETHER_PKT_TYPE_IPV6 && len >= 40) {
+		proto = pos[6];
+		for (i = 8; i < 40; i += 4)
+			hash ^= wlan_aqm_get32(pos + i);
+		hdr_len = 40;
+	}
+	hash ^= proto;
+	if ((proto == 6 || proto == 17) && hdr_len >= 20 && len >= hdr_len + 4)
+		hash ^= wlan_aqm_get32(pos + hdr_len);
+	return (hash * 0x9e3779b1) >> (32 - WMM_AQM_FLOW_BITS);
+}
+
+/**
+ *  @brief Set CE on an ECN capable IPv4 or IPv6 packet
+ *
+ *  A packet that already carries CE cannot be marked again.
+ *
+ *  @param pmbuf        A pointer to mlan_buffer
+ *
+ *  @return             MTRUE if CE was newly set, otherwise MFALSE
+ */
+static t_u8
+wlan_aqm_set_ce(pmlan_buffer pmbuf)
+{
+	t_u8 *pos = pmbuf->pbuf + pmbuf->data_offset;
+	t_u32 len = pmbuf->data_len;
+	t_u32 sum;
+	t_u16 eth_type;
+	t_u16 old_word;
+
+	/* Forwarded packets may share data with the copy sent up the stack */
+	if (pmbuf->flags & MLAN_BUF_FLAG_BRIDGE_BUF)
+		return MFALSE;
+	if (len < MLAN_ETHER_PKT_TYPE_OFFSET + 2 + 20)
+		return MFALSE;
+	eth_type = (pos[MLAN_ETHER_PKT_TYPE_OFFSET] << 8) |
+		pos[MLAN_ETHER_PKT_TYPE_OFFSET + 1];
+	pos += MLAN_ETHER_PKT_TYPE_OFFSET + 2;
+	len -= MLAN_ETHER_PKT_TYPE_OFFSET + 2;
+	if (eth_type == MLAN_ETHER_PKT_TYPE_IPV4 && (pos[0] >> 4) == 4) {
+		if (!(pos[1] & 0x03))
+			return MFALSE;
+		if ((pos[1] & 0x03) == 0x03)
+			return MFALSE;
+		old_word = (pos[0] << 8) | pos[1];
+		pos[1] |= 0x03;
+		/* Incremental header checksum update, RFC 1624 */
+		sum = (~((pos[10] << 8) | pos[11]) & 0xffff) +
+			(~old_word & 0xffff) + ((pos[0] << 8) | pos[1]);
+		sum = (sum & 0xffff) + (sum >> 16);
+		sum = (sum & 0xffff) + (sum >> 16);
+		sum = ~sum;
+		pos[10] = (t_u8)(sum >> 8);
+		pos[11] = (t_u8)sum;
+		return MTRUE;
+	}
+	if (eth_type == MLAN_ETHER_PKT_TYPE_IPV6 && len >= 40 &&
+	    (pos[0] >> 4) == 6) {
+		if (!(pos[1] & 0x30) || (pos[1] & 0x30) == 0x30)
+			return MFALSE;
+		pos[1] |= 0x30;
+		return MTRUE;
+	}
+	return MFALSE;
+}
+
+/**
+ *  @brief Check whether CoDel should drop at the head of an RA list
+ *
+ *  @param ptr          A pointer to RA list table
+ *  @param aqm          A pointer to the AQM state of the RA list's AC
+ *  @param pmbuf        Head packet of the RA list
+ *  @param now          Current AQM time
+ *
+ *  @return             MTRUE if the sojourn time has stayed above target
+ *                      for an interval, otherwise MFALSE
+ */
+static t_u8
+wlan_aqm_should_drop(raListTbl *ptr, wmm_aqm_t *aqm, pmlan_buffer pmbuf,
+		     t_u32 now)
+{
+	t_u32 sojourn;
+
+	sojourn = now - (pmbuf->in_ts_sec * 1000000 + pmbuf->in_ts_usec);
+	/* Never drop the last packet, the queue is draining on its own */
+	if ((t_s32)sojourn < (t_s32)aqm->target || ptr->total_pkts <= 1) {
+		ptr->codel_first_above = 0;
+		return MFALSE;
+	}
+	if (!ptr->codel_first_above) {
+		ptr->codel_first_above = (now + aqm->interval) | 1;
+		return MFALSE;
+	}
+	return (t_s32)(now - ptr->codel_first_above) >= 0;
+}
+
+/**
+ *  @brief Drop or mark one packet of an RA list for CoDel
+ *
+ *  In MLAN_WMM_AQM_FQ_CODEL mode the packet is the oldest one of the
+ *  flow with the most bytes queued, so sparse flows sharing the RA list
+ *  keep their packets; otherwise it is the head packet. A packet that
+ *  cannot be marked, including one already carrying CE, is dropped: it is
+ *  unlinked and chained through pnext onto *ppdrop.
+ *
+ *  @param priv         A pointer to mlan_private
+ *  @param ptr          A pointer to RA list table
+ *  @param ptrindex     ptr's TID index
+ *  @param aqm          A pointer to the AQM state of the RA list's AC
+ *  @param ppdrop       A pointer to the list of dropped packets
+ *
+ *  @return             MTRUE if the packet was marked, MFALSE if dropped
+ */
+static t_u8
+wlan_aqm_drop(pmlan_private priv, raListTbl *ptr, int ptrindex,
+	      wmm_aqm_t *aqm, pmlan_buffer *ppdrop)
+{
+	pmlan_adapter pmadapter = priv->adapter;
+	pmlan_buffer pmbuf;
+	pmlan_buffer victim;
+	pmlan_buffer first[WMM_AQM_FLOWS];
+	t_u32 bytes[WMM_AQM_FLOWS];
+	t_u32 flow, fat = 0;
+
+	victim = (pmlan_buffer)util_peek_list(pmadapter->pmoal_handle,
+					      &ptr->buf_head, MNULL, MNULL);
+	if (aqm->mode == MLAN_WMM_AQM_FQ_CODEL) {
+		memset(pmadapter, first, 0, sizeof(first));
+		memset(pmadapter, bytes, 0, sizeof(bytes));
+		for (pmbuf = victim; pmbuf != (pmlan_buffer)&ptr->buf_head;
+		     pmbuf = pmbuf->pnext) {
+			flow = wlan_aqm_flow_hash(pmbuf);
+			if (!first[flow])
+				first[flow] = pmbuf;
+			bytes[flow] += pmbuf->data_len;
+			if (bytes[flow] > bytes[fat])
+				fat = flow;
+		}
+		victim = first[fat];
+	}
+
+	if (aqm->ecn && wlan_aqm_set_ce(victim)) {
+		aqm->mark_cnt++;
+		return MTRUE;
+	}
+	util_unlink_list(pmadapter->pmoal_handle, &ptr->buf_head,
+			 (pmlan_linked_list)victim, MNULL, MNULL);
+	ptr->total_pkts--;
+	priv->wmm.pkts_queued[ptrindex]--;
+	wlan_wmm_update_prio_bitmap(priv, ptrindex);
+	util_scalar_decrement(pmadapter->pmoal_handle,
+			      &priv->wmm.tx_pkts_queued, MNULL, MNULL);
+	priv->num_drop_pkts++;
+	aqm->drop_cnt++;
+	victim->pnext = *ppdrop;
+	*ppdrop = victim;
+	return MFALSE;
+}
+
+/**
+ *  @brief Run CoDel on an RA list before packets are dequeued from it
+ *
+ *  Must be called with ra_list_spinlock held. The sojourn time of the
+ *  head packet is measured from the in_ts_sec/in_ts_usec stamp taken in
+ *  wlan_wmm_add_buf_txqueue. Dropped packets are returned on *ppdrop for
+ *  the caller to complete once the lock is released.
+ *
+ *  @param priv         A pointer to mlan_private
+ *  @param ptr          A pointer to RA list table
+ *  @param ptrindex     ptr's TID index
+ *  @param ppdrop       A pointer to the list of dropped packets
+ *
+ *  @return             N/A
+ */
+static void
+wlan_aqm_dequeue(pmlan_private priv, raListTbl *ptr, int ptrindex,
+		 pmlan_buffer *ppdrop)
+{
+	pmlan_adapter pmadapter = priv->adapter;
+	wmm_aqm_t *aqm;
+	pmlan_buffer pmbuf;
+	t_u32 now, delta;
+
+	aqm = &priv->wmm.aqm[wlan_wmm_convert_tos_to_ac(pmadapter, ptrindex)];
+	if (aqm->mode == MLAN_WMM_AQM_OFF)
+		return;
+	pmbuf = (pmlan_buffer)util_peek_list(pmadapter->pmoal_handle,
+					     &ptr->buf_head, MNULL, MNULL);
+	if (!pmbuf)
+		return;
+	now = wlan_aqm_time(pmadapter);
+
+	if (ptr->codel_dropping) {
+		if (!wlan_aqm_should_drop(ptr, aqm, pmbuf, now)) {
+			ptr->codel_dropping = MFALSE;
+			return;
+		}
+		while (ptr->codel_dropping &&
+		       (t_s32)(now - ptr->codel_drop_next) >= 0) {
+			ptr->codel_count++;
+			if (wlan_aqm_drop(priv, ptr, ptrindex, aqm, ppdrop)) {
+				ptr->codel_drop_next +=
+					aqm->interval /
+					wlan_aqm_sqrt(ptr->codel_count);
+				return;
+			}
+			pmbuf = (pmlan_buffer)util_peek_list(pmadapter->
+							     pmoal_handle,
+							     &ptr->buf_head,
+							     MNULL, MNULL);
+			if (!wlan_aqm_should_drop(ptr, aqm, pmbuf, now))
+				ptr->codel_dropping = MFALSE;
+			else
+				ptr->codel_drop_next +=
+					aqm->interval /
+					wlan_aqm_sqrt(ptr->codel_count);
+		}
+	} else if (wlan_aqm_should_drop(ptr, aqm, pmbuf, now)) {
+		wlan_aqm_drop(priv, ptr, ptrindex, aqm, ppdrop);
+		ptr->codel_dropping = MTRUE;
+		/* Resume near the last drop rate if the queue was only just
+		 * under control */
+		delta = ptr->codel_count - ptr->codel_lastcount;
+		if (delta > 1 && (t_s32)(now - ptr->codel_drop_next) <
+		    (t_s32)(16 * aqm->interval))
+			ptr->codel_count = delta;
+		else
+			ptr->codel_count = 1;
+		ptr->codel_lastcount = ptr->codel_count;
+		ptr->codel_drop_next = now + aqm->interval /
+			wlan_aqm_sqrt(ptr->codel_count);
+	}
+}
+
 /**
  *  @brief This function dequeues a packet
  *
@@ -1104,24 +1582,26 @@ wlan_dequeue_tx_packet(pmlan_adapter pmadapter)
 {
 	raListTbl *ptr;
 	pmlan_private priv = MNULL;
+	pmlan_buffer pdrop = MNULL;
+	pmlan_buffer pmbuf;
 	int ptrindex = 0;
 	t_u8 ra[MLAN_MAC_ADDR_LENGTH];
 	int tid_del = -1;
 	int tid_add = -1;
 	int tid = 0;
 
-	ENTER();
+	HOT_ENTER();
 
 	ptr = wlan_wmm_get_highest_priolist_ptr(pmadapter, &priv, &ptrindex);
 	if (!ptr) {
-		LEAVE();
+		HOT_LEAVE();
 		return MLAN_STATUS_FAILURE;
 	}
 
 	/*  Note:- Spinlock is locked in wlan_wmm_get_highest_priolist_ptr
 	 *  when it returns a pointer (for the priv it returns),
 	 *  and is unlocked in wlan_send_processed_packet,
-	 *  wlan_send_single_packet or wlan_11n_aggregate_pkt.
+	 *  wlan_send_batch_packets or wlan_11n_aggregate_pkt.
 	 *  The spinlock would be required for some parts of both of function.
 	 *  But, the the bulk of these function will execute w/o spinlock.
 	 *  Unlocking the spinlock inside these function will help us avoid
@@ -1130,7 +1610,7 @@ wlan_dequeue_tx_packet(pmlan_adapter pmadapter)
 	 *  execution time. */
 
 	/* Note:- Also, anybody adding code which does not get into
-	 * wlan_send_processed_packet, wlan_send_single_packet, or
+	 * wlan_send_processed_packet, wlan_send_batch_packets, or
 	 * wlan_11n_aggregate_pkt should make sure ra_list_spinlock
 	 * is freed. Otherwise there would be a lock up. */
 
@@ -1140,10 +1620,12 @@ wlan_dequeue_tx_packet(pmlan_adapter pmadapter)
 
 	if (wlan_is_ptr_processed(priv, ptr)) {
 		wlan_send_processed_packet(priv, ptr, ptrindex);
-		LEAVE();
+		HOT_LEAVE();
 		return MLAN_STATUS_SUCCESS;
 	}
 
+	wlan_aqm_dequeue(priv, ptr, ptrindex, &pdrop);
+
 	if (ptr->del_ba_count >= DEL_BA_THRESHOLD)
 		wlan_update_del_ba_count(priv, ptr);
 	if (!ptr->is_11n_enabled ||
@@ -1160,14 +1642,14 @@ wlan_dequeue_tx_packet(pmlan_adapter pmadapter)
 			wlan_11n_aggregate_pkt(priv, ptr, priv->intf_hr_len,
 					       ptrindex);
 		} else
-			wlan_send_single_packet(priv, ptr, ptrindex);
+			wlan_send_batch_packets(priv, ptr, ptrindex);
 	} else {
 		if (wlan_is_ampdu_allowed(priv, ptr, tid) &&
 		    (ptr->packet_count > ptr->ba_packet_threshold)) {
 			if (wlan_is_bastream_avail(priv)) {
-				PRINTM(MINFO,
-				       "BA setup threshold %d reached. tid=%d\n",
-				       ptr->packet_count, tid);
+				HOT_PRINTM(MINFO,
+					   "BA setup threshold %d reached. tid=%d\n",
+					   ptr->packet_count, tid);
 				if (!wlan_11n_get_txbastream_tbl
 				    (priv, tid, ptr->ra, MFALSE)) {
 					wlan_11n_create_txbastream_tbl(priv,
@@ -1182,8 +1664,9 @@ wlan_dequeue_tx_packet(pmlan_adapter pmadapter)
 			} else if (wlan_find_stream_to_delete(priv, ptr,
 							      tid, &tid_del,
 							      ra)) {
-				PRINTM(MDAT_D, "tid_del=%d tid=%d\n", tid_del,
-				       tid);
+				HOT_PRINTM(MDAT_D,
+					   "tid_del=%d tid=%d\n", tid_del,
+					   tid);
 				if (!wlan_11n_get_txbastream_tbl
 				    (priv, tid, ptr->ra, MFALSE)) {
 					wlan_11n_create_txbastream_tbl(priv,
@@ -1200,7 +1683,7 @@ wlan_dequeue_tx_packet(pmlan_adapter pmadapter)
 			wlan_11n_aggregate_pkt(priv, ptr, priv->intf_hr_len,
 					       ptrindex);
 		} else {
-			wlan_send_single_packet(priv, ptr, ptrindex);
+			wlan_send_batch_packets(priv, ptr, ptrindex);
 		}
 	}
 
@@ -1208,7 +1691,13 @@ wlan_dequeue_tx_packet(pmlan_adapter pmadapter)
 		wlan_send_addba(priv, tid_add, ra);
 	if (tid_del >= 0 && tid_del < 8)
 		wlan_send_delba(priv, MNULL, tid_del, ra, 1);
-	LEAVE();
+	while (pdrop) {
+		pmbuf = pdrop;
+		pdrop = pmbuf->pnext;
+		wlan_write_data_complete(pmadapter, pmbuf,
+					 MLAN_STATUS_FAILURE);
+	}
+	HOT_LEAVE();
 	return MLAN_STATUS_SUCCESS;
 }
 
@@ -1243,6 +1732,7 @@ wlan_update_ralist_tx_pause(pmlan_private priv, t_u8 *mac, t_u8 tx_pause)
 				priv->wmm.pkts_paused[i] += ra_list->total_pkts;
 			else
 				priv->wmm.pkts_paused[i] -= ra_list->total_pkts;
+			wlan_wmm_update_prio_bitmap(priv, i);
 
 		}
 	}
@@ -1309,6 +1799,7 @@ wlan_update_non_tdls_ralist(mlan_private *priv, t_u8 *mac, t_u8 tx_pause)
 				else
 					priv->wmm.pkts_paused[i] -=
 						ra_list->total_pkts;
+				wlan_wmm_update_prio_bitmap(priv, i);
 			}
 			ra_list = ra_list->pnext;
 		}
@@ -1462,6 +1953,7 @@ wlan_wmm_delete_tdls_ralist(pmlan_private priv, t_u8 *mac)
 					 &priv->wmm.tid_tbl_ptr[i].ra_list,
 					 (pmlan_linked_list)ra_list, MNULL,
 					 MNULL);
+			wlan_wmm_unindex_ralist(priv, i, ra_list);
 			pmadapter->callbacks.moal_mfree(pmadapter->pmoal_handle,
 							(t_u8 *)ra_list);
 			if (priv->wmm.tid_tbl_ptr[i].ra_list_curr == ra_list)
@@ -1545,6 +2037,8 @@ wlan_clean_txrx(pmlan_private priv)
 #if defined(UAP_SUPPORT)
 	priv->num_drop_pkts = 0;
 #endif
+	memset(pmadapter, pmadapter->dbg.num_tx_batch, 0,
+	       sizeof(pmadapter->dbg.num_tx_batch));
 #ifdef SDIO_MULTI_PORT_TX_AGGR
 	memset(pmadapter, pmadapter->mpa_tx_count, 0,
 	       sizeof(pmadapter->mpa_tx_count));
@@ -1712,11 +2206,18 @@ wlan_ralist_add(mlan_private *priv, t_u8 *ra)
 {
 	int i;
 	raListTbl *ra_list;
+	peer_node *peer;
 	pmlan_adapter pmadapter = priv->adapter;
 	tdlsStatus_e status;
 
 	ENTER();
 
+	peer = wlan_add_peer_node(priv, ra);
+	if (!peer) {
+		LEAVE();
+		return;
+	}
+
 	for (i = 0; i < MAX_NUM_TID; ++i) {
 		ra_list = wlan_wmm_allocate_ralist_node(pmadapter, ra);
 		PRINTM(MINFO, "Creating RA List %p for tid %d\n", ra_list, i);
@@ -1767,7 +2268,10 @@ wlan_ralist_add(mlan_private *priv, t_u8 *ra)
 
 		if (!priv->wmm.tid_tbl_ptr[i].ra_list_curr)
 			priv->wmm.tid_tbl_ptr[i].ra_list_curr = ra_list;
+		if (!peer->ra_list[i])
+			peer->ra_list[i] = ra_list;
 	}
+	wlan_release_peer_node(priv, peer);
 
 	LEAVE();
 }
@@ -1848,7 +2352,15 @@ wlan_wmm_init(pmlan_adapter pmadapter)
 				priv->wmm.pkts_paused[i] = 0;
 				priv->wmm.tid_tbl_ptr[i].ra_list_curr = MNULL;
 			}
+			priv->wmm.prio_bitmap = 0;
 			priv->wmm.drv_pkt_delay_max = WMM_DRV_DELAY_MAX;
+			for (i = 0; i < MAX_AC_QUEUES; ++i) {
+				memset(pmadapter, &priv->wmm.aqm[i], 0,
+				       sizeof(priv->wmm.aqm[i]));
+				priv->wmm.aqm[i].target = WMM_AQM_DEF_TARGET;
+				priv->wmm.aqm[i].interval =
+					WMM_AQM_DEF_INTERVAL;
+			}
 
 			priv->aggr_prio_tbl[6].amsdu = BA_STREAM_NOT_ALLOWED;
 			priv->aggr_prio_tbl[7].amsdu = BA_STREAM_NOT_ALLOWED;
@@ -2002,24 +2514,11 @@ wlan_wmm_lists_empty(pmlan_adapter pmadapter)
 raListTbl *
 wlan_wmm_get_ralist_node(pmlan_private priv, t_u8 tid, t_u8 *ra_addr)
 {
-	raListTbl *ra_list;
-	ENTER();
-	ra_list =
-		(raListTbl *)util_peek_list(priv->adapter->pmoal_handle,
-					    &priv->wmm.tid_tbl_ptr[tid].ra_list,
-					    MNULL, MNULL);
-	while (ra_list && (ra_list != (raListTbl *)
-			   &priv->wmm.tid_tbl_ptr[tid].ra_list)) {
-		if (!memcmp
-		    (priv->adapter, ra_list->ra, ra_addr,
-		     MLAN_MAC_ADDR_LENGTH)) {
-			LEAVE();
-			return ra_list;
-		}
-		ra_list = ra_list->pnext;
-	}
-	LEAVE();
-	return MNULL;
+	peer_node *peer;
+	HOT_ENTER();
+	peer = wlan_get_peer_node(priv, ra_addr);
+	HOT_LEAVE();
+	return peer ? peer->ra_list[tid] : MNULL;
 }
 
 /**
@@ -2055,6 +2554,24 @@ wlan_is_ralist_valid(mlan_private *priv, raListTbl *ra_list, int ptrindex)
 	return MFALSE;
 }
 
+/**
+ *   @brief Update the priority bitmap bit of a TID after its queued or
+ *          paused packet count changed; caller holds ra_list_spinlock
+ *
+ *   @param priv     Pointer to the mlan_private driver data struct
+ *   @param tid      TID
+ *
+ *   @return         N/A
+ */
+t_void
+wlan_wmm_update_prio_bitmap(mlan_private *priv, t_u8 tid)
+{
+	if (priv->wmm.pkts_queued[tid] > priv->wmm.pkts_paused[tid])
+		priv->wmm.prio_bitmap |= MBIT(tos_to_tid_inv[tid]);
+	else
+		priv->wmm.prio_bitmap &= ~MBIT(tos_to_tid_inv[tid]);
+}
+
 /**
  *  @brief  Update an existing raList with a new RA and 11n capability
  *
@@ -2070,6 +2587,7 @@ wlan_ralist_update(mlan_private *priv, t_u8 *old_ra, t_u8 *new_ra)
 	t_u8 tid;
 	int update_count;
 	raListTbl *ra_list;
+	peer_node *peer;
 
 	ENTER();
 
@@ -2106,8 +2624,12 @@ wlan_ralist_update(mlan_private *priv, t_u8 *old_ra, t_u8 *new_ra)
 			       "\n", ra_list, ra_list->is_11n_enabled,
 			       MAC2STR(ra_list->ra), MAC2STR(new_ra));
 
+			wlan_wmm_unindex_ralist(priv, tid, ra_list);
 			memcpy(priv->adapter, ra_list->ra, new_ra,
 			       MLAN_MAC_ADDR_LENGTH);
+			peer = wlan_add_peer_node(priv, new_ra);
+			if (peer && !peer->ra_list[tid])
+				peer->ra_list[tid] = ra_list;
 		}
 	}
 
@@ -2135,14 +2657,14 @@ wlan_wmm_add_buf_txqueue(pmlan_adapter pmadapter, pmlan_buffer pmbuf)
 	sta_node *sta_ptr = MNULL;
 #endif
 
-	ENTER();
+	HOT_ENTER();
 
 	pmbuf->buf_type = MLAN_BUF_TYPE_DATA;
 	if (!priv->media_connected) {
 		PRINTM_NETINTF(MWARN, priv);
 		PRINTM(MWARN, "Drop packet %p in disconnect state\n", pmbuf);
 		wlan_write_data_complete(pmadapter, pmbuf, MLAN_STATUS_FAILURE);
-		LEAVE();
+		HOT_LEAVE();
 		return;
 	}
 	tid = pmbuf->priority;
@@ -2166,7 +2688,7 @@ wlan_wmm_add_buf_txqueue(pmlan_adapter pmadapter, pmlan_buffer pmbuf)
 							      pmoal_handle,
 							      priv->wmm.
 							      ra_list_spinlock);
-			LEAVE();
+			HOT_LEAVE();
 			return;
 		} else
 			ra_list =
@@ -2207,14 +2729,14 @@ wlan_wmm_add_buf_txqueue(pmlan_adapter pmadapter, pmlan_buffer pmbuf)
 						      priv->wmm.
 						      ra_list_spinlock);
 		wlan_write_data_complete(pmadapter, pmbuf, MLAN_STATUS_FAILURE);
-		LEAVE();
+		HOT_LEAVE();
 		return;
 	}
 
 	PRINTM_NETINTF(MINFO, priv);
-	PRINTM(MINFO,
-	       "Adding pkt %p (priority=%d, tid_down=%d) to ra_list %p\n",
-	       pmbuf, pmbuf->priority, tid_down, ra_list);
+	HOT_PRINTM(MINFO,
+		   "Adding pkt %p (priority=%d, tid_down=%d) to ra_list %p\n",
+		   pmbuf, pmbuf->priority, tid_down, ra_list);
 	util_enqueue_list_tail(pmadapter->pmoal_handle, &ra_list->buf_head,
 			       (pmlan_linked_list)pmbuf, MNULL, MNULL);
 
@@ -2225,6 +2747,7 @@ wlan_wmm_add_buf_txqueue(pmlan_adapter pmadapter, pmlan_buffer pmbuf)
 	if (ra_list->tx_pause) {
 		priv->wmm.pkts_paused[tid_down]++;
 	} else {
+		priv->wmm.prio_bitmap |= MBIT(tos_to_tid_inv[tid_down]);
 		util_scalar_increment(pmadapter->pmoal_handle,
 				      &priv->wmm.tx_pkts_queued, MNULL, MNULL);
 		/* if highest_queued_prio < prio(tid_down), set it to prio(tid_down) */
@@ -2244,10 +2767,11 @@ wlan_wmm_add_buf_txqueue(pmlan_adapter pmadapter, pmlan_buffer pmbuf)
 	pmadapter->callbacks.moal_get_system_time(pmadapter->pmoal_handle,
 						  &pmbuf->in_ts_sec,
 						  &pmbuf->in_ts_usec);
+	wlan_tx_lat_stamp(pmadapter, pmbuf, MLAN_TX_TS_WMM);
 	pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
 					      priv->wmm.ra_list_spinlock);
 
-	LEAVE();
+	HOT_LEAVE();
 }
 
 #ifdef STA_SUPPORT
@@ -2536,6 +3060,7 @@ wlan_wmm_compute_driver_packet_delay(pmlan_private priv,
 	priv->adapter->callbacks.moal_get_system_time(priv->adapter->
 						      pmoal_handle, &out_ts_sec,
 						      &out_ts_usec);
+	wlan_tx_lat_stamp(priv->adapter, pmbuf, MLAN_TX_TS_DEQUEUE);
 
 	queue_delay = (t_s32)(out_ts_sec - pmbuf->in_ts_sec) * 1000;
 	queue_delay += (t_s32)(out_ts_usec - pmbuf->in_ts_usec) / 1000;
@@ -2565,7 +3090,7 @@ wlan_wmm_compute_driver_packet_delay(pmlan_private priv,
 void
 wlan_wmm_process_tx(pmlan_adapter pmadapter)
 {
-	ENTER();
+	HOT_ENTER();
 
 	do {
 		if (wlan_dequeue_tx_packet(pmadapter))
@@ -2581,7 +3106,7 @@ wlan_wmm_process_tx(pmlan_adapter pmadapter)
 	} while (!pmadapter->data_sent && !pmadapter->tx_lock_flag
 		 && !wlan_wmm_lists_empty(pmadapter));
 
-	LEAVE();
+	HOT_LEAVE();
 	return;
 }
 
@@ -2663,6 +3188,7 @@ wlan_del_tx_pkts_in_ralist(pmlan_private priv,
 							      &priv->wmm.
 							      tx_pkts_queued,
 							      MNULL, MNULL);
+				wlan_wmm_update_prio_bitmap(priv, tid);
 				ret = MTRUE;
 				break;
 			}
@@ -2732,12 +3258,14 @@ wlan_wmm_delete_peer_ralist(pmlan_private priv, t_u8 *mac)
 				priv->wmm.pkts_paused[i] -= ra_list->total_pkts;
 			else
 				pkt_cnt += ra_list->total_pkts;
+			wlan_wmm_update_prio_bitmap(priv, i);
 			wlan_wmm_del_pkts_in_ralist_node(priv, ra_list);
 
 			util_unlink_list(pmadapter->pmoal_handle,
 					 &priv->wmm.tid_tbl_ptr[i].ra_list,
 					 (pmlan_linked_list)ra_list, MNULL,
 					 MNULL);
+			wlan_wmm_unindex_ralist(priv, i, ra_list);
 			pmadapter->callbacks.moal_mfree(pmadapter->pmoal_handle,
 							(t_u8 *)ra_list);
 			if (priv->wmm.tid_tbl_ptr[i].ra_list_curr == ra_list)
@@ -2797,6 +3325,7 @@ wlan_hold_tdls_packets(pmlan_private priv, t_u8 *mac)
 						 MNULL, MNULL);
 				ra_list->total_pkts--;
 				priv->wmm.pkts_queued[i]--;
+				wlan_wmm_update_prio_bitmap(priv, i);
 				util_scalar_decrement(pmadapter->pmoal_handle,
 						      &priv->wmm.tx_pkts_queued,
 						      MNULL, MNULL);
@@ -2874,6 +3403,7 @@ wlan_restore_tdls_packets(pmlan_private priv, t_u8 *mac, tdlsStatus_e status)
 		ra_list->total_pkts++;
 		ra_list->packet_count++;
 		priv->wmm.pkts_queued[tid_down]++;
+		wlan_wmm_update_prio_bitmap(priv, tid_down);
 		util_scalar_increment(pmadapter->pmoal_handle,
 				      &priv->wmm.tx_pkts_queued, MNULL, MNULL);
 		util_scalar_conditional_write(pmadapter->pmoal_handle,
@@ -3616,6 +4146,90 @@ wlan_wmm_ioctl_queue_config(IN pmlan_adapter pmadapter,
 	return ret;
 }
 
+/**
+ *  @brief Get/Set the active queue management of a WMM AC
+ *
+ *  @param pmadapter    A pointer to mlan_adapter structure
+ *  @param pioctl_req   A pointer to ioctl request buffer
+ *
+ *  @return             MLAN_STATUS_SUCCESS --success, otherwise fail
+ */
+static mlan_status
+wlan_wmm_ioctl_aqm(IN pmlan_adapter pmadapter, IN pmlan_ioctl_req pioctl_req)
+{
+	pmlan_private pmpriv = pmadapter->priv[pioctl_req->bss_index];
+	mlan_ds_wmm_cfg *cfg = MNULL;
+	mlan_ds_wmm_aqm *paqm = MNULL;
+	wmm_aqm_t *aqm = MNULL;
+	raListTbl *ra_list = MNULL;
+	mlan_list_head *ra_list_head;
+	t_u32 target, interval;
+	int tid;
+
+	ENTER();
+	cfg = (mlan_ds_wmm_cfg *)pioctl_req->pbuf;
+	paqm = &cfg->param.aqm;
+	if (paqm->access_category >= MAX_AC_QUEUES) {
+		PRINTM(MERROR, "Invalid AC %d\n", paqm->access_category);
+		pioctl_req->status_code = MLAN_ERROR_INVALID_PARAMETER;
+		LEAVE();
+		return MLAN_STATUS_FAILURE;
+	}
+	aqm = &pmpriv->wmm.aqm[paqm->access_category];
+
+	if (pioctl_req->action == MLAN_ACT_SET) {
+		target = paqm->target ? paqm->target : WMM_AQM_DEF_TARGET;
+		interval = paqm->interval ? paqm->interval :
+			WMM_AQM_DEF_INTERVAL;
+		if (paqm->mode > MLAN_WMM_AQM_FQ_CODEL || target >= interval
+		    || interval > WMM_AQM_MAX_INTERVAL) {
+			PRINTM(MERROR, "Invalid AQM mode %d target %u interval %u\n",
+			       paqm->mode, target, interval);
+			pioctl_req->status_code = MLAN_ERROR_INVALID_PARAMETER;
+			LEAVE();
+			return MLAN_STATUS_FAILURE;
+		}
+		pmadapter->callbacks.moal_spin_lock(pmadapter->pmoal_handle,
+						    pmpriv->wmm.
+						    ra_list_spinlock);
+		aqm->mode = paqm->mode;
+		aqm->ecn = paqm->ecn ? MTRUE : MFALSE;
+		aqm->target = target;
+		aqm->interval = interval;
+		/* Restart CoDel on the RA lists of this AC */
+		for (tid = 0; tid < MAX_NUM_TID; tid++) {
+			if (wlan_wmm_convert_tos_to_ac(pmadapter, tid) !=
+			    paqm->access_category)
+				continue;
+			ra_list_head = &pmpriv->wmm.tid_tbl_ptr[tid].ra_list;
+			ra_list = (raListTbl *)util_peek_list(pmadapter->
+							      pmoal_handle,
+							      ra_list_head,
+							      MNULL, MNULL);
+			while (ra_list && ra_list != (raListTbl *)ra_list_head) {
+				ra_list->codel_first_above = 0;
+				ra_list->codel_count = 0;
+				ra_list->codel_lastcount = 0;
+				ra_list->codel_dropping = MFALSE;
+				ra_list = ra_list->pnext;
+			}
+		}
+		pmadapter->callbacks.moal_spin_unlock(pmadapter->pmoal_handle,
+						      pmpriv->wmm.
+						      ra_list_spinlock);
+	}
+
+	paqm->mode = aqm->mode;
+	paqm->ecn = aqm->ecn;
+	paqm->target = aqm->target;
+	paqm->interval = aqm->interval;
+	paqm->drop_cnt = aqm->drop_cnt;
+	paqm->mark_cnt = aqm->mark_cnt;
+
+	LEAVE();
+	return MLAN_STATUS_SUCCESS;
+}
+
 /**
  *  @brief WMM configuration handler
  *
@@ -3668,6 +4282,9 @@ wlan_wmm_cfg_ioctl(IN pmlan_adapter pmadapter, IN pmlan_ioctl_req pioctl_req)
 	case MLAN_OID_WMM_CFG_QUEUE_CONFIG:
 		status = wlan_wmm_ioctl_queue_config(pmadapter, pioctl_req);
 		break;
+	case MLAN_OID_WMM_CFG_AQM:
+		status = wlan_wmm_ioctl_aqm(pmadapter, pioctl_req);
+		break;
 	default:
 		pioctl_req->status_code = MLAN_ERROR_IOCTL_INVALID;
 		status = MLAN_STATUS_FAILURE;
@@ -140,6 +140,8 @@ int wlan_wmm_lists_empty(pmlan_adapter pmadapter);
 t_void wlan_wmm_process_tx(pmlan_adapter pmadapter);
 /** Test to see if the ralist ptr is valid */
 int wlan_is_ralist_valid(mlan_private *priv, raListTbl *ra_list, int tid);
+/** Update the priority bitmap bit of a TID */
+t_void wlan_wmm_update_prio_bitmap(mlan_private *priv, t_u8 tid);
 
 raListTbl *wlan_wmm_get_ralist_node(pmlan_private priv, t_u8 tid,
 				    t_u8 *ra_addr);
@@ -286,6 +286,13 @@ typedef t_u8 mlan_802_11_mac_addr[MLAN_MAC_ADDR_LENGTH];
 #define ALLOC_BUF_SIZE              MLAN_RX_DATA_BUF_SIZE
 /** SDIO MP aggr pkt limit */
 #define SDIO_MP_AGGR_DEF_PKT_LIMIT       (16)
+/** Max scatter-gather segments in one SDIO CMD53 */
+#define SDIO_MP_SG_MAX_SEGS              (SDIO_MP_AGGR_DEF_PKT_LIMIT * 2)
+
+/** Max MSDUs in one scatter-gather AMSDU */
+#define MLAN_AMSDU_SG_MAX_MSDU           7
+/** Max fragments of a scatter-gather mlan_buffer */
+#define MLAN_BUF_MAX_FRAGS               (2 * MLAN_AMSDU_SG_MAX_MSDU + 1)
 
 /** SDIO IO Port mask */
 #define MLAN_SDIO_IO_PORT_MASK		0xfffff
@@ -325,6 +332,16 @@ typedef t_u8 mlan_802_11_mac_addr[MLAN_MAC_ADDR_LENGTH];
 /** Buffer flag for NULL data packet */
 #define MLAN_BUF_FLAG_NULL_PKT        MBIT(12)
 
+/** Buffer flag for scatter-gather buffer, data is described by pfrag */
+#define MLAN_BUF_FLAG_SG              MBIT(13)
+
+/** Buffer flag for shared rx buffer, MOAL uploads a clone and leaves
+ *  the buffer to MLAN */
+#define MLAN_BUF_FLAG_RX_SHARED       MBIT(14)
+
+/** Buffer flag for MOAL tx descriptor kept apart from the data buffer */
+#define MLAN_BUF_FLAG_TX_DESC         MBIT(15)
+
 #ifdef DEBUG_LEVEL1
 /** Debug level bit definition */
 #define	MMSG        MBIT(0)
@@ -733,6 +750,25 @@ typedef struct _mlan_ioctl_req {
 	t_ptr reserved_1;
 } mlan_ioctl_req, *pmlan_ioctl_req;
 
+/** mlan_buf_frag data structure */
+typedef struct _mlan_buf_frag {
+    /** Pointer to fragment data */
+	t_u8 *pdata;
+    /** Fragment length */
+	t_u32 len;
+} mlan_buf_frag, *pmlan_buf_frag;
+
+/** TX latency trace point: woal_hard_start_xmit */
+#define MLAN_TX_TS_KERNEL       0
+/** TX latency trace point: queued to a WMM RA list */
+#define MLAN_TX_TS_WMM          1
+/** TX latency trace point: dequeued for transmit */
+#define MLAN_TX_TS_DEQUEUE      2
+/** TX latency trace point: handed to the SDIO layer */
+#define MLAN_TX_TS_SDIO         3
+/** Number of TX latency trace points kept in mlan_buffer */
+#define MLAN_TX_TS_NUM          4
+
 /** mlan_buffer data structure */
 typedef struct _mlan_buffer {
     /** Pointer to previous mlan_buffer */
@@ -769,12 +805,19 @@ typedef struct _mlan_buffer {
 	t_u32 out_ts_usec;
     /** tx_seq_num */
 	t_u32 tx_seq_num;
+    /** TX latency trace stamps, boot time in 1024 ns units, 0 if not
+     *  taken; only stamped when the kernel enqueue stamp is set */
+	t_u32 tx_ts[MLAN_TX_TS_NUM];
 
     /** Fields below are valid for MLAN module only */
     /** Pointer to parent mlan_buffer */
 	struct _mlan_buffer *pparent;
     /** Use count for this buffer */
 	t_u32 use_count;
+    /** Number of fragments, valid with MLAN_BUF_FLAG_SG */
+	t_u32 frag_cnt;
+    /** Fragment list, valid with MLAN_BUF_FLAG_SG */
+	pmlan_buf_frag pfrag;
 } mlan_buffer, *pmlan_buffer;
 
 /** mlan_fw_info data structure */
@@ -1200,6 +1243,8 @@ typedef struct _mlan_callbacks {
     /** moal_recv_packet */
 	mlan_status (*moal_recv_packet) (IN t_void *pmoal_handle,
 					 IN pmlan_buffer pmbuf);
+    /** moal_recv_batch: open (MTRUE) or deliver (MFALSE) an rx batch */
+	t_void (*moal_recv_batch) (IN t_void *pmoal_handle, IN t_u8 start);
     /** moal_recv_event */
 	mlan_status (*moal_recv_event) (IN t_void *pmoal_handle,
 					IN pmlan_event pmevent);
@@ -1215,6 +1260,10 @@ typedef struct _mlan_callbacks {
     /** moal_free_mlan_buffer */
 	mlan_status (*moal_free_mlan_buffer) (IN t_void *pmoal_handle,
 					      IN pmlan_buffer pmbuf);
+    /** moal_alloc_pool_mlan_buffer: optional, for RX buffers MLAN frees itself */
+	mlan_status (*moal_alloc_pool_mlan_buffer) (IN t_void *pmoal_handle,
+						    IN t_u32 size,
+						    OUT pmlan_buffer *pmbuf);
 
     /** moal_write_reg */
 	mlan_status (*moal_write_reg) (IN t_void *pmoal_handle,
@@ -1317,6 +1366,10 @@ typedef struct _mlan_callbacks {
 					   IN t_u8 *peer_addr,
 					   IN t_s8 snr, IN t_s8 nflr);
 	t_u64 (*moal_do_div) (IN t_u64 num, IN t_u32 base);
+    /** moal_load_acquire */
+	t_u32 (*moal_load_acquire) (IN t_u32 *pval);
+    /** moal_store_release */
+	t_void (*moal_store_release) (IN t_u32 *pval, IN t_u32 val);
 } mlan_callbacks, *pmlan_callbacks;
 
 /** Parameter unchanged, use MLAN default setting */
@@ -1360,16 +1413,24 @@ typedef struct _mlan_device {
 #endif
     /** allocate fixed buffer size for scan beacon buffer*/
 	t_u32 fixed_beacon_buffer;
+    /** Scan beacon store limit in bytes, 0 for the default */
+	t_u32 max_beacon_buffer;
 #ifdef SDIO_MULTI_PORT_TX_AGGR
     /** SDIO MPA Tx */
 	t_u32 mpa_tx_cfg;
+    /** Scatter-gather AMSDU */
+	t_u8 amsdu_sg;
 #endif
 #ifdef SDIO_MULTI_PORT_RX_AGGR
     /** SDIO MPA Rx */
 	t_u32 mpa_rx_cfg;
+    /** Adaptive SDIO MPA Rx sizing */
+	t_u8 mpa_rx_adapt;
 #endif
 	/** SDIO Single port rx aggr */
 	t_u8 sdio_rx_aggr_enable;
+	/** Poll for init command responses */
+	t_u8 init_cmd_poll;
 #if defined(SDIO_MULTI_PORT_TX_AGGR) || defined(SDIO_MULTI_PORT_RX_AGGR)
 	/* see blk_queue_max_segment_size */
 	t_u32 max_seg_size;
@@ -1402,6 +1463,23 @@ typedef struct _mlan_device {
 	t_u32 drcs_chantime_mode;
 } mlan_device, *pmlan_device;
 
+#ifdef HOTPATH_TRACE
+/** Records per CPU in the hot-path trace ring, must be a power of 2 */
+#define MLAN_TRACE_RING_SIZE	1024
+
+/** Hot-path trace record, as read back from /proc/mwlan/trace */
+typedef MLAN_PACK_START struct _mlan_trace_rec {
+    /** Timestamp in ns (local_clock) */
+	t_u64 ts;
+    /** Trace point id */
+	t_u16 id;
+    /** CPU the record was written on */
+	t_u16 cpu;
+    /** Trace point arguments */
+	t_u32 arg[3];
+} MLAN_PACK_END mlan_trace_rec, *pmlan_trace_rec;
+#endif /* HOTPATH_TRACE */
+
 /** MLAN API function prototype */
 #define MLAN_API
 
@@ -1463,4 +1541,10 @@ MLAN_API mlan_status mlan_ioctl(IN t_void *pmlan_adapter,
 /** mlan select wmm queue */
 MLAN_API t_u8 mlan_select_wmm_queue(IN t_void *pmlan_adapter,
 				    IN t_u8 bss_num, IN t_u8 tid);
+#ifdef HOTPATH_TRACE
+/** Enable or disable the hot-path trace points */
+MLAN_API mlan_status mlan_trace_enable(IN t_u8 enable);
+/** Copy out the hot-path trace rings */
+MLAN_API t_u32 mlan_trace_read(OUT pmlan_trace_rec prec, IN t_u32 max_rec);
+#endif /* HOTPATH_TRACE */
 #endif /* !_MLAN_DECL_H_ */
@@ -32,6 +32,8 @@ Change log:
 ********************************************************/
 /** MLAN debug info */
 extern mlan_debug_info info;
+/** TX latency tracing enable */
+extern int tx_lat_trace;
 
 /********************************************************
 		Local Variables
@@ -126,6 +128,10 @@ static struct debug_data items[] = {
 	 item_addr(last_event_index)},
 	{"num_no_cmd_node", item_size(num_no_cmd_node),
 	 item_addr(num_no_cmd_node)},
+	{"init_cmd_cnt", item_size(init_cmd_cnt), item_addr(init_cmd_cnt)},
+	{"init_cmd_us", item_size(init_cmd_us), item_addr(init_cmd_us)},
+	{"init_total_us", item_size(init_total_us),
+	 item_addr(init_total_us)},
 	{"num_cmd_h2c_fail", item_size(num_cmd_host_to_card_failure),
 	 item_addr(num_cmd_host_to_card_failure)},
 	{"num_cmd_sleep_cfm_fail",
@@ -147,6 +153,14 @@ static struct debug_data items[] = {
 	{"mp_invalid_update", item_size(mp_invalid_update),
 	 item_addr(mp_invalid_update)},
 	{"sdio_rx_aggr", item_size(sdio_rx_aggr), item_addr(sdio_rx_aggr)},
+#ifdef SDIO_MULTI_PORT_RX_AGGR
+	{"mpa_rx_pkt_limit", item_size(mpa_rx_pkt_limit),
+	 item_addr(mpa_rx_pkt_limit)},
+	{"mpa_rx_buf_limit", item_size(mpa_rx_buf_limit),
+	 item_addr(mpa_rx_buf_limit)},
+	{"mpa_rx_cmd53_lat_us", item_size(mpa_rx_cmd53_lat_us),
+	 item_addr(mpa_rx_cmd53_lat_us)},
+#endif
 #ifdef SDIO_MULTI_PORT_TX_AGGR
 	{"mpa_sent_last_pkt", item_size(mpa_sent_last_pkt),
 	 item_addr(mpa_sent_last_pkt)},
@@ -178,6 +192,7 @@ static struct debug_data items[] = {
 	{"event_received", item_size(event_received),
 	 item_addr(event_received)},
 
+	/* moal_handle items, must stay last and start with ioctl_pending */
 	{"ioctl_pending", item_handle_size(ioctl_pending),
 	 item_handle_addr(ioctl_pending)},
 	{"tx_pending", item_handle_size(tx_pending),
@@ -192,6 +207,26 @@ static struct debug_data items[] = {
 	 item_handle_addr(vmalloc_count)},
 	{"mbufalloc_count", item_handle_size(mbufalloc_count),
 	 item_handle_addr(mbufalloc_count)},
+	{"rx_pool_hit", item_handle_size(rx_pool_hit),
+	 item_handle_addr(rx_pool_hit)},
+	{"rx_pool_miss", item_handle_size(rx_pool_miss),
+	 item_handle_addr(rx_pool_miss)},
+	{"rx_pool_recycle", item_handle_size(rx_pool_recycle),
+	 item_handle_addr(rx_pool_recycle)},
+	{"tx_copy_avoided", item_handle_size(tx_copy_avoided),
+	 item_handle_addr(tx_copy_avoided)},
+	{"tx_copy_required", item_handle_size(tx_copy_required),
+	 item_handle_addr(tx_copy_required)},
+	{"tx_bql_limit", item_handle_size(tx_bql_limit),
+	 item_handle_addr(tx_bql_limit)},
+	{"napi_poll_cnt", item_handle_size(napi_poll_cnt),
+	 item_handle_addr(napi_poll_cnt)},
+	{"napi_complete_cnt", item_handle_size(napi_complete_cnt),
+	 item_handle_addr(napi_complete_cnt)},
+	{"napi_budget_exhausted", item_handle_size(napi_budget_exhausted),
+	 item_handle_addr(napi_budget_exhausted)},
+	{"napi_rx_pkts", item_handle_size(napi_rx_pkts),
+	 item_handle_addr(napi_rx_pkts)},
 	{"main_state", item_handle_size(main_state),
 	 item_handle_addr(main_state)},
 	{"driver_state", item_handle_size(driver_state),
@@ -275,6 +310,10 @@ static struct debug_data uap_items[] = {
 	 item_addr(last_event_index)},
 	{"num_no_cmd_node", item_size(num_no_cmd_node),
 	 item_addr(num_no_cmd_node)},
+	{"init_cmd_cnt", item_size(init_cmd_cnt), item_addr(init_cmd_cnt)},
+	{"init_cmd_us", item_size(init_cmd_us), item_addr(init_cmd_us)},
+	{"init_total_us", item_size(init_total_us),
+	 item_addr(init_total_us)},
 	{"num_cmd_h2c_fail", item_size(num_cmd_host_to_card_failure),
 	 item_addr(num_cmd_host_to_card_failure)},
 	{"num_cmd_sleep_cfm_fail",
@@ -296,6 +335,14 @@ static struct debug_data uap_items[] = {
 	{"mp_invalid_update", item_size(mp_invalid_update),
 	 item_addr(mp_invalid_update)},
 	{"sdio_rx_aggr", item_size(sdio_rx_aggr), item_addr(sdio_rx_aggr)},
+#ifdef SDIO_MULTI_PORT_RX_AGGR
+	{"mpa_rx_pkt_limit", item_size(mpa_rx_pkt_limit),
+	 item_addr(mpa_rx_pkt_limit)},
+	{"mpa_rx_buf_limit", item_size(mpa_rx_buf_limit),
+	 item_addr(mpa_rx_buf_limit)},
+	{"mpa_rx_cmd53_lat_us", item_size(mpa_rx_cmd53_lat_us),
+	 item_addr(mpa_rx_cmd53_lat_us)},
+#endif
 #ifdef SDIO_MULTI_PORT_TX_AGGR
 	{"mpa_sent_last_pkt", item_size(mpa_sent_last_pkt),
 	 item_addr(mpa_sent_last_pkt)},
@@ -313,6 +360,7 @@ static struct debug_data uap_items[] = {
 	{"event_received", item_size(event_received),
 	 item_addr(event_received)},
 
+	/* moal_handle items, must stay last and start with ioctl_pending */
 	{"ioctl_pending", item_handle_size(ioctl_pending),
 	 item_handle_addr(ioctl_pending)},
 	{"tx_pending", item_handle_size(tx_pending),
@@ -327,6 +375,26 @@ static struct debug_data uap_items[] = {
 	 item_handle_addr(vmalloc_count)},
 	{"mbufalloc_count", item_handle_size(mbufalloc_count),
 	 item_handle_addr(mbufalloc_count)},
+	{"rx_pool_hit", item_handle_size(rx_pool_hit),
+	 item_handle_addr(rx_pool_hit)},
+	{"rx_pool_miss", item_handle_size(rx_pool_miss),
+	 item_handle_addr(rx_pool_miss)},
+	{"rx_pool_recycle", item_handle_size(rx_pool_recycle),
+	 item_handle_addr(rx_pool_recycle)},
+	{"tx_copy_avoided", item_handle_size(tx_copy_avoided),
+	 item_handle_addr(tx_copy_avoided)},
+	{"tx_copy_required", item_handle_size(tx_copy_required),
+	 item_handle_addr(tx_copy_required)},
+	{"tx_bql_limit", item_handle_size(tx_bql_limit),
+	 item_handle_addr(tx_bql_limit)},
+	{"napi_poll_cnt", item_handle_size(napi_poll_cnt),
+	 item_handle_addr(napi_poll_cnt)},
+	{"napi_complete_cnt", item_handle_size(napi_complete_cnt),
+	 item_handle_addr(napi_complete_cnt)},
+	{"napi_budget_exhausted", item_handle_size(napi_budget_exhausted),
+	 item_handle_addr(napi_budget_exhausted)},
+	{"napi_rx_pkts", item_handle_size(napi_rx_pkts),
+	 item_handle_addr(napi_rx_pkts)},
 	{"main_state", item_handle_size(main_state),
 	 item_handle_addr(main_state)},
 	{"driver_state", item_handle_size(driver_state),
@@ -617,6 +685,94 @@ woal_histogram_write(struct file *f, const char __user * buf, size_t count,
 	return count;
 }
 
+/**
+ *  @brief Proc read function for TX latency histograms
+ *
+ *  @param sfp     A pointer to seq_file structure
+ *  @param data    Void pointer to data
+ *
+ *  @return        Number of output data or MLAN_STATUS_FAILURE
+ */
+static int
+woal_tx_lat_read(struct seq_file *sfp, void *data)
+{
+	moal_private *priv = (moal_private *)sfp->private;
+	static const char *ac_name[TX_LAT_AC_NUM] = { "BK", "BE", "VI", "VO" };
+	static const char *stage_name[TX_LAT_STAGES] = {
+		"kernel-wmm", "wmm-dequeue", "dequeue-sdio", "sdio-done",
+		"total"
+	};
+	int ac, stage, ix;
+
+	ENTER();
+	if (!priv) {
+		LEAVE();
+		return -EFAULT;
+	}
+
+	seq_printf(sfp, "tx_lat_trace=%d, log2 buckets of 1.024 us, "
+		   "bucket n counts [2^(n-1), 2^n)\n", tx_lat_trace);
+	seq_printf(sfp, "%-13s", "bucket");
+	for (ix = 0; ix < TX_LAT_BUCKETS; ix++)
+		seq_printf(sfp, " %7d", ix);
+	seq_printf(sfp, "\n");
+	for (ac = 0; ac < TX_LAT_AC_NUM; ac++) {
+		seq_printf(sfp, "AC_%s samples=%d\n", ac_name[ac],
+			   atomic_read(&priv->tx_lat[ac].num_samples));
+		for (stage = 0; stage < TX_LAT_STAGES; stage++) {
+			seq_printf(sfp, "%-13s", stage_name[stage]);
+			for (ix = 0; ix < TX_LAT_BUCKETS; ix++)
+				seq_printf(sfp, " %7d",
+					   atomic_read(&priv->tx_lat[ac].
+						       bucket[stage][ix]));
+			seq_printf(sfp, "\n");
+		}
+	}
+
+	LEAVE();
+	return 0;
+}
+
+/**
+ *  @brief Proc open function for TX latency histograms
+ *
+ *  @param inode     A pointer to inode structure
+ *  @param file      A pointer to file structure
+ *
+ *  @return         0--sucess, otherise fail
+**/
+static int
+woal_tx_lat_proc_open(struct inode *inode, struct file *file)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 10, 0)
+	return single_open(file, woal_tx_lat_read, PDE_DATA(inode));
+#else
+	return single_open(file, woal_tx_lat_read, PDE(inode)->data);
+#endif
+}
+
+/**
+ *  @brief Proc write function for TX latency histograms, any write
+ *         resets them
+ *
+ *  @param f       file pointer
+ *  @param buf     pointer to data buffer
+ *  @param count   data number to write
+ *  @param off     Offset
+ *
+ *  @return        number of data
+ */
+static ssize_t
+woal_tx_lat_write(struct file *f, const char __user * buf, size_t count,
+		  loff_t * off)
+{
+	struct seq_file *sfp = f->private_data;
+	moal_private *priv = (moal_private *)sfp->private;
+
+	woal_tx_lat_reset(priv);
+	return count;
+}
+
 /**
  *  @brief Proc read function for log
  *
@@ -893,6 +1049,18 @@ woal_debug_read(struct seq_file *sfp, void *data)
 		seq_printf(sfp, "%d ", info.mpa_tx_count[i]);
 	seq_printf(sfp, "\n");
 #endif
+	seq_printf(sfp, "Tx batch: ");
+	for (i = 0; i < SDIO_MP_AGGR_DEF_PKT_LIMIT; i++)
+		seq_printf(sfp, "%d ", info.num_tx_batch[i]);
+	seq_printf(sfp, "\n");
+	for (i = 0; i < MLAN_MAX_CMD_LAT_STATS; i++) {
+		if (!info.cmd_lat[i].count)
+			break;
+		seq_printf(sfp,
+			   "cmd_lat[0x%04x]: count=%u total_us=%llu max_us=%u\n",
+			   info.cmd_lat[i].cmd_no, info.cmd_lat[i].count,
+			   info.cmd_lat[i].total_us, info.cmd_lat[i].max_us);
+	}
 #ifdef SDIO_MULTI_PORT_RX_AGGR
 	seq_printf(sfp, "SDIO MPA Rx: ");
 	for (i = 0; i < mp_aggr_pkt_limit; i++)
@@ -905,6 +1073,9 @@ woal_debug_read(struct seq_file *sfp, void *data)
 #endif
 	seq_printf(sfp, "tcp_ack_drop_cnt=%d\n", priv->tcp_ack_drop_cnt);
 	seq_printf(sfp, "tcp_ack_cnt=%d\n", priv->tcp_ack_cnt);
+	seq_printf(sfp, "tcp_ack_flush_cnt=%d\n", priv->tcp_ack_flush_cnt);
+	seq_printf(sfp, "tcp_sess_evict_cnt=%d\n", priv->tcp_sess_evict_cnt);
+	seq_printf(sfp, "tcp_sess_num=%d\n", priv->tcp_sess_num);
 #if LINUX_VERSION_CODE > KERNEL_VERSION(2, 6, 29)
 	for (i = 0; i < 4; i++)
 		seq_printf(sfp, "wmm_tx_pending[%d]:%d\n", i,
@@ -1143,6 +1314,25 @@ static const struct file_operations histogram_proc_fops = {
 };
 #endif
 
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+static const struct proc_ops tx_lat_proc_fops = {
+	.proc_open = woal_tx_lat_proc_open,
+	.proc_read = seq_read,
+	.proc_lseek = seq_lseek,
+	.proc_release = single_release,
+	.proc_write = woal_tx_lat_write,
+};
+#else
+static const struct file_operations tx_lat_proc_fops = {
+	.owner = THIS_MODULE,
+	.open = woal_tx_lat_proc_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+	.write = woal_tx_lat_write,
+};
+#endif
+
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
 static const struct proc_ops log_proc_fops = {
 	.proc_open = woal_log_proc_open,
@@ -1175,7 +1365,7 @@ woal_debug_entry(moal_private *priv)
 {
 	struct proc_dir_entry *r;
 	int i;
-	int handle_items;
+	int handle_first;
 	char hist_entry[50];
 
 	ENTER();
@@ -1212,16 +1402,14 @@ woal_debug_entry(moal_private *priv)
 #endif
 
 	priv->items_priv.priv = priv;
-	handle_items = 9;
-#ifdef SDIO_MMC_DEBUG
-	handle_items += 2;
-#endif
-#if defined(SDIO_SUSPEND_RESUME)
-	handle_items += 2;
-#endif
-	for (i = 1; i <= handle_items; i++)
-		priv->items_priv.items[priv->items_priv.num_of_items -
-				       i].addr += (t_ptr)(priv->phandle);
+	/* moal_handle items run from ioctl_pending to the end of the table */
+	for (handle_first = 0; handle_first < priv->items_priv.num_of_items;
+	     handle_first++)
+		if (!strcmp(priv->items_priv.items[handle_first].name,
+			    "ioctl_pending"))
+			break;
+	for (i = handle_first; i < priv->items_priv.num_of_items; i++)
+		priv->items_priv.items[i].addr += (t_ptr)(priv->phandle);
 
 	/* Create proc entry */
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 26)
@@ -1293,6 +1481,23 @@ woal_debug_entry(moal_private *priv)
 		return;
 	}
 
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 26)
+	r = proc_create_data("txlat", 0644, priv->proc_entry,
+			     &tx_lat_proc_fops, priv);
+	if (r == NULL)
+#else
+	r = create_proc_entry("txlat", 0644, priv->proc_entry);
+	if (r) {
+		r->data = priv;
+		r->proc_fops = &tx_lat_proc_fops;
+	} else
+#endif
+	{
+		PRINTM(MMSG, "Fail to create proc txlat entry\n");
+		LEAVE();
+		return;
+	}
+
 	LEAVE();
 }
 
@@ -1323,6 +1528,7 @@ woal_debug_remove(moal_private *priv)
 		remove_proc_entry("histogram", priv->proc_entry);
 	}
 	remove_proc_entry("log", priv->proc_entry);
+	remove_proc_entry("txlat", priv->proc_entry);
 
 	LEAVE();
 }
@@ -6452,6 +6452,89 @@ done:
 	return ret;
 }
 
+/**
+ *  @brief Private IOCTL entry to get/set the active queue management
+ *         of a WMM AC Queue
+ *
+ *  Arguments are <ac> [<mode> [<ecn> [<target> [<interval>]]]] with
+ *  target and interval in microseconds. The response is ac, mode, ecn,
+ *  target, interval, packets dropped and packets marked.
+ *
+ *  @param priv         A pointer to moal_private structure
+ *  @param respbuf      A pointer to response buffer
+ *  @param respbuflen   Available length of response buffer
+ *
+ *  @return         Number of bytes written, negative for failure.
+ */
+static int
+woal_priv_aqmcfg(moal_private *priv, t_u8 *respbuf, t_u32 respbuflen)
+{
+	mlan_ioctl_req *req = NULL;
+	mlan_ds_wmm_cfg *pwmm = NULL;
+	mlan_ds_wmm_aqm *paqm = NULL;
+	int data[7];
+	int user_data_len = 0, header_len = 0;
+	int ret = 0;
+	mlan_status status = MLAN_STATUS_SUCCESS;
+
+	ENTER();
+
+	header_len = strlen(CMD_NXP) + strlen(PRIV_CMD_AQMCFG);
+	memset(data, 0, sizeof(data));
+	if (strlen(respbuf) > header_len)
+		parse_arguments(respbuf + header_len, data,
+				sizeof(data) / sizeof(int), &user_data_len);
+	if (user_data_len < 1 || user_data_len > 5) {
+		PRINTM(MERROR, "Invalid number of arguments\n");
+		ret = -EINVAL;
+		goto done;
+	}
+	if (data[0] < 0 || data[0] >= MAX_AC_QUEUES) {
+		PRINTM(MERROR, "Invalid AC %d\n", data[0]);
+		ret = -EINVAL;
+		goto done;
+	}
+
+	req = woal_alloc_mlan_ioctl_req(sizeof(mlan_ds_wmm_cfg));
+	if (req == NULL) {
+		ret = -ENOMEM;
+		goto done;
+	}
+	req->req_id = MLAN_IOCTL_WMM_CFG;
+	pwmm = (mlan_ds_wmm_cfg *)req->pbuf;
+	pwmm->sub_command = MLAN_OID_WMM_CFG_AQM;
+	paqm = &pwmm->param.aqm;
+	paqm->access_category = (mlan_wmm_ac_e)data[0];
+	if (user_data_len > 1) {
+		req->action = MLAN_ACT_SET;
+		paqm->mode = (t_u8)data[1];
+		paqm->ecn = (t_u8)data[2];
+		paqm->target = (t_u32)data[3];
+		paqm->interval = (t_u32)data[4];
+	} else
+		req->action = MLAN_ACT_GET;
+
+	status = woal_request_ioctl(priv, req, MOAL_IOCTL_WAIT);
+	if (status != MLAN_STATUS_SUCCESS) {
+		ret = -EFAULT;
+		goto done;
+	}
+	data[0] = paqm->access_category;
+	data[1] = paqm->mode;
+	data[2] = paqm->ecn;
+	data[3] = paqm->target;
+	data[4] = paqm->interval;
+	data[5] = paqm->drop_cnt;
+	data[6] = paqm->mark_cnt;
+	memcpy(respbuf, (t_u8 *)data, sizeof(data));
+	ret = sizeof(data);
+done:
+	if (status != MLAN_STATUS_PENDING)
+		kfree(req);
+	LEAVE();
+	return ret;
+}
+
 /**
  *  @brief Private IOCTL entry to get the status of the WMM queues
  *
@@ -12186,6 +12269,12 @@ woal_android_priv_cmd(struct net_device *dev, struct ifreq *req)
 			/* Queue config */
 			len = woal_priv_qconfig(priv, buf, priv_cmd.total_len);
 			goto handled;
+		} else if (strnicmp
+			   (buf + strlen(CMD_NXP), PRIV_CMD_AQMCFG,
+			    strlen(PRIV_CMD_AQMCFG)) == 0) {
+			/* Active queue management config */
+			len = woal_priv_aqmcfg(priv, buf, priv_cmd.total_len);
+			goto handled;
 		} else if (strnicmp
 			   (buf + strlen(CMD_NXP), PRIV_CMD_ADDTS,
 			    strlen(PRIV_CMD_ADDTS)) == 0) {
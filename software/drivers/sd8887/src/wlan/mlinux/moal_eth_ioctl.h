@@ -138,6 +138,7 @@ Change log:
 #define PRIV_CMD_ARPFILTER      "arpfilter"
 #define PRIV_CMD_MGMT_FRAME_CTRL  "mgmtframectrl"
 #define PRIV_CMD_QCONFIG        "qconfig"
+#define PRIV_CMD_AQMCFG         "aqmcfg"
 #define PRIV_CMD_ADDTS          "addts"
 #define PRIV_CMD_DELTS          "delts"
 #define PRIV_CMD_QSTATUS        "qstatus"
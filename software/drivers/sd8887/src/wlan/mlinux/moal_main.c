@@ -52,6 +52,7 @@ Change log:
 #include <linux/tcp.h>
 #include <net/tcp.h>
 #include <net/dsfield.h>
+#include <linux/jhash.h>
 
 #ifdef CONFIG_OF
 #include <linux/of.h>
@@ -206,6 +207,15 @@ int wq_sched_policy = SCHED_NORMAL;
 /** rx_work flag */
 int rx_work;
 
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+/** Scatter-gather AMSDU flag */
+int amsdu_sg;
+#endif
+#ifdef SDIO_MULTI_PORT_RX_AGGR
+/** Adaptive MP-A RX sizing flag */
+int mpa_rx_adapt;
+#endif
+
 int low_power_mode_enable;
 
 int hw_test;
@@ -238,10 +248,12 @@ static mlan_callbacks woal_callbacks = {
 	.moal_shutdown_fw_complete = moal_shutdown_fw_complete,
 	.moal_send_packet_complete = moal_send_packet_complete,
 	.moal_recv_packet = moal_recv_packet,
+	.moal_recv_batch = moal_recv_batch,
 	.moal_recv_event = moal_recv_event,
 	.moal_ioctl_complete = moal_ioctl_complete,
 	.moal_alloc_mlan_buffer = moal_alloc_mlan_buffer,
 	.moal_free_mlan_buffer = moal_free_mlan_buffer,
+	.moal_alloc_pool_mlan_buffer = moal_alloc_pool_mlan_buffer,
 
 	.moal_write_reg = moal_write_reg,
 	.moal_read_reg = moal_read_reg,
@@ -273,6 +285,8 @@ static mlan_callbacks woal_callbacks = {
 	.moal_hist_data_add = moal_hist_data_add,
 	.moal_updata_peer_signal = moal_updata_peer_signal,
 	.moal_do_div = moal_do_div,
+	.moal_load_acquire = moal_load_acquire,
+	.moal_store_release = moal_store_release,
 };
 
 #if defined(STA_SUPPORT) && defined(UAP_SUPPORT)
@@ -302,6 +316,14 @@ int indication_gpio = 0xff;
 #define DEFAULT_DEV_CAP_MASK 0xffffffff
 t_u32 dev_cap_mask = DEFAULT_DEV_CAP_MASK;
 int sdio_rx_aggr = MTRUE;
+/** Poll for init command responses */
+int init_cmd_poll;
+/** Trace per-packet TX latency into the txlat proc histograms */
+int tx_lat_trace;
+/** Cap of each AC's byte queue limit, in ms of measured SDIO drain */
+int tx_bql_delay = 10;
+/** Module load timestamp in ns, base of the init phase trace */
+static t_u64 insmod_ns;
 /********************************************************
 		Global Variables
 ********************************************************/
@@ -316,6 +338,8 @@ moal_handle *m_handle[MAX_MLAN_ADAPTER];
 
 /** The global variable of scan beacon buffer **/
 int fixed_beacon_buffer = 0;
+/** Scan beacon store limit in bytes, 0 for the default **/
+int max_beacon_buffer = 0;
 /** the pointer of new fwdump fname for each dump**/
 char *fwdump_fname = NULL;
 
@@ -380,6 +404,10 @@ static moal_handle *reset_handle;
 static struct workqueue_struct *hang_workqueue;
 /** Hang work */
 static struct work_struct hang_work;
+/** TCP session cache, shared by all interfaces */
+static struct kmem_cache *tcp_sess_cache;
+/** TX descriptor cache, shared by all adapters */
+static struct kmem_cache *tx_desc_cache;
 
 /**
  *  @brief This function process FW hang
@@ -1254,6 +1282,14 @@ woal_init_from_dev_tree(void)
 				PRINTM(MIOCTL, "fixed_beacon_buffer=%d\n",
 				       fixed_beacon_buffer);
 			}
+		} else if (!strncmp
+			   (prop->name, "max_beacon_buffer",
+			    strlen("max_beacon_buffer"))) {
+			if (!of_property_read_u32(dt_node, prop->name, &data)) {
+				max_beacon_buffer = data;
+				PRINTM(MIOCTL, "max_beacon_buffer=%d\n",
+				       max_beacon_buffer);
+			}
 		} else if (!strncmp
 			   (prop->name, "multi_dtim", strlen("multi_dtim"))) {
 			if (!of_property_read_u32(dt_node, prop->name, &data)) {
@@ -1381,6 +1417,8 @@ woal_init_sw(moal_handle *handle)
 #if LINUX_VERSION_CODE > KERNEL_VERSION(2, 6, 29)
 	spin_lock_init(&handle->queue_lock);
 #endif
+	spin_lock_init(&handle->tx_bql_lock);
+	handle->tx_drain_start = jiffies;
 	spin_lock_init(&handle->driver_lock);
 	spin_lock_init(&handle->ioctl_lock);
 	spin_lock_init(&handle->scan_req_lock);
@@ -1467,6 +1505,7 @@ woal_init_sw(moal_handle *handle)
 	device.pmoal_handle = handle;
 
 	device.sdio_rx_aggr_enable = sdio_rx_aggr;
+	device.init_cmd_poll = init_cmd_poll ? MTRUE : MFALSE;
 
 #ifdef MFG_CMD_SUPPORT
 	if (mfg_mode)
@@ -1479,6 +1518,7 @@ woal_init_sw(moal_handle *handle)
 	device.drvdbg = drvdbg;
 #endif
 	device.fixed_beacon_buffer = (t_u32)fixed_beacon_buffer;
+	device.max_beacon_buffer = (t_u32)max_beacon_buffer;
 	device.auto_ds = (t_u32)auto_ds;
 	device.ps_mode = (t_u32)ps_mode;
 	device.max_tx_buf = (t_u32)max_tx_buf;
@@ -1504,6 +1544,7 @@ woal_init_sw(moal_handle *handle)
 #else
 	device.mpa_tx_cfg = MLAN_INIT_PARA_DISABLED;
 #endif
+	device.amsdu_sg = amsdu_sg ? MTRUE : MFALSE;
 #endif
 #ifdef SDIO_MULTI_PORT_RX_AGGR
 #ifdef MMC_QUIRK_BLKSZ_FOR_BYTE_MODE
@@ -1511,6 +1552,7 @@ woal_init_sw(moal_handle *handle)
 #else
 	device.mpa_rx_cfg = MLAN_INIT_PARA_DISABLED;
 #endif
+	device.mpa_rx_adapt = mpa_rx_adapt ? MTRUE : MFALSE;
 #endif
 
 	if (rx_work == MLAN_INIT_PARA_ENABLED)
@@ -1601,6 +1643,9 @@ woal_free_moal_handle(moal_handle *handle)
 
 	if (handle->pmlan_adapter)
 		mlan_unregister(handle->pmlan_adapter);
+	woal_rx_pool_free(handle);
+	woal_tx_desc_pool_free(handle);
+	woal_rx_batch_free(handle);
 
 	/* Free BSS attribute table */
 	kfree(handle->drv_mode.bss_attr);
@@ -2663,6 +2708,242 @@ err:
 	return ret;
 }
 
+/**
+ * @brief This function logs the end of a driver init phase at MMSG level,
+ *        with its duration and the time since the module was loaded
+ *
+ * @param handle    A pointer to moal_handle structure
+ * @param phase     Name of the phase that just completed
+ *
+ * @return        N/A
+ */
+void
+woal_init_phase(moal_handle *handle, const char *phase)
+{
+	t_u64 now = 0;
+
+	moal_get_boot_ktime(handle, &now);
+	if (!handle->init_phase_ns)
+		handle->init_phase_ns = insmod_ns ? insmod_ns : now;
+	PRINTM(MMSG, "wlan: init %s: %u us, %u us since insmod\n", phase,
+	       (t_u32)moal_do_div(now - handle->init_phase_ns, 1000),
+	       (t_u32)moal_do_div(now - insmod_ns, 1000));
+	handle->init_phase_ns = now;
+}
+
+#ifdef FW_XZ_SUPPORT
+/** xz stream header magic */
+static const t_u8 fw_xz_magic[] = { 0xfd, '7', 'z', 'X', 'Z', 0x00 };
+/** Size of the xz stream header and footer */
+#define FW_XZ_HDR_SIZE	12
+
+/**
+ * @brief Decode one variable length integer of an xz index
+ *
+ * @param data      A pointer to the index
+ * @param pos       A pointer to the read position, advanced past the integer
+ * @param end       End of the index
+ * @param pval      A pointer to return the value
+ *
+ * @return        MTRUE or MFALSE
+ */
+static t_u8
+woal_fw_xz_varint(const t_u8 *data, t_u32 *pos, t_u32 end, t_u64 *pval)
+{
+	t_u32 i;
+
+	*pval = 0;
+	for (i = 0; i < 9 && *pos < end; i++) {
+		*pval |= (t_u64)(data[*pos] & 0x7f) << (i * 7);
+		if (!(data[(*pos)++] & 0x80))
+			return MTRUE;
+	}
+	return MFALSE;
+}
+
+/**
+ * @brief Get the decompressed size of an xz firmware image from its index
+ *
+ * @param data      A pointer to the xz image
+ * @param len       Length of the xz image
+ * @param psize     A pointer to return the decompressed size
+ *
+ * @return        MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
+ */
+static mlan_status
+woal_fw_xz_image_size(const t_u8 *data, t_u32 len, t_u32 *psize)
+{
+	const t_u8 *footer;
+	t_u32 index_size, pos, end;
+	t_u64 records, unpadded, size, total = 0;
+
+	if (len < 2 * FW_XZ_HDR_SIZE)
+		return MLAN_STATUS_FAILURE;
+	footer = data + len - FW_XZ_HDR_SIZE;
+	if (footer[10] != 'Y' || footer[11] != 'Z')
+		return MLAN_STATUS_FAILURE;
+	/* Backward size is the index size in 4-byte units, minus one */
+	index_size = ((footer[4] | (footer[5] << 8) | (footer[6] << 16) |
+		       ((t_u32)footer[7] << 24)) + 1) * 4;
+	if (index_size > len - 2 * FW_XZ_HDR_SIZE)
+		return MLAN_STATUS_FAILURE;
+	pos = len - FW_XZ_HDR_SIZE - index_size;
+	end = len - FW_XZ_HDR_SIZE;
+	if (data[pos++] != 0x00)
+		return MLAN_STATUS_FAILURE;
+	if (!woal_fw_xz_varint(data, &pos, end, &records))
+		return MLAN_STATUS_FAILURE;
+	while (records--) {
+		if (!woal_fw_xz_varint(data, &pos, end, &unpadded) ||
+		    !woal_fw_xz_varint(data, &pos, end, &size))
+			return MLAN_STATUS_FAILURE;
+		total += size;
+		if (total > 0xffffffff)
+			return MLAN_STATUS_FAILURE;
+	}
+	if (!total)
+		return MLAN_STATUS_FAILURE;
+	*psize = (t_u32)total;
+	return MLAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief Free the firmware decompression state
+ *
+ * @param handle    A pointer to moal_handle structure
+ *
+ * @return        N/A
+ */
+static void
+woal_fw_xz_free(moal_handle *handle)
+{
+	moal_fw_xz *xz = handle->fw_xz;
+
+	if (!xz)
+		return;
+	if (xz->dec)
+		xz_dec_end(xz->dec);
+	kfree(xz->win);
+	kfree(xz);
+	handle->fw_xz = NULL;
+}
+
+/**
+ * @brief Set up decompression if the firmware image is xz compressed
+ *
+ * @param handle    A pointer to moal_handle structure
+ * @param pfw       A pointer to mlan_fw_image, updated to stream the
+ *                  decompressed image through moal_get_fw_data
+ *
+ * @return        MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
+ */
+static mlan_status
+woal_fw_xz_init(moal_handle *handle, mlan_fw_image *pfw)
+{
+	const struct firmware *firmware = handle->firmware;
+	moal_fw_xz *xz;
+	t_u32 size = 0;
+
+	ENTER();
+
+	if (firmware->size < sizeof(fw_xz_magic) ||
+	    memcmp(firmware->data, fw_xz_magic, sizeof(fw_xz_magic))) {
+		LEAVE();
+		return MLAN_STATUS_SUCCESS;
+	}
+	if (woal_fw_xz_image_size(firmware->data, firmware->size, &size)) {
+		PRINTM(MERROR, "WLAN: Invalid xz index in %s\n",
+		       handle->drv_mode.fw_name);
+		LEAVE();
+		return MLAN_STATUS_FAILURE;
+	}
+
+	xz = kzalloc(sizeof(moal_fw_xz), GFP_KERNEL);
+	if (!xz) {
+		LEAVE();
+		return MLAN_STATUS_FAILURE;
+	}
+	handle->fw_xz = xz;
+	xz->win = kmalloc(FW_XZ_WIN_SIZE, GFP_KERNEL);
+	xz->dec = xz_dec_init(XZ_DYNALLOC, FW_XZ_DICT_MAX);
+	if (!xz->win || !xz->dec) {
+		PRINTM(MERROR, "WLAN: Fail to allocate xz decoder\n");
+		woal_fw_xz_free(handle);
+		LEAVE();
+		return MLAN_STATUS_FAILURE;
+	}
+	xz->buf.in = firmware->data;
+	xz->buf.in_size = firmware->size;
+	xz->buf.out = xz->win;
+	xz->buf.out_size = FW_XZ_WIN_SIZE;
+	xz->size = size;
+
+	PRINTM(MMSG, "WLAN: FW image is xz compressed, %u -> %u bytes\n",
+	       (t_u32)firmware->size, size);
+	pfw->pfw_buf = NULL;
+	pfw->fw_len = size;
+	LEAVE();
+	return MLAN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief Read decompressed firmware data
+ *
+ *  The image is decompressed on demand into a small window, so reads are
+ *  expected to move forward through the image; an earlier offset restarts
+ *  the decoder.
+ *
+ * @param handle    A pointer to moal_handle structure
+ * @param offset    Offset in the decompressed image
+ * @param len       Length to read, at most FW_XZ_WIN_SIZE
+ * @param pbuf      Buffer to copy the data to
+ *
+ * @return        MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
+ */
+mlan_status
+woal_fw_xz_read(moal_handle *handle, t_u32 offset, t_u32 len, t_u8 *pbuf)
+{
+	moal_fw_xz *xz = handle->fw_xz;
+	enum xz_ret ret = XZ_OK;
+	t_u32 drop;
+
+	if (len > FW_XZ_WIN_SIZE || offset + len > xz->size)
+		return MLAN_STATUS_FAILURE;
+
+	if (offset < xz->win_start) {
+		xz_dec_reset(xz->dec);
+		xz->buf.in_pos = 0;
+		xz->win_start = 0;
+		xz->win_len = 0;
+	}
+
+	while (offset + len > xz->win_start + xz->win_len) {
+		if (ret == XZ_STREAM_END) {
+			PRINTM(MERROR, "WLAN: xz FW image ends early @ %u\n",
+			       xz->win_start + xz->win_len);
+			return MLAN_STATUS_FAILURE;
+		}
+		/* Drop data before offset to make room in the window */
+		drop = MIN(offset - xz->win_start, xz->win_len);
+		if (drop) {
+			memmove(xz->win, xz->win + drop, xz->win_len - drop);
+			xz->win_start += drop;
+			xz->win_len -= drop;
+		}
+		xz->buf.out_pos = xz->win_len;
+		ret = xz_dec_run(xz->dec, &xz->buf);
+		if (ret != XZ_OK && ret != XZ_STREAM_END) {
+			PRINTM(MERROR, "WLAN: xz FW decode error %d @ %u\n",
+			       ret, xz->win_start + xz->win_len);
+			return MLAN_STATUS_FAILURE;
+		}
+		xz->win_len = xz->buf.out_pos;
+	}
+	memcpy(pbuf, xz->win + offset - xz->win_start, len);
+	return MLAN_STATUS_SUCCESS;
+}
+#endif
+
 /**
  * @brief Download and Initialize firmware DPC
  *
@@ -2685,6 +2966,12 @@ woal_init_fw_dpc(moal_handle *handle)
 		memset(&fw, 0, sizeof(mlan_fw_image));
 		fw.pfw_buf = (t_u8 *)handle->firmware->data;
 		fw.fw_len = handle->firmware->size;
+#ifdef FW_XZ_SUPPORT
+		if (woal_fw_xz_init(handle, &fw)) {
+			ret = MLAN_STATUS_FAILURE;
+			goto done;
+		}
+#endif
 
 		if (fw_reload == FW_RELOAD_SDIO_INBAND_RESET)
 			fw.fw_reload = fw_reload;
@@ -2700,6 +2987,9 @@ woal_init_fw_dpc(moal_handle *handle)
 		ret = mlan_dnld_fw(handle->pmlan_adapter, &fw);
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2, 6, 32)
 		sdio_release_host(((struct sdio_mmc_card *)handle->card)->func);
+#endif
+#ifdef FW_XZ_SUPPORT
+		woal_fw_xz_free(handle);
 #endif
 		if (ret == MLAN_STATUS_FAILURE) {
 			PRINTM(MERROR,
@@ -2709,6 +2999,7 @@ woal_init_fw_dpc(moal_handle *handle)
 			goto done;
 		}
 		PRINTM(MMSG, "WLAN FW is active\n");
+		woal_init_phase(handle, "fw_dnld");
 	}
 
     /** data request */
@@ -2885,6 +3176,7 @@ woal_init_fw_dpc(moal_handle *handle)
 	handle->init_wait_q_woken = MFALSE;
 
 	ret = mlan_set_init_param(handle->pmlan_adapter, &param);
+	woal_init_phase(handle, "init_param");
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2, 6, 32)
 	sdio_claim_host(((struct sdio_mmc_card *)handle->card)->func);
 #endif
@@ -3203,18 +3495,188 @@ woal_fill_mlan_buffer(moal_private *priv,
 	skb->tstamp = ktime_get_real();
 
 	pmbuf->pdesc = skb;
-	pmbuf->pbuf = skb->head + sizeof(mlan_buffer);
-	pmbuf->data_offset = skb->data - (skb->head + sizeof(mlan_buffer));
+	pmbuf->pbuf = skb->head;
+	pmbuf->data_offset = skb->data - skb->head;
 	pmbuf->data_len = skb->len;
 	pmbuf->priority = skb->priority;
 	pmbuf->buf_type = 0;
 	pmbuf->in_ts_sec = (t_u32)tstamp.time_sec;
 	pmbuf->in_ts_usec = (t_u32)tstamp.time_usec;
+	if (tx_lat_trace) {
+		t_u64 ns = 0;
+
+		moal_get_boot_ktime(priv->phandle, &ns);
+		pmbuf->tx_ts[MLAN_TX_TS_KERNEL] = (t_u32)(ns >> 10) | 1;
+	}
 
 	LEAVE();
 	return;
 }
 
+/** TX latency AC index (BK, BE, VI, VO) of each TID */
+static const t_u8 tx_lat_tid_to_ac[] = { 1, 0, 0, 1, 2, 2, 3, 3 };
+
+/**
+ *  @brief This function adds a completed packet to the TX latency histograms
+ *
+ *  Each stage runs from one trace stamp to the next one, or to now for the
+ *  last; stages with a missing stamp are skipped, and the total is only
+ *  counted for packets that went through every stage.
+ *
+ *  @param priv    A pointer to moal_private structure
+ *  @param pmbuf   A pointer to the completed mlan_buffer
+ *
+ *  @return        N/A
+ */
+void
+woal_tx_lat_add(moal_private *priv, pmlan_buffer pmbuf)
+{
+	tx_lat_hist *hist;
+	t_u64 ns = 0;
+	t_u32 now, start, end;
+	int stage, full = MTRUE;
+
+	hist = &priv->tx_lat[tx_lat_tid_to_ac[pmbuf->priority & 7]];
+	moal_get_boot_ktime(priv->phandle, &ns);
+	now = (t_u32)(ns >> 10) | 1;
+	atomic_inc(&hist->num_samples);
+	for (stage = 0; stage < MLAN_TX_TS_NUM; stage++) {
+		start = pmbuf->tx_ts[stage];
+		end = (stage + 1 < MLAN_TX_TS_NUM) ?
+			pmbuf->tx_ts[stage + 1] : now;
+		if (!start || !end) {
+			full = MFALSE;
+			continue;
+		}
+		atomic_inc(&hist->bucket[stage]
+			   [MIN(fls(end - start), TX_LAT_BUCKETS - 1)]);
+	}
+	if (full)
+		atomic_inc(&hist->bucket[TX_LAT_TOTAL]
+			   [MIN(fls(now - pmbuf->tx_ts[MLAN_TX_TS_KERNEL]),
+				TX_LAT_BUCKETS - 1)]);
+}
+
+/**
+ *  @brief This function resets the TX latency histograms
+ *
+ *  @param priv    A pointer to moal_private structure
+ *
+ *  @return        N/A
+ */
+void
+woal_tx_lat_reset(moal_private *priv)
+{
+	int ac, stage, ix;
+
+	for (ac = 0; ac < TX_LAT_AC_NUM; ac++) {
+		atomic_set(&priv->tx_lat[ac].num_samples, 0);
+		for (stage = 0; stage < TX_LAT_STAGES; stage++)
+			for (ix = 0; ix < TX_LAT_BUCKETS; ix++)
+				atomic_set(&priv->tx_lat[ac].bucket[stage][ix],
+					   0);
+	}
+}
+
+/**
+ *  @brief This function caps the per-AC byte queue limits at tx_bql_delay
+ *  ms of the SDIO drain rate measured over the last TX_BQL_INTERVAL
+ *
+ *  Called with tx_bql_lock held.
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        N/A
+ */
+static void
+woal_tx_bql_update(moal_handle *handle)
+{
+	unsigned int msecs;
+	t_u32 limit = 0;
+#ifdef CONFIG_BQL
+	struct net_device *dev;
+	unsigned int q;
+	int i;
+#endif
+
+	msecs = jiffies_to_msecs(jiffies - handle->tx_drain_start);
+	if (!msecs)
+		return;
+	if (tx_bql_delay > 0) {
+		limit = handle->tx_drain_bytes / msecs * tx_bql_delay;
+		limit = MAX(limit, TX_BQL_MIN_LIMIT);
+	}
+	handle->tx_drain_bytes = 0;
+	handle->tx_drain_start = jiffies;
+	if (limit == handle->tx_bql_limit)
+		return;
+	handle->tx_bql_limit = limit;
+#ifdef CONFIG_BQL
+	for (i = 0; i < handle->priv_num; i++) {
+		if (!handle->priv[i] || !handle->priv[i]->netdev)
+			continue;
+		dev = handle->priv[i]->netdev;
+		for (q = 0; q < dev->num_tx_queues; q++)
+			netdev_get_tx_queue(dev, q)->dql.max_limit =
+				limit ? limit : DQL_MAX_LIMIT;
+	}
+#endif
+}
+
+/**
+ *  @brief This function charges a packet handed to MLAN to its AC's
+ *  byte queue limit, which stops the queue once the limit is reached
+ *
+ *  Must be called before mlan_send_packet(), which can complete the
+ *  packet before it returns.
+ *
+ *  @param priv    A pointer to moal_private structure
+ *  @param skb     A pointer to sk_buff structure
+ *
+ *  @return        N/A
+ */
+void
+woal_tx_bql_sent(moal_private *priv, struct sk_buff *skb)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 3, 0)
+	moal_handle *handle = priv->phandle;
+	unsigned long flags;
+
+	spin_lock_irqsave(&handle->tx_bql_lock, flags);
+	netdev_tx_sent_queue(netdev_get_tx_queue(priv->netdev,
+						 skb_get_queue_mapping(skb)),
+			     skb->len);
+	spin_unlock_irqrestore(&handle->tx_bql_lock, flags);
+#endif
+}
+
+/**
+ *  @brief This function returns a completed packet to its AC's byte
+ *  queue limit and feeds the SDIO drain rate measurement
+ *
+ *  @param priv    A pointer to moal_private structure
+ *  @param skb     A pointer to sk_buff structure
+ *
+ *  @return        N/A
+ */
+void
+woal_tx_bql_completed(moal_private *priv, struct sk_buff *skb)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 3, 0)
+	moal_handle *handle = priv->phandle;
+	unsigned long flags;
+
+	spin_lock_irqsave(&handle->tx_bql_lock, flags);
+	netdev_tx_completed_queue(netdev_get_tx_queue(priv->netdev,
+						      skb_get_queue_mapping
+						      (skb)), 1, skb->len);
+	handle->tx_drain_bytes += skb->len;
+	if (time_after_eq(jiffies, handle->tx_drain_start + TX_BQL_INTERVAL))
+		woal_tx_bql_update(handle);
+	spin_unlock_irqrestore(&handle->tx_bql_lock, flags);
+#endif
+}
+
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(2, 6, 33)
 static struct device_type wlan_type = {.name = "wlan", };
 #endif
@@ -3273,10 +3735,10 @@ woal_init_sta_dev(struct net_device *dev, moal_private *priv)
 #endif
 	dev->watchdog_timeo = MRVDRV_DEFAULT_WATCHDOG_TIMEOUT;
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 18, 0)
-	dev->needed_headroom += MLAN_MIN_DATA_HEADER_LEN + sizeof(mlan_buffer)
+	dev->needed_headroom += MLAN_MIN_DATA_HEADER_LEN
 		+ priv->extra_tx_head_len;
 #else
-	dev->hard_header_len += MLAN_MIN_DATA_HEADER_LEN + sizeof(mlan_buffer)
+	dev->hard_header_len += MLAN_MIN_DATA_HEADER_LEN
 		+ priv->extra_tx_head_len;
 #endif
 #ifdef STA_WEXT
@@ -3355,10 +3817,10 @@ woal_init_uap_dev(struct net_device *dev, moal_private *priv)
 #endif
 	dev->watchdog_timeo = MRVDRV_DEFAULT_UAP_WATCHDOG_TIMEOUT;
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 18, 0)
-	dev->needed_headroom += MLAN_MIN_DATA_HEADER_LEN + sizeof(mlan_buffer)
+	dev->needed_headroom += MLAN_MIN_DATA_HEADER_LEN
 		+ priv->extra_tx_head_len;
 #else
-	dev->hard_header_len += MLAN_MIN_DATA_HEADER_LEN + sizeof(mlan_buffer)
+	dev->hard_header_len += MLAN_MIN_DATA_HEADER_LEN
 		+ priv->extra_tx_head_len;
 #endif
 #ifdef UAP_WEXT
@@ -3478,7 +3940,7 @@ woal_add_interface(moal_handle *handle, t_u8 bss_index, t_u8 bss_type)
 	else if (bss_type == MLAN_BSS_TYPE_NAN)
 		priv->bss_role = MLAN_BSS_ROLE_STA;
 
-	INIT_LIST_HEAD(&priv->tcp_sess_queue);
+	woal_init_tcp_sess_queue(priv);
 	spin_lock_init(&priv->tcp_sess_lock);
 #ifdef STA_SUPPORT
 	INIT_LIST_HEAD(&priv->tdls_list);
@@ -4790,6 +5252,29 @@ woal_tdls_check_tx(moal_private *priv, struct sk_buff *skb)
 }
 #endif
 
+/**
+ *  @brief This function empties the tcp session hash, list and ack wheel
+ *
+ *  @param priv      A pointer to moal_private structure
+ *
+ *  @return          N/A
+ */
+static void
+woal_reset_tcp_sess_queue(moal_private *priv)
+{
+	int i;
+
+	INIT_LIST_HEAD(&priv->tcp_sess_queue);
+	for (i = 0; i < TCP_SESS_HASH_SIZE; i++)
+		INIT_HLIST_HEAD(&priv->tcp_sess_hash[i]);
+	for (i = 0; i < TCP_ACK_WHEEL_SIZE; i++)
+		INIT_LIST_HEAD(&priv->tcp_ack_wheel[i]);
+	priv->tcp_sess_num = 0;
+	priv->tcp_ack_held = 0;
+	priv->tcp_ack_wheel_pos = 0;
+	priv->tcp_ack_timer_set = MFALSE;
+}
+
 /**
  *  @brief This function flush tcp session queue
  *
@@ -4803,27 +5288,53 @@ woal_flush_tcp_sess_queue(moal_private *priv)
 	struct tcp_sess *tcp_sess = NULL, *tmp_node;
 	unsigned long flags;
 	struct sk_buff *skb;
+
+	/* Cancel before the reset: an ack held after the reset re-arms the
+	 * tick, and cancelling after the unlock would strand it with
+	 * tcp_ack_timer_set still MTRUE */
+	woal_cancel_timer(&priv->tcp_ack_timer);
 	spin_lock_irqsave(&priv->tcp_sess_lock, flags);
 	list_for_each_entry_safe(tcp_sess, tmp_node, &priv->tcp_sess_queue,
 				 link) {
-		list_del(&tcp_sess->link);
-		if (tcp_sess->is_timer_set)
-			woal_cancel_timer(&tcp_sess->ack_timer);
 		skb = (struct sk_buff *)tcp_sess->ack_skb;
-		if (skb)
+		if (skb) {
 			dev_kfree_skb_any(skb);
-		kfree(tcp_sess);
+			woal_free_tx_desc(priv->phandle,
+					  (mlan_buffer *)tcp_sess->pmbuf);
+		}
+		kmem_cache_free(tcp_sess_cache, tcp_sess);
 	}
-	INIT_LIST_HEAD(&priv->tcp_sess_queue);
+	woal_reset_tcp_sess_queue(priv);
 	priv->tcp_ack_drop_cnt = 0;
 	priv->tcp_ack_cnt = 0;
+	priv->tcp_ack_flush_cnt = 0;
+	priv->tcp_sess_evict_cnt = 0;
 	spin_unlock_irqrestore(&priv->tcp_sess_lock, flags);
 }
 
 /**
- *  @brief This function gets tcp session from the tcp session queue
+ *  @brief This function hashes a tcp session 4-tuple
+ *
+ *  @param src_ip    IP address of the device
+ *  @param src_port  TCP port of the device
+ *  @param dst_ip    IP address of the client
+ *  @param dst_port  TCP port of the client
+ *
+ *  @return          Hash bucket index
+ */
+static inline t_u32
+woal_tcp_sess_hash(t_u32 src_ip, t_u16 src_port, t_u32 dst_ip, t_u16 dst_port)
+{
+	return jhash_3words(src_ip, dst_ip,
+			    ((t_u32)src_port << 16) | dst_port,
+			    0) & (TCP_SESS_HASH_SIZE - 1);
+}
+
+/**
+ *  @brief This function gets tcp session from the tcp session hash
  *
  *  @param priv      A pointer to moal_private structure
+ *  @param hash      Hash bucket index of the session
  *  @param src_ip    IP address of the device
  *  @param src_port  TCP port of the device
  *  @param dst_ip    IP address of the client
@@ -4833,13 +5344,15 @@ woal_flush_tcp_sess_queue(moal_private *priv)
  *                   Otherwise, null
  */
 static inline struct tcp_sess *
-woal_get_tcp_sess(moal_private *priv,
+woal_get_tcp_sess(moal_private *priv, t_u32 hash,
 		  t_u32 src_ip, t_u16 src_port, t_u32 dst_ip, t_u16 dst_port)
 {
 	struct tcp_sess *tcp_sess = NULL;
+	struct hlist_node *node;
 	ENTER();
 
-	list_for_each_entry(tcp_sess, &priv->tcp_sess_queue, link) {
+	for (node = priv->tcp_sess_hash[hash].first; node; node = node->next) {
+		tcp_sess = hlist_entry(node, struct tcp_sess, hlink);
 		if ((tcp_sess->src_ip_addr == src_ip) &&
 		    (tcp_sess->src_tcp_port == src_port) &&
 		    (tcp_sess->dst_ip_addr == dst_ip) &&
@@ -4853,97 +5366,120 @@ woal_get_tcp_sess(moal_private *priv,
 }
 
 /**
- *  @brief This function send the holding tcp ack packet
- *  re-assoc thread.
+ *  @brief This function allocates a tcp session, evicting idle ones
  *
- *  @param context  A pointer to context
- *  @return         N/A
+ *  Sessions are kept least recently used first, so eviction stops at the
+ *  first session that is recent or still holds an ack. When the table is
+ *  full the oldest session is evicted even if it is not yet idle.
+ *
+ *  @param priv      A pointer to moal_private structure
+ *
+ *  @return          A pointer to the new tcp session, or NULL
  */
-void
-woal_tcp_ack_timer_func(void *context)
+static struct tcp_sess *
+woal_alloc_tcp_sess(moal_private *priv)
 {
-	struct tcp_sess *tcp_session = (struct tcp_sess *)context;
-	moal_private *priv = (moal_private *)tcp_session->priv;
-	unsigned long flags;
-	mlan_buffer *pmbuf;
-	struct sk_buff *skb;
-	mlan_status status;
-#if LINUX_VERSION_CODE > KERNEL_VERSION(2, 6, 29)
-	t_u32 index = 0;
-#endif
-	ENTER();
-	spin_lock_irqsave(&priv->tcp_sess_lock, flags);
-	tcp_session->is_timer_set = MFALSE;
-	skb = (struct sk_buff *)tcp_session->ack_skb;
-	pmbuf = (mlan_buffer *)tcp_session->pmbuf;
-	tcp_session->ack_skb = NULL;
-	tcp_session->pmbuf = NULL;
-	spin_unlock_irqrestore(&priv->tcp_sess_lock, flags);
-	if (skb && pmbuf) {
-		status = mlan_send_packet(priv->phandle->pmlan_adapter, pmbuf);
-		switch (status) {
-		case MLAN_STATUS_PENDING:
-			atomic_inc(&priv->phandle->tx_pending);
-#if LINUX_VERSION_CODE > KERNEL_VERSION(2, 6, 29)
-			index = skb_get_queue_mapping(skb);
-			atomic_inc(&priv->wmm_tx_pending[index]);
-			if (atomic_read(&priv->wmm_tx_pending[index]) >=
-			    MAX_TX_PENDING) {
-				struct netdev_queue *txq =
-					netdev_get_tx_queue(priv->netdev,
-							    index);
-				netif_tx_stop_queue(txq);
-				PRINTM(MINFO, "Stop Kernel Queue : %d\n",
-				       index);
-			}
-#else
-			if (atomic_read(&priv->phandle->tx_pending) >=
-			    MAX_TX_PENDING)
-				woal_stop_queue(priv->netdev);
-#endif /*#if LINUX_VERSION_CODE > KERNEL_VERSION(2,6,29) */
-			queue_work(priv->phandle->workqueue,
-				   &priv->phandle->main_work);
-			break;
-		case MLAN_STATUS_SUCCESS:
-			priv->stats.tx_packets++;
-			priv->stats.tx_bytes += skb->len;
-			dev_kfree_skb_any(skb);
+	struct tcp_sess *tcp_sess = NULL;
+
+	while (!list_empty(&priv->tcp_sess_queue)) {
+		tcp_sess = list_first_entry(&priv->tcp_sess_queue,
+					    struct tcp_sess, link);
+		if (tcp_sess->ack_skb)
 			break;
-		case MLAN_STATUS_FAILURE:
-		default:
-			priv->stats.tx_dropped++;
-			dev_kfree_skb_any(skb);
+		if ((priv->tcp_sess_num < TCP_SESS_MAX) &&
+		    time_before(jiffies,
+				tcp_sess->last_ack + TCP_SESS_IDLE_TIMEOUT))
 			break;
-		}
+		hlist_del(&tcp_sess->hlink);
+		list_del(&tcp_sess->link);
+		kmem_cache_free(tcp_sess_cache, tcp_sess);
+		priv->tcp_sess_num--;
+		priv->tcp_sess_evict_cnt++;
 	}
-	LEAVE();
-	return;
-}
+	if (!tcp_sess_cache || priv->tcp_sess_num >= TCP_SESS_MAX)
+		return NULL;
+	tcp_sess = kmem_cache_alloc(tcp_sess_cache, GFP_ATOMIC);
+	if (!tcp_sess) {
+		PRINTM(MERROR, "Fail to allocate tcp_sess.\n");
+		return NULL;
+	}
+	tcp_sess->ack_skb = NULL;
+	INIT_LIST_HEAD(&tcp_sess->wheel_link);
+	priv->tcp_sess_num++;
+	return tcp_sess;
+}
 
 /**
- *  @brief This function send the tcp ack
+ *  @brief This function holds a tcp ack on the ack wheel
  *
+ *  @param priv         A pointer to moal_private structure
+ *  @param tcp_session  A pointer to tcp_session
+ *  @param pmbuf        A pointer to mlan_buffer of the ack
+ *  @param ack_seq      Ack sequence number of the ack
+ *
+ *  @return             N/A
+ */
+static void
+woal_tcp_ack_hold(moal_private *priv, struct tcp_sess *tcp_session,
+		  mlan_buffer *pmbuf, t_u32 ack_seq)
+{
+	struct sk_buff *skb = (struct sk_buff *)pmbuf->pdesc;
+	t_u32 slot;
+
+	tcp_session->ack_skb = skb;
+	tcp_session->pmbuf = pmbuf;
+	tcp_session->ack_seq = ack_seq;
+	pmbuf->flags |= MLAN_BUF_FLAG_TCP_ACK;
+	skb->cb[0] = 0;
+	slot = (priv->tcp_ack_wheel_pos + TCP_ACK_HOLD_TICKS) &
+		(TCP_ACK_WHEEL_SIZE - 1);
+	list_add_tail(&tcp_session->wheel_link, &priv->tcp_ack_wheel[slot]);
+	priv->tcp_ack_held++;
+	if (!priv->tcp_ack_timer_set) {
+		priv->tcp_ack_timer_set = MTRUE;
+		woal_mod_timer(&priv->tcp_ack_timer, MOAL_TIMER_1MS);
+	}
+}
+
+/**
+ *  @brief This function takes the held tcp ack off the ack wheel
  *
  *  @param priv         A pointer to moal_private structure
  *  @param tcp_session  A pointer to tcp_session
+ *
+ *  @return             The held ack mlan_buffer
+ */
+static mlan_buffer *
+woal_tcp_ack_unhold(moal_private *priv, struct tcp_sess *tcp_session)
+{
+	mlan_buffer *pmbuf = (mlan_buffer *)tcp_session->pmbuf;
+
+	tcp_session->ack_skb = NULL;
+	tcp_session->pmbuf = NULL;
+	list_del_init(&tcp_session->wheel_link);
+	priv->tcp_ack_held--;
+	priv->tcp_ack_flush_cnt++;
+	return pmbuf;
+}
+
+/**
+ *  @brief This function send the tcp ack
+ *
+ *
+ *  @param priv         A pointer to moal_private structure
+ *  @param pmbuf        A pointer to mlan_buffer of the held ack
  *  @return         N/A
  */
-void
-woal_send_tcp_ack(moal_private *priv, struct tcp_sess *tcp_session)
+static void
+woal_send_tcp_ack(moal_private *priv, mlan_buffer *pmbuf)
 {
 	mlan_status status;
-	struct sk_buff *skb = (struct sk_buff *)tcp_session->ack_skb;
-	mlan_buffer *pmbuf = (mlan_buffer *)tcp_session->pmbuf;
+	struct sk_buff *skb = (struct sk_buff *)pmbuf->pdesc;
 #if LINUX_VERSION_CODE > KERNEL_VERSION(2, 6, 29)
 	t_u32 index = 0;
 #endif
 	ENTER();
-	if (tcp_session->is_timer_set) {
-		woal_cancel_timer(&tcp_session->ack_timer);
-		tcp_session->is_timer_set = MFALSE;
-	}
-	tcp_session->ack_skb = NULL;
-	tcp_session->pmbuf = NULL;
+	woal_tx_bql_sent(priv, skb);
 	status = mlan_send_packet(priv->phandle->pmlan_adapter, pmbuf);
 	switch (status) {
 	case MLAN_STATUS_PENDING:
@@ -4964,19 +5500,80 @@ woal_send_tcp_ack(moal_private *priv, struct tcp_sess *tcp_session)
 		queue_work(priv->phandle->workqueue, &priv->phandle->main_work);
 		break;
 	case MLAN_STATUS_SUCCESS:
+		woal_tx_bql_completed(priv, skb);
 		priv->stats.tx_packets++;
 		priv->stats.tx_bytes += skb->len;
 		dev_kfree_skb_any(skb);
+		woal_free_tx_desc(priv->phandle, pmbuf);
 		break;
 	case MLAN_STATUS_FAILURE:
 	default:
+		woal_tx_bql_completed(priv, skb);
 		priv->stats.tx_dropped++;
 		dev_kfree_skb_any(skb);
+		woal_free_tx_desc(priv->phandle, pmbuf);
 		break;
 	}
 	LEAVE();
 }
 
+/**
+ *  @brief This function advances the ack wheel and sends the tcp acks
+ *  held in the slot it lands on
+ *
+ *  @param context  A pointer to moal_private structure
+ *  @return         N/A
+ */
+void
+woal_tcp_ack_timer_func(void *context)
+{
+	moal_private *priv = (moal_private *)context;
+	struct tcp_sess *tcp_session, *tmp_node;
+	mlan_buffer *flush_q = NULL;
+	mlan_buffer *pmbuf;
+	struct list_head *slot;
+	unsigned long flags;
+
+	ENTER();
+	spin_lock_irqsave(&priv->tcp_sess_lock, flags);
+	priv->tcp_ack_wheel_pos = (priv->tcp_ack_wheel_pos + 1) &
+		(TCP_ACK_WHEEL_SIZE - 1);
+	slot = &priv->tcp_ack_wheel[priv->tcp_ack_wheel_pos];
+	list_for_each_entry_safe(tcp_session, tmp_node, slot, wheel_link) {
+		pmbuf = woal_tcp_ack_unhold(priv, tcp_session);
+		pmbuf->pnext = flush_q;
+		flush_q = pmbuf;
+	}
+	/* Tick only while acks are held */
+	if (priv->tcp_ack_held)
+		woal_mod_timer(&priv->tcp_ack_timer, MOAL_TIMER_1MS);
+	else
+		priv->tcp_ack_timer_set = MFALSE;
+	spin_unlock_irqrestore(&priv->tcp_sess_lock, flags);
+	while (flush_q) {
+		pmbuf = flush_q;
+		flush_q = pmbuf->pnext;
+		pmbuf->pnext = NULL;
+		woal_send_tcp_ack(priv, pmbuf);
+	}
+	LEAVE();
+}
+
+/**
+ *  @brief This function initializes tcp session queue
+ *
+ *  @param priv      A pointer to moal_private structure
+ *
+ *  @return          N/A
+ */
+void
+woal_init_tcp_sess_queue(moal_private *priv)
+{
+	woal_reset_tcp_sess_queue(priv);
+	woal_initialize_timer(&priv->tcp_ack_timer, woal_tcp_ack_timer_func,
+			      priv);
+}
+
 /**
  *  @brief This function get the tcp ack session node
  *
@@ -4995,7 +5592,9 @@ woal_process_tcp_ack(moal_private *priv, mlan_buffer *pmbuf)
 	struct iphdr *iph = NULL;
 	struct tcphdr *tcph = NULL;
 	t_u32 ack_seq;
+	t_u32 hash;
 	struct sk_buff *skb;
+	mlan_buffer *send_pmbuf = NULL;
 
 	ENTER();
 
@@ -5021,58 +5620,40 @@ woal_process_tcp_ack(moal_private *priv, mlan_buffer *pmbuf)
 			return ret;
 		}
 		priv->tcp_ack_cnt++;
+		ack_seq = ntohl(tcph->ack_seq);
+		hash = woal_tcp_sess_hash(iph->saddr, tcph->source, iph->daddr,
+					  tcph->dest);
 		spin_lock_irqsave(&priv->tcp_sess_lock, flags);
-		tcp_session = woal_get_tcp_sess(priv, iph->saddr,
+		tcp_session = woal_get_tcp_sess(priv, hash, iph->saddr,
 						tcph->source, iph->daddr,
 						tcph->dest);
 		if (!tcp_session) {
-			tcp_session =
-				kmalloc(sizeof(struct tcp_sess), GFP_ATOMIC);
+			tcp_session = woal_alloc_tcp_sess(priv);
 			if (!tcp_session) {
-				PRINTM(MERROR, "Fail to allocate tcp_sess.\n");
 				spin_unlock_irqrestore(&priv->tcp_sess_lock,
 						       flags);
 				goto done;
 			}
-			tcp_session->ack_skb = pmbuf->pdesc;
-			tcp_session->pmbuf = pmbuf;
-			pmbuf->flags |= MLAN_BUF_FLAG_TCP_ACK;
 			tcp_session->src_ip_addr = iph->saddr;
 			tcp_session->dst_ip_addr = iph->daddr;
 			tcp_session->src_tcp_port = tcph->source;
 			tcp_session->dst_tcp_port = tcph->dest;
-			tcp_session->ack_seq = ntohl(tcph->ack_seq);
-			tcp_session->priv = (void *)priv;
-			skb = (struct sk_buff *)pmbuf->pdesc;
-			skb->cb[0] = 0;
-			/* Initialize the timer for tcp ack */
-			woal_initialize_timer(&tcp_session->ack_timer,
-					      woal_tcp_ack_timer_func,
-					      tcp_session);
-			tcp_session->is_timer_set = MTRUE;
-			woal_mod_timer(&tcp_session->ack_timer, MOAL_TIMER_1MS);
+			hlist_add_head(&tcp_session->hlink,
+				       &priv->tcp_sess_hash[hash]);
 			list_add_tail(&tcp_session->link,
 				      &priv->tcp_sess_queue);
-			spin_unlock_irqrestore(&priv->tcp_sess_lock, flags);
-			ret = HOLD_TCP_ACK;
-			LEAVE();
-			return ret;
-		} else if (!tcp_session->ack_skb) {
-			tcp_session->ack_skb = pmbuf->pdesc;
-			tcp_session->pmbuf = pmbuf;
-			pmbuf->flags |= MLAN_BUF_FLAG_TCP_ACK;
-			tcp_session->ack_seq = ntohl(tcph->ack_seq);
-			tcp_session->priv = (void *)priv;
-			skb = (struct sk_buff *)pmbuf->pdesc;
-			skb->cb[0] = 0;
-			tcp_session->is_timer_set = MTRUE;
-			woal_mod_timer(&tcp_session->ack_timer, MOAL_TIMER_1MS);
+		} else {
+			list_move_tail(&tcp_session->link,
+				       &priv->tcp_sess_queue);
+		}
+		tcp_session->last_ack = jiffies;
+		if (!tcp_session->ack_skb) {
+			woal_tcp_ack_hold(priv, tcp_session, pmbuf, ack_seq);
 			spin_unlock_irqrestore(&priv->tcp_sess_lock, flags);
 			ret = HOLD_TCP_ACK;
 			LEAVE();
 			return ret;
 		}
-		ack_seq = ntohl(tcph->ack_seq);
 		skb = (struct sk_buff *)tcp_session->ack_skb;
 		if (likely(ack_seq > tcp_session->ack_seq) &&
 		    (skb->len == pmbuf->data_len)) {
@@ -5084,10 +5665,14 @@ woal_process_tcp_ack(moal_private *priv, mlan_buffer *pmbuf)
 //We will drop 90% tcp ack
 #define TCP_ACK_MAX_HOLD    9
 			if (skb->cb[0] >= TCP_ACK_MAX_HOLD)
-				woal_send_tcp_ack(priv, tcp_session);
+				send_pmbuf = woal_tcp_ack_unhold(priv,
+								 tcp_session);
 			spin_unlock_irqrestore(&priv->tcp_sess_lock, flags);
+			if (send_pmbuf)
+				woal_send_tcp_ack(priv, send_pmbuf);
 			skb = (struct sk_buff *)pmbuf->pdesc;
 			dev_kfree_skb_any(skb);
+			woal_free_tx_desc(priv->phandle, pmbuf);
 			priv->tcp_ack_drop_cnt++;
 		} else {
 			pmbuf->flags |= MLAN_BUF_FLAG_TCP_ACK;
@@ -5138,15 +5723,20 @@ woal_hard_start_xmit(struct sk_buff *skb, struct net_device *dev)
 		priv->stats.tx_dropped++;
 		goto done;
 	}
-	if (skb->cloned || (skb_headroom(skb) < (MLAN_MIN_DATA_HEADER_LEN +
-						 sizeof(mlan_buffer) +
-						 priv->extra_tx_head_len))) {
+	/*
+	 * The mlan_buffer lives in a separate descriptor, so only the TxPD
+	 * goes into the headroom. That is safe on a clone whose header is
+	 * not shared, e.g. TCP data still on the retransmit queue.
+	 */
+	if (skb_header_cloned(skb) ||
+	    (skb_headroom(skb) <
+	     (MLAN_MIN_DATA_HEADER_LEN + priv->extra_tx_head_len))) {
 		PRINTM(MWARN,
 		       "Tx: skb cloned %d or Insufficient skb headroom %d\n",
 		       skb->cloned, skb_headroom(skb));
+		atomic_inc(&priv->phandle->tx_copy_required);
 		/* Insufficient skb headroom - allocate a new skb */
 		new_skb = skb_realloc_headroom(skb, MLAN_MIN_DATA_HEADER_LEN +
-					       sizeof(mlan_buffer) +
 					       priv->extra_tx_head_len);
 		if (unlikely(!new_skb)) {
 			PRINTM(MERROR, "Tx: Cannot allocate skb\n");
@@ -5158,9 +5748,20 @@ woal_hard_start_xmit(struct sk_buff *skb, struct net_device *dev)
 			dev_kfree_skb_any(skb);
 		skb = new_skb;
 		PRINTM(MINFO, "new skb headroom %d\n", skb_headroom(skb));
+	} else if (skb->cloned ||
+		   (skb_headroom(skb) < (MLAN_MIN_DATA_HEADER_LEN +
+					 sizeof(mlan_buffer) +
+					 priv->extra_tx_head_len))) {
+		/* Would have been copied with the descriptor in the skb */
+		atomic_inc(&priv->phandle->tx_copy_avoided);
+	}
+	pmbuf = woal_alloc_tx_desc(priv->phandle);
+	if (!pmbuf) {
+		PRINTM(MERROR, "Tx: Cannot allocate descriptor\n");
+		dev_kfree_skb_any(skb);
+		priv->stats.tx_dropped++;
+		goto done;
 	}
-	pmbuf = (mlan_buffer *)skb->head;
-	memset((t_u8 *)pmbuf, 0, sizeof(mlan_buffer));
 	pmbuf->bss_index = priv->bss_index;
 	woal_fill_mlan_buffer(priv, pmbuf, skb);
 	if (priv->enable_tcp_ack_enh == MTRUE) {
@@ -5178,6 +5779,7 @@ woal_hard_start_xmit(struct sk_buff *skb, struct net_device *dev)
 	index = skb_get_queue_mapping(skb);
 #endif
 
+	woal_tx_bql_sent(priv, skb);
 	status = mlan_send_packet(priv->phandle->pmlan_adapter, pmbuf);
 	switch (status) {
 	case MLAN_STATUS_PENDING:
@@ -5199,14 +5801,18 @@ woal_hard_start_xmit(struct sk_buff *skb, struct net_device *dev)
 				    &priv->phandle->main_work);
 		break;
 	case MLAN_STATUS_SUCCESS:
+		woal_tx_bql_completed(priv, skb);
 		priv->stats.tx_packets++;
 		priv->stats.tx_bytes += skb->len;
 		dev_kfree_skb_any(skb);
+		woal_free_tx_desc(priv->phandle, pmbuf);
 		break;
 	case MLAN_STATUS_FAILURE:
 	default:
+		woal_tx_bql_completed(priv, skb);
 		priv->stats.tx_dropped++;
 		dev_kfree_skb_any(skb);
+		woal_free_tx_desc(priv->phandle, pmbuf);
 		break;
 	}
 done:
@@ -5717,6 +6323,328 @@ woal_bss_index_to_priv(moal_handle *handle, t_u8 bss_index)
 	return NULL;
 }
 
+/**
+ *  @brief This function allocates a buffer sized for the RX recycle pool
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *  @param flag    GFP flags
+ *
+ *  @return        sk_buff pointer or NULL
+ */
+static struct sk_buff *
+woal_rx_pool_alloc_skb(moal_handle *handle, gfp_t flag)
+{
+	struct sk_buff *skb;
+
+	skb = __dev_alloc_skb(MOAL_RX_POOL_BUF_SIZE + sizeof(mlan_buffer),
+			      flag);
+	if (skb)
+		handle->rx_pool_end = skb_end_pointer(skb) - skb->head;
+	return skb;
+}
+
+/**
+ *  @brief This function gets a buffer from the RX recycle pool,
+ *         trying the local CPU cache first
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        sk_buff pointer or NULL if the pool is empty
+ */
+static struct sk_buff *
+woal_rx_pool_get(moal_handle *handle)
+{
+	moal_rx_pool_cache *cache;
+	struct sk_buff *skb = NULL;
+	unsigned long flags;
+
+	if (handle->rx_pool_cache) {
+		local_irq_save(flags);
+		cache = per_cpu_ptr(handle->rx_pool_cache, smp_processor_id());
+		if (cache->count)
+			skb = cache->skb[--cache->count];
+		local_irq_restore(flags);
+	}
+	if (!skb)
+		skb = skb_dequeue(&handle->rx_pool);
+	return skb;
+}
+
+/**
+ *  @brief This function puts a recycled buffer back into the state
+ *         __dev_alloc_skb returned it in
+ *
+ *  Pool buffers are only ever freed by MLAN and never reach the stack,
+ *  so no conntrack, dst or extension references are held on them.
+ *
+ *  @param skb     A pointer to sk_buff structure
+ *
+ *  @return        N/A
+ */
+static void
+woal_rx_pool_reinit_skb(struct sk_buff *skb)
+{
+	struct skb_shared_info *shinfo = skb_shinfo(skb);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 6, 0)
+	t_u8 head_frag = skb->head_frag;
+	t_u8 pfmemalloc = skb->pfmemalloc;
+#endif
+
+	memset(shinfo, 0, offsetof(struct skb_shared_info, dataref));
+	atomic_set(&shinfo->dataref, 1);
+
+	memset(skb, 0, offsetof(struct sk_buff, tail));
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 6, 0)
+	skb->head_frag = head_frag;
+	skb->pfmemalloc = pfmemalloc;
+#endif
+	skb->data = skb->head + NET_SKB_PAD;
+	skb_reset_tail_pointer(skb);
+	skb->mac_header = (typeof(skb->mac_header))~0U;
+	skb->transport_header = (typeof(skb->transport_header))~0U;
+}
+
+/**
+ *  @brief This function returns a freed buffer to the RX recycle pool
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *  @param skb     A pointer to sk_buff structure
+ *
+ *  @return        MTRUE if recycled, MFALSE if the caller must free it
+ */
+static t_u8
+woal_rx_pool_put(moal_handle *handle, struct sk_buff *skb)
+{
+	moal_rx_pool_cache *cache;
+	unsigned long flags;
+	t_u8 cached = MFALSE;
+
+	if (!handle->rx_pool_end ||
+	    (unsigned int)(skb_end_pointer(skb) - skb->head) !=
+	    handle->rx_pool_end || skb_cloned(skb) || skb_shared(skb) ||
+	    skb_is_nonlinear(skb) || skb->destructor)
+		return MFALSE;
+
+	woal_rx_pool_reinit_skb(skb);
+
+	if (handle->rx_pool_cache) {
+		local_irq_save(flags);
+		cache = per_cpu_ptr(handle->rx_pool_cache, smp_processor_id());
+		if (cache->count < MOAL_RX_POOL_CACHE_SIZE) {
+			cache->skb[cache->count++] = skb;
+			cached = MTRUE;
+		}
+		local_irq_restore(flags);
+	}
+	if (!cached) {
+		if (skb_queue_len(&handle->rx_pool) >=
+		    MOAL_RX_POOL_HIGH_WATERMARK)
+			return MFALSE;
+		skb_queue_tail(&handle->rx_pool, skb);
+	}
+	atomic_inc(&handle->rx_pool_recycle);
+	return MTRUE;
+}
+
+/**
+ *  @brief This function refills the RX recycle pool once it drops
+ *         below the low watermark
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        N/A
+ */
+void
+woal_rx_pool_refill(moal_handle *handle)
+{
+	struct sk_buff *skb;
+
+	if (skb_queue_len(&handle->rx_pool) >= MOAL_RX_POOL_LOW_WATERMARK)
+		return;
+	while (skb_queue_len(&handle->rx_pool) < MOAL_RX_POOL_REFILL) {
+		skb = woal_rx_pool_alloc_skb(handle, GFP_KERNEL);
+		if (!skb)
+			break;
+		skb_queue_tail(&handle->rx_pool, skb);
+	}
+}
+
+/**
+ *  @brief This function initializes the RX recycle pool
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        N/A
+ */
+void
+woal_rx_pool_init(moal_handle *handle)
+{
+	skb_queue_head_init(&handle->rx_pool);
+	handle->rx_pool_cache = alloc_percpu(moal_rx_pool_cache);
+	if (!handle->rx_pool_cache)
+		PRINTM(MWARN, "RX pool: no per-CPU cache\n");
+}
+
+/**
+ *  @brief This function frees all buffers of the RX recycle pool
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        N/A
+ */
+void
+woal_rx_pool_free(moal_handle *handle)
+{
+	moal_rx_pool_cache *cache;
+	int cpu;
+
+	skb_queue_purge(&handle->rx_pool);
+	if (handle->rx_pool_cache) {
+		for_each_possible_cpu(cpu) {
+			cache = per_cpu_ptr(handle->rx_pool_cache, cpu);
+			while (cache->count)
+				dev_kfree_skb_any(cache->skb[--cache->count]);
+		}
+		free_percpu(handle->rx_pool_cache);
+		handle->rx_pool_cache = NULL;
+	}
+	handle->rx_pool_end = 0;
+}
+
+/**
+ *  @brief This function initializes the per-CPU rx batches
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        N/A
+ */
+void
+woal_rx_batch_init(moal_handle *handle)
+{
+	int cpu;
+
+	handle->rx_batch = alloc_percpu(moal_rx_batch);
+	if (!handle->rx_batch) {
+		PRINTM(MWARN, "RX batch: no per-CPU batch\n");
+		return;
+	}
+	for_each_possible_cpu(cpu)
+		__skb_queue_head_init(&per_cpu_ptr(handle->rx_batch, cpu)->q);
+}
+
+/**
+ *  @brief This function frees the per-CPU rx batches
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        N/A
+ */
+void
+woal_rx_batch_free(moal_handle *handle)
+{
+	int cpu;
+
+	if (!handle->rx_batch)
+		return;
+	for_each_possible_cpu(cpu)
+		__skb_queue_purge(&per_cpu_ptr(handle->rx_batch, cpu)->q);
+	free_percpu(handle->rx_batch);
+	handle->rx_batch = NULL;
+}
+
+/**
+ *  @brief This function allocates a TX descriptor for a kernel skb
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        mlan_buffer pointer or NULL
+ */
+pmlan_buffer
+woal_alloc_tx_desc(moal_handle *handle)
+{
+	pmlan_buffer pmbuf;
+
+	if (handle->tx_desc_pool)
+		pmbuf = mempool_alloc(handle->tx_desc_pool, GFP_ATOMIC);
+	else
+		pmbuf = kmem_cache_alloc(tx_desc_cache, GFP_ATOMIC);
+	if (pmbuf) {
+		memset((t_u8 *)pmbuf, 0, sizeof(mlan_buffer));
+		pmbuf->flags = MLAN_BUF_FLAG_TX_DESC;
+	}
+	return pmbuf;
+}
+
+/**
+ *  @brief This function frees a TX descriptor
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *  @param pmbuf   A pointer to mlan_buffer from woal_alloc_tx_desc
+ *
+ *  @return        N/A
+ */
+void
+woal_free_tx_desc(moal_handle *handle, pmlan_buffer pmbuf)
+{
+	if (handle->tx_desc_pool)
+		mempool_free(pmbuf, handle->tx_desc_pool);
+	else
+		kmem_cache_free(tx_desc_cache, pmbuf);
+}
+
+/**
+ *  @brief This function initializes the TX descriptor pool
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        N/A
+ */
+void
+woal_tx_desc_pool_init(moal_handle *handle)
+{
+	handle->tx_desc_pool = mempool_create_slab_pool(MOAL_TX_DESC_POOL_MIN,
+							tx_desc_cache);
+	if (!handle->tx_desc_pool)
+		PRINTM(MWARN, "TX desc: no reserve\n");
+}
+
+/**
+ *  @brief This function frees the TX descriptor pool
+ *
+ *  @param handle  A pointer to moal_handle structure
+ *
+ *  @return        N/A
+ */
+void
+woal_tx_desc_pool_free(moal_handle *handle)
+{
+	if (handle->tx_desc_pool) {
+		mempool_destroy(handle->tx_desc_pool);
+		handle->tx_desc_pool = NULL;
+	}
+}
+
+/**
+ *  @brief This function wraps an skb allocated for MLAN into mlan_buffer.
+ *  @param handle  A pointer to moal_handle structure
+ *  @param skb     A pointer to sk_buff structure
+ *
+ *  @return        mlan_buffer pointer
+ */
+static pmlan_buffer
+woal_skb_to_mlan_buffer(moal_handle *handle, struct sk_buff *skb)
+{
+	mlan_buffer *pmbuf = NULL;
+
+	skb_reserve(skb, sizeof(mlan_buffer));
+	pmbuf = (mlan_buffer *)skb->head;
+	memset((u8 *)pmbuf, 0, sizeof(mlan_buffer));
+	pmbuf->pdesc = (t_void *)skb;
+	pmbuf->pbuf = (t_u8 *)skb->data;
+	atomic_inc(&handle->mbufalloc_count);
+	return pmbuf;
+}
+
 /**
  *  @brief This function alloc mlan_buffer.
  *  @param handle  A pointer to moal_handle structure
@@ -5728,7 +6656,7 @@ pmlan_buffer
 woal_alloc_mlan_buffer(moal_handle *handle, int size)
 {
 	mlan_buffer *pmbuf = NULL;
-	struct sk_buff *skb;
+	struct sk_buff *skb = NULL;
 	gfp_t flag;
 
 	ENTER();
@@ -5746,12 +6674,50 @@ woal_alloc_mlan_buffer(moal_handle *handle, int size)
 		LEAVE();
 		return NULL;
 	}
-	skb_reserve(skb, sizeof(mlan_buffer));
-	pmbuf = (mlan_buffer *)skb->head;
-	memset((u8 *)pmbuf, 0, sizeof(mlan_buffer));
-	pmbuf->pdesc = (t_void *)skb;
-	pmbuf->pbuf = (t_u8 *)skb->data;
-	atomic_inc(&handle->mbufalloc_count);
+	pmbuf = woal_skb_to_mlan_buffer(handle, skb);
+	LEAVE();
+	return pmbuf;
+}
+
+/**
+ *  @brief This function alloc mlan_buffer from the RX recycle pool.
+ *         Only for buffers MLAN frees itself, stack-bound frames go
+ *         through woal_alloc_mlan_buffer so their truesize stays exact.
+ *  @param handle  A pointer to moal_handle structure
+ *  @param size	   buffer size to allocate
+ *
+ *  @return        mlan_buffer pointer or NULL
+ */
+pmlan_buffer
+woal_alloc_pool_mlan_buffer(moal_handle *handle, int size)
+{
+	mlan_buffer *pmbuf = NULL;
+	struct sk_buff *skb = NULL;
+	gfp_t flag;
+
+	ENTER();
+
+	if (size <= 0 || size > MOAL_RX_POOL_BUF_SIZE) {
+		pmbuf = woal_alloc_mlan_buffer(handle, size);
+		LEAVE();
+		return pmbuf;
+	}
+
+	skb = woal_rx_pool_get(handle);
+	if (skb) {
+		atomic_inc(&handle->rx_pool_hit);
+	} else {
+		atomic_inc(&handle->rx_pool_miss);
+		flag = (in_atomic() || irqs_disabled())? GFP_ATOMIC :
+			GFP_KERNEL;
+		skb = woal_rx_pool_alloc_skb(handle, flag);
+	}
+	if (!skb) {
+		PRINTM(MERROR, "%s: No free skb\n", __func__);
+		LEAVE();
+		return NULL;
+	}
+	pmbuf = woal_skb_to_mlan_buffer(handle, skb);
 	LEAVE();
 	return pmbuf;
 }
@@ -5802,9 +6768,10 @@ woal_free_mlan_buffer(moal_handle *handle, pmlan_buffer pmbuf)
 		LEAVE();
 		return;
 	}
-	if (pmbuf->pdesc)
-		dev_kfree_skb_any((struct sk_buff *)pmbuf->pdesc);
-	else
+	if (pmbuf->pdesc) {
+		if (!woal_rx_pool_put(handle, (struct sk_buff *)pmbuf->pdesc))
+			dev_kfree_skb_any((struct sk_buff *)pmbuf->pdesc);
+	} else
 		PRINTM(MERROR, "free mlan buffer without pdesc\n");
 	atomic_dec(&handle->mbufalloc_count);
 	LEAVE();
@@ -7938,9 +8905,16 @@ woal_netdev_poll_rx(struct napi_struct *napi, int budget)
 		LEAVE();
 		return 0;
 	}
+	handle->napi_poll_cnt++;
+	handle->napi_poll_cpu = raw_smp_processor_id();
 	mlan_rx_process(handle->pmlan_adapter, &recv);
-	if (recv < budget)
+	handle->napi_poll_cpu = -1;
+	handle->napi_rx_pkts += recv;
+	if (recv < budget) {
+		handle->napi_complete_cnt++;
 		napi_complete(napi);
+	} else
+		handle->napi_budget_exhausted++;
 	LEAVE();
 	return recv;
 }
@@ -8121,6 +9095,7 @@ woal_main_work_queue(struct work_struct *work)
 #if LINUX_VERSION_CODE < KERNEL_VERSION(2, 6, 32)
 	sdio_claim_host(((struct sdio_mmc_card *)handle->card)->func);
 #endif
+	woal_rx_pool_refill(handle);
 	handle->main_state = MOAL_START_MAIN_PROCESS;
 	/* Call MLAN main process */
 	mlan_main_process(handle->pmlan_adapter);
@@ -8211,6 +9186,7 @@ woal_add_card(void *card)
 
 	/* Init moal_handle */
 	handle->card = card;
+	woal_init_phase(handle, "probe");
 	/* Save the handle */
 	m_handle[index] = handle;
 	handle->handle_idx = index;
@@ -8231,6 +9207,10 @@ woal_add_card(void *card)
 	}
 
 	handle->histogram_table_num = 3;
+	woal_rx_pool_init(handle);
+	woal_tx_desc_pool_init(handle);
+	woal_rx_batch_init(handle);
+	handle->napi_poll_cpu = -1;
 
 	((struct sdio_mmc_card *)card)->handle = handle;
 #ifdef SPI_SUPPORT
@@ -8912,6 +9892,7 @@ woal_init_module(void)
 
 	ENTER();
 
+	moal_get_boot_ktime(NULL, &insmod_ns);
 	PRINTM(MMSG, "wlan: Loading MWLAN driver\n");
 	/* Init the wlan_private pointer array first */
 	for (index = 0; index < MAX_MLAN_ADAPTER; index++)
@@ -8939,12 +9920,33 @@ woal_init_module(void)
 #endif
 	MLAN_INIT_WORK(&hang_work, woal_hang_work_queue);
 
-	/* Register with bus */
-	ret = woal_bus_register();
-	if (ret == MLAN_STATUS_SUCCESS)
+	/* Without the cache TCP ACKs are sent as they come */
+	tcp_sess_cache = kmem_cache_create("moal_tcp_sess",
+					   sizeof(struct tcp_sess), 0,
+					   SLAB_HWCACHE_ALIGN, NULL);
+	tx_desc_cache = kmem_cache_create("moal_tx_desc",
+					  sizeof(mlan_buffer), 0,
+					  SLAB_HWCACHE_ALIGN, NULL);
+	if (!tx_desc_cache) {
+		PRINTM(MERROR, "wlan: Cannot create TX descriptor cache\n");
+		ret = -ENOMEM;
+	} else {
+		/* Register with bus */
+		ret = woal_bus_register();
+	}
+	if (ret == MLAN_STATUS_SUCCESS) {
 		PRINTM(MMSG, "wlan: Driver loaded successfully\n");
-	else
+	} else {
 		PRINTM(MERROR, "wlan: Driver loading failed\n");
+		if (tcp_sess_cache) {
+			kmem_cache_destroy(tcp_sess_cache);
+			tcp_sess_cache = NULL;
+		}
+		if (tx_desc_cache) {
+			kmem_cache_destroy(tx_desc_cache);
+			tx_desc_cache = NULL;
+		}
+	}
 
 	LEAVE();
 	return ret;
@@ -9105,6 +10107,14 @@ exit_sem_err:
 		destroy_workqueue(hang_workqueue);
 		hang_workqueue = NULL;
 	}
+	if (tcp_sess_cache) {
+		kmem_cache_destroy(tcp_sess_cache);
+		tcp_sess_cache = NULL;
+	}
+	if (tx_desc_cache) {
+		kmem_cache_destroy(tx_desc_cache);
+		tx_desc_cache = NULL;
+	}
 
 	LEAVE();
 }
@@ -9262,6 +10272,16 @@ MODULE_PARM_DESC(wq_sched_policy,
 module_param(rx_work, int, 0);
 MODULE_PARM_DESC(rx_work,
 		 "0: default; 1: Enable rx_work_queue; 2: Disable rx_work_queue");
+#ifdef SDIO_MULTI_PORT_TX_AGGR
+module_param(amsdu_sg, int, 0);
+MODULE_PARM_DESC(amsdu_sg,
+		 "0: Copy AMSDU into one buffer (default); 1: Scatter-gather AMSDU in TX SG mode");
+#endif
+#ifdef SDIO_MULTI_PORT_RX_AGGR
+module_param(mpa_rx_adapt, int, 0);
+MODULE_PARM_DESC(mpa_rx_adapt,
+		 "0: Fixed SDIO MP-A RX limits (default); 1: Adapt MP-A RX limits to traffic and CMD53 latency");
+#endif
 #if defined(WIFI_DIRECT_SUPPORT)
 #if defined(STA_CFG80211) && defined(UAP_CFG80211)
 #if CFG80211_VERSION_CODE >= WIFI_DIRECT_KERNEL_VERSION
@@ -9284,6 +10304,15 @@ MODULE_PARM_DESC(dev_cap_mask, "Device capability mask");
 module_param(sdio_rx_aggr, int, 0);
 MODULE_PARM_DESC(sdio_rx_aggr,
 		 "1: Enable SDIO rx aggr; 0: Disable SDIO rx aggr");
+module_param(init_cmd_poll, int, 0);
+MODULE_PARM_DESC(init_cmd_poll,
+		 "0: Wait for the SDIO interrupt for init command responses (default); 1: Poll for init command responses");
+module_param(tx_lat_trace, int, 0644);
+MODULE_PARM_DESC(tx_lat_trace,
+		 "0: Disable TX latency tracing (default); 1: Collect per-AC TX latency histograms in proc txlat");
+module_param(tx_bql_delay, int, 0644);
+MODULE_PARM_DESC(tx_bql_delay,
+		 "Cap each AC's TX byte queue limit at this many ms of SDIO drain (default 10); 0: No cap");
 
 module_param(antcfg, int, 0660);
 MODULE_PARM_DESC(antcfg,
@@ -9302,6 +10331,9 @@ MODULE_PARM_DESC(indication_gpio,
 module_param(fixed_beacon_buffer, int, 0);
 MODULE_PARM_DESC(fixed_beacon_buffer,
 		 "0: allocate default buffer size; 1: allocate max buffer size.");
+module_param(max_beacon_buffer, int, 0);
+MODULE_PARM_DESC(max_beacon_buffer,
+		 "Maximum memory in bytes for scan beacons; 0: default 49152, capped at 262144.");
 
 #ifdef WIFI_DIRECT_SUPPORT
 module_param(GoAgeoutTime, int, 0);
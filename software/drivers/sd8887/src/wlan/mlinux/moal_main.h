@@ -41,6 +41,7 @@ Change log:
 #include        <linux/param.h>
 #include        <linux/delay.h>
 #include        <linux/slab.h>
+#include        <linux/mempool.h>
 #include        <linux/mm.h>
 #include        <linux/types.h>
 #include        <linux/sched.h>
@@ -95,6 +96,11 @@ Change log:
 #include        <linux/inetdevice.h>
 
 #include	<linux/firmware.h>
+#if defined(CONFIG_XZ_DEC) || defined(CONFIG_XZ_DEC_MODULE)
+#include	<linux/xz.h>
+/** Firmware images may be xz compressed */
+#define FW_XZ_SUPPORT
+#endif
 
 #ifdef ANDROID_KERNEL
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 5, 0)
@@ -778,6 +784,11 @@ typedef enum {
 
 #define MAX_RX_PENDING_THRHLD	50
 
+/** Check whether the caller runs inside the handle's NAPI rx poll */
+#define woal_in_napi_poll(handle) \
+	(in_softirq() && !in_irq() && \
+	 (handle)->napi_poll_cpu == raw_smp_processor_id())
+
 /** high rx pending packets */
 #define HIGH_RX_PENDING         100
 /** low rx pending packets */
@@ -789,6 +800,11 @@ typedef enum {
 /** LOW Tx Pending count */
 #define LOW_TX_PENDING      380
 
+/** Interval of the SDIO drain rate measurement behind the BQL cap */
+#define TX_BQL_INTERVAL     (HZ / 10)
+/** Floor of the BQL cap, room for one full SDIO aggregation burst */
+#define TX_BQL_MIN_LIMIT    (64 * 1024)
+
 /** Offset for subcommand */
 #define SUBCMD_OFFSET       4
 
@@ -949,8 +965,23 @@ struct debug_data_priv {
 
 #define DROP_TCP_ACK        1
 #define HOLD_TCP_ACK        2
+/** TCP session hash buckets, must be a power of 2 */
+#define TCP_SESS_HASH_SIZE  256
+/** Maximum number of TCP sessions per interface */
+#define TCP_SESS_MAX        512
+/** A TCP session with no ACK for this many jiffies may be evicted */
+#define TCP_SESS_IDLE_TIMEOUT   (5 * HZ)
+/** Held ACK wheel slots, must be a power of 2 */
+#define TCP_ACK_WHEEL_SIZE  4
+/** Wheel ticks an ACK is held for */
+#define TCP_ACK_HOLD_TICKS  1
 struct tcp_sess {
+    /** link in the session hash bucket */
+	struct hlist_node hlink;
+    /** link in the session list, least recently used first */
 	struct list_head link;
+    /** link in the wheel slot while an ack is held */
+	struct list_head wheel_link;
     /** tcp session info */
 	t_u32 src_ip_addr;
 	t_u32 dst_ip_addr;
@@ -958,16 +989,12 @@ struct tcp_sess {
 	t_u16 dst_tcp_port;
     /** tx ack packet info */
 	t_u32 ack_seq;
-	/** tcp ack buffer */
+	/** held tcp ack buffer */
 	void *ack_skb;
-	/** priv structure */
-	void *priv;
-	/** pmbuf */
+	/** pmbuf of the held ack */
 	void *pmbuf;
-    /** timer for ack */
-	moal_drv_timer ack_timer __ATTRIB_ALIGN__;
-    /** timer is set */
-	BOOLEAN is_timer_set;
+    /** jiffies of the last ack */
+	unsigned long last_ack;
 };
 
 /** TX status info structure */
@@ -1090,6 +1117,23 @@ typedef struct _hgm_data {
 /** max antenna number */
 #define MAX_ANTENNA_NUM			4
 
+/** Number of log2 buckets in a TX latency histogram */
+#define TX_LAT_BUCKETS			20
+/** TX latency stages: kernel enqueue -> WMM queue -> dequeue -> SDIO ->
+ *  TX done, plus the total */
+#define TX_LAT_STAGES			(MLAN_TX_TS_NUM + 1)
+/** Index of the total latency in the TX latency stages */
+#define TX_LAT_TOTAL			(TX_LAT_STAGES - 1)
+/** Number of access categories traced */
+#define TX_LAT_AC_NUM			4
+/** TX latency histograms of one access category */
+typedef struct _tx_lat_hist {
+    /** num sample */
+	atomic_t num_samples;
+    /** log2 buckets of each stage, in 1024 ns units */
+	atomic_t bucket[TX_LAT_STAGES][TX_LAT_BUCKETS];
+} tx_lat_hist;
+
 /* wlan_hist_proc_data */
 typedef struct _wlan_hist_proc_data {
     /** antenna */
@@ -1124,6 +1168,10 @@ struct _moal_private {
 	t_u32 tcp_ack_drop_cnt;
 	/** Statistics of tcp ack tx in total from kernel */
 	t_u32 tcp_ack_cnt;
+	/** Statistics of held tcp ack sent */
+	t_u32 tcp_ack_flush_cnt;
+	/** Statistics of tcp sessions evicted */
+	t_u32 tcp_sess_evict_cnt;
 #ifdef UAP_SUPPORT
 	/** uAP started or not */
 	BOOLEAN bss_started;
@@ -1366,8 +1414,22 @@ struct _moal_private {
 	struct debug_data_priv items_priv;
 #endif
 
-    /** tcp session queue */
+    /** tcp session queue, least recently used first */
 	struct list_head tcp_sess_queue;
+    /** tcp session hash table */
+	struct hlist_head tcp_sess_hash[TCP_SESS_HASH_SIZE];
+    /** Number of tcp sessions */
+	t_u32 tcp_sess_num;
+    /** Held tcp ack wheel */
+	struct list_head tcp_ack_wheel[TCP_ACK_WHEEL_SIZE];
+    /** Current wheel slot */
+	t_u32 tcp_ack_wheel_pos;
+    /** Number of held tcp acks */
+	t_u32 tcp_ack_held;
+    /** Wheel timer */
+	moal_drv_timer tcp_ack_timer __ATTRIB_ALIGN__;
+    /** Wheel timer is set */
+	BOOLEAN tcp_ack_timer_set;
     /** TCP Ack enhance flag */
 	t_u8 enable_tcp_ack_enh;
     /** TCP session spin lock */
@@ -1394,6 +1456,8 @@ struct _moal_private {
 
     /** rx hgm data */
 	hgm_data *hist_data[MAX_ANTENNA_NUM];
+    /** TX latency histograms per AC, indexed BK, BE, VI, VO */
+	tx_lat_hist tx_lat[TX_LAT_AC_NUM];
 	BOOLEAN assoc_with_mac;
 	t_u8 gtk_data_ready;
 	mlan_ds_misc_gtk_rekey_data gtk_rekey_data;
@@ -1403,6 +1467,69 @@ struct _moal_private {
 #define GTK_REKEY_OFFLOAD_ENABLE                     1
 #define GTK_REKEY_OFFLOAD_SUSPEND                    2
 
+/** Size of the buffers kept in the RX recycle pool */
+#define MOAL_RX_POOL_BUF_SIZE      (MLAN_RX_DATA_BUF_SIZE + DMA_ALIGNMENT)
+/** RX recycle pool is refilled when it drops below this */
+#define MOAL_RX_POOL_LOW_WATERMARK 16
+/** RX recycle pool refill target */
+#define MOAL_RX_POOL_REFILL        32
+/** Recycled buffers beyond this are returned to the slab */
+#define MOAL_RX_POOL_HIGH_WATERMARK 64
+/** Per-CPU RX recycle cache depth */
+#define MOAL_RX_POOL_CACHE_SIZE    8
+
+/** TX descriptors reserved per adapter */
+#define MOAL_TX_DESC_POOL_MIN      64
+
+/** Per-CPU cache of the RX recycle pool */
+typedef struct _moal_rx_pool_cache {
+    /** cached buffers */
+	struct sk_buff *skb[MOAL_RX_POOL_CACHE_SIZE];
+    /** number of cached buffers */
+	int count;
+} moal_rx_pool_cache;
+
+/** Rx batch delivered through napi_gro_receive */
+#define MOAL_RX_BATCH_NAPI         0
+/** Rx batch delivered through netif_rx */
+#define MOAL_RX_BATCH_NETIF_RX     1
+/** Rx batch delivered through netif_receive_skb(_list) */
+#define MOAL_RX_BATCH_LIST         2
+
+/** Per-CPU rx batch. It is open only with bottom halves disabled, so
+ *  while depth is set nothing but the owning context runs on the CPU */
+typedef struct _moal_rx_batch {
+    /** batch nesting depth */
+	int depth;
+    /** delivery path picked when the outermost batch was opened */
+	int mode;
+    /** held packets */
+	struct sk_buff_head q;
+} moal_rx_batch;
+
+#ifdef FW_XZ_SUPPORT
+/** Largest LZMA2 dictionary accepted in a compressed firmware image */
+#define FW_XZ_DICT_MAX             (1 << 20)
+/** Size of the window of decompressed firmware data */
+#define FW_XZ_WIN_SIZE             (2 * WLAN_UPLD_SIZE)
+
+/** State for decompressing a firmware image while it is downloaded */
+typedef struct _moal_fw_xz {
+    /** xz decoder */
+	struct xz_dec *dec;
+    /** decoder input/output buffers */
+	struct xz_buf buf;
+    /** window of decompressed data */
+	t_u8 *win;
+    /** image offset of the first byte in the window */
+	t_u32 win_start;
+    /** valid bytes in the window */
+	t_u32 win_len;
+    /** decompressed image size */
+	t_u32 size;
+} moal_fw_xz;
+#endif
+
 /** Handle data structure for MOAL */
 struct _moal_handle {
 	/** MLAN adapter structure */
@@ -1424,6 +1551,10 @@ struct _moal_handle {
 #endif
 	/** Firmware */
 	const struct firmware *firmware;
+#ifdef FW_XZ_SUPPORT
+	/** Decompression state while downloading an xz firmware image */
+	moal_fw_xz *fw_xz;
+#endif
 	/** Firmware request start time */
 	wifi_timeval req_fw_time;
 	/** Init config file */
@@ -1432,6 +1563,8 @@ struct _moal_handle {
 	const struct firmware *user_data;
 	/** Init user configure wait queue token */
 	t_u16 init_user_conf_wait_flag;
+	/** End of the last init phase in ns */
+	t_u64 init_phase_ns;
 	/** Init user configure file wait queue */
 	wait_queue_head_t init_user_conf_wait_q __ATTRIB_ALIGN__;
 	/** dpd config file */
@@ -1489,6 +1622,32 @@ struct _moal_handle {
 	atomic_t vmalloc_count;
 	/** mlan buffer alloc count */
 	atomic_t mbufalloc_count;
+	/** RX recycle pool */
+	struct sk_buff_head rx_pool;
+	/** Per-CPU caches of the RX recycle pool */
+	moal_rx_pool_cache *rx_pool_cache;
+	/** Buffer end offset of RX recycle pool buffers */
+	unsigned int rx_pool_end;
+	/** RX recycle pool hit count */
+	atomic_t rx_pool_hit;
+	/** RX recycle pool miss count */
+	atomic_t rx_pool_miss;
+	/** RX recycle pool recycled buffer count */
+	atomic_t rx_pool_recycle;
+	/** TX descriptor reserve */
+	mempool_t *tx_desc_pool;
+	/** TX skbs sent without a headroom copy */
+	atomic_t tx_copy_avoided;
+	/** TX skbs copied for headroom or a shared header */
+	atomic_t tx_copy_required;
+	/** NAPI rx poll count */
+	t_u32 napi_poll_cnt;
+	/** NAPI rx polls completed within budget */
+	t_u32 napi_complete_cnt;
+	/** NAPI rx polls which used the whole budget */
+	t_u32 napi_budget_exhausted;
+	/** Packets received through NAPI rx polls */
+	t_u32 napi_rx_pkts;
 #if defined(SDIO_SUSPEND_RESUME)
 	/** hs skip count */
 	t_u32 hs_skip_count;
@@ -1662,6 +1821,14 @@ struct _moal_handle {
 	/** spinlock to stop_queue/wake_queue*/
 	spinlock_t queue_lock;
 #endif
+	/** spinlock serializing the per-AC byte queue limits */
+	spinlock_t tx_bql_lock;
+	/** Bytes completed since tx_drain_start */
+	t_u32 tx_drain_bytes;
+	/** Start of the current drain rate measurement, in jiffies */
+	unsigned long tx_drain_start;
+	/** Current BQL cap in bytes, 0 if not capped */
+	t_u32 tx_bql_limit;
 	/** Driver spin lock */
 	spinlock_t driver_lock;
 	/** Driver ioctl spin lock */
@@ -1682,6 +1849,10 @@ struct _moal_handle {
 	struct notifier_block woal_notifier;
 	struct net_device napi_dev;
 	struct napi_struct napi_rx;
+	/** CPU running woal_netdev_poll_rx, -1 when not polling */
+	int napi_poll_cpu;
+	/** Per-CPU rx batches, NULL if batching is unavailable */
+	moal_rx_batch *rx_batch;
 #if CFG80211_VERSION_CODE >= KERNEL_VERSION(3, 8, 0)
 	/** host_mlme_priv */
 	moal_private *host_mlme_priv;
@@ -2166,10 +2337,30 @@ mlan_status woal_atoi(int *data, char *a);
 int woal_atox(char *a);
 /** Allocate buffer */
 pmlan_buffer woal_alloc_mlan_buffer(moal_handle *handle, int size);
+/** Allocate buffer from the RX recycle pool */
+pmlan_buffer woal_alloc_pool_mlan_buffer(moal_handle *handle, int size);
 /** Allocate IOCTL request buffer */
 pmlan_ioctl_req woal_alloc_mlan_ioctl_req(int size);
 /** Free buffer */
 void woal_free_mlan_buffer(moal_handle *handle, pmlan_buffer pmbuf);
+/** Initialize the RX recycle pool */
+void woal_rx_pool_init(moal_handle *handle);
+/** Refill the RX recycle pool */
+void woal_rx_pool_refill(moal_handle *handle);
+/** Free the RX recycle pool */
+void woal_rx_pool_free(moal_handle *handle);
+/** Initialize the per-CPU rx batches */
+void woal_rx_batch_init(moal_handle *handle);
+/** Free the per-CPU rx batches */
+void woal_rx_batch_free(moal_handle *handle);
+/** Allocate a TX descriptor */
+pmlan_buffer woal_alloc_tx_desc(moal_handle *handle);
+/** Free a TX descriptor */
+void woal_free_tx_desc(moal_handle *handle, pmlan_buffer pmbuf);
+/** Initialize the TX descriptor pool */
+void woal_tx_desc_pool_init(moal_handle *handle);
+/** Free the TX descriptor pool */
+void woal_tx_desc_pool_free(moal_handle *handle);
 /** Get private structure of a BSS by index */
 moal_private *woal_bss_index_to_priv(moal_handle *handle, t_u8 bss_index);
 /* Functions in interface module */
@@ -2545,6 +2736,11 @@ mlan_status woal_request_fw(moal_handle *handle);
 int woal_11h_channel_check_ioctl(moal_private *priv, t_u8 wait_option);
 void woal_cancel_cac_block(moal_private *priv);
 void woal_moal_debug_info(moal_private *priv, moal_handle *handle, u8 flag);
+void woal_init_phase(moal_handle *handle, const char *phase);
+#ifdef FW_XZ_SUPPORT
+mlan_status woal_fw_xz_read(moal_handle *handle, t_u32 offset, t_u32 len,
+			    t_u8 *pbuf);
+#endif
 
 #ifdef STA_SUPPORT
 mlan_status woal_get_powermode(moal_private *priv, int *powermode);
@@ -2596,6 +2792,7 @@ void woal_save_conn_params(moal_private *priv,
 void woal_clear_conn_params(moal_private *priv);
 #endif
 
+void woal_init_tcp_sess_queue(moal_private *priv);
 void woal_flush_tcp_sess_queue(moal_private *priv);
 void woal_flush_tdls_list(moal_private *priv);
 void wlan_scan_create_brief_table_entry(t_u8 **ppbuffer,
@@ -2627,6 +2824,10 @@ void woal_hist_do_reset(moal_private *priv, void *data);
 void woal_hist_reset_table(moal_private *priv, t_u8 antenna);
 void woal_hist_data_add(moal_private *priv, t_u8 rx_rate, t_s8 snr, t_s8 nflr,
 			t_u8 antenna);
+void woal_tx_lat_add(moal_private *priv, pmlan_buffer pmbuf);
+void woal_tx_bql_sent(moal_private *priv, struct sk_buff *skb);
+void woal_tx_bql_completed(moal_private *priv, struct sk_buff *skb);
+void woal_tx_lat_reset(moal_private *priv);
 mlan_status woal_delba_all(moal_private *priv, t_u8 wait_option);
 
 #ifdef UAP_SUPPORT
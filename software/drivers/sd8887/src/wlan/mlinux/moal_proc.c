@@ -48,6 +48,13 @@ int proc_dir_entry_use_count;
 #define PROC_DIR	proc_net
 #endif
 
+#ifdef HOTPATH_TRACE
+/** Hot-path trace file, shared by all adapters */
+#define TRACE_PROC_NAME	"trace"
+/** Hot-path trace state, as last set through the config file */
+static t_u8 hotpath_trace;
+#endif
+
 #ifdef STA_SUPPORT
 static char *szModes[] = {
 	"Unknown",
@@ -451,6 +458,18 @@ woal_config_write(struct file *f, const char __user * buf, size_t count,
 		PRINTM(MMSG, "Request fw_reload=%d\n", config_data);
 		woal_request_fw_reload(handle, config_data);
 	}
+#ifdef HOTPATH_TRACE
+	if (!strncmp(databuf, "hotpath_trace=", strlen("hotpath_trace="))) {
+		line += strlen("hotpath_trace") + 1;
+		config_data = (t_u32)woal_string_to_number(line);
+		PRINTM(MINFO, "hotpath_trace: %d\n", (int)config_data);
+		if (mlan_trace_enable(config_data ? MTRUE : MFALSE) ==
+		    MLAN_STATUS_SUCCESS)
+			hotpath_trace = config_data ? MTRUE : MFALSE;
+		else
+			PRINTM(MERROR, "Could not enable hot-path trace\n");
+	}
+#endif
 	MODULE_PUT;
 	LEAVE();
 	return (int)count;
@@ -481,6 +500,9 @@ woal_config_read(struct seq_file *sfp, void *data)
 	seq_printf(sfp, "drv_mode=%d\n", (int)drv_mode);
 	seq_printf(sfp, "sdcmd52rw=%d 0x%0x 0x%02X\n", handle->cmd52_func,
 		   handle->cmd52_reg, handle->cmd52_val);
+#ifdef HOTPATH_TRACE
+	seq_printf(sfp, "hotpath_trace=%d\n", (int)hotpath_trace);
+#endif
 
 	MODULE_PUT;
 	LEAVE();
@@ -516,6 +538,91 @@ static const struct file_operations config_proc_fops = {
 };
 #endif
 
+#ifdef HOTPATH_TRACE
+/** Hot-path trace records copied out when the trace file is opened */
+typedef struct _trace_snapshot {
+    /** Length of data in bytes */
+	size_t len;
+    /** mlan_trace_rec records */
+	t_u8 data[];
+} trace_snapshot;
+
+/**
+ *  @brief Snapshot the hot-path trace rings
+ *
+ *  @param inode    pointer to inode
+ *  @param file     file pointer
+ *
+ *  @return         0 or -ENOMEM
+ */
+static int
+woal_trace_proc_open(struct inode *inode, struct file *file)
+{
+	trace_snapshot *snap;
+	t_u32 max_rec = num_possible_cpus() * MLAN_TRACE_RING_SIZE;
+
+	snap = vmalloc(sizeof(*snap) + max_rec * sizeof(mlan_trace_rec));
+	if (!snap)
+		return -ENOMEM;
+	snap->len = mlan_trace_read((pmlan_trace_rec)snap->data, max_rec) *
+		sizeof(mlan_trace_rec);
+	file->private_data = snap;
+	return 0;
+}
+
+/**
+ *  @brief Read raw trace records, decoded by mapp/mlantrace
+ *
+ *  @param file     file pointer
+ *  @param buf      pointer to user buffer
+ *  @param count    number of bytes to read
+ *  @param ppos     file offset
+ *
+ *  @return         number of bytes read
+ */
+static ssize_t
+woal_trace_proc_read(struct file *file, char __user * buf, size_t count,
+		     loff_t * ppos)
+{
+	trace_snapshot *snap = file->private_data;
+
+	return simple_read_from_buffer(buf, count, ppos, snap->data,
+				       snap->len);
+}
+
+/**
+ *  @brief Free the trace snapshot
+ *
+ *  @param inode    pointer to inode
+ *  @param file     file pointer
+ *
+ *  @return         0
+ */
+static int
+woal_trace_proc_release(struct inode *inode, struct file *file)
+{
+	vfree(file->private_data);
+	return 0;
+}
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 6, 0)
+static const struct proc_ops trace_proc_fops = {
+	.proc_open = woal_trace_proc_open,
+	.proc_read = woal_trace_proc_read,
+	.proc_lseek = default_llseek,
+	.proc_release = woal_trace_proc_release,
+};
+#else
+static const struct file_operations trace_proc_fops = {
+	.owner = THIS_MODULE,
+	.open = woal_trace_proc_open,
+	.read = woal_trace_proc_read,
+	.llseek = default_llseek,
+	.release = woal_trace_proc_release,
+};
+#endif
+#endif /* HOTPATH_TRACE */
+
 /********************************************************
 		Global Functions
 ********************************************************/
@@ -605,6 +712,12 @@ woal_proc_init(moal_handle *handle)
 				PRINTM(MERROR,
 				       "Cannot create proc interface!\n");
 			}
+#ifdef HOTPATH_TRACE
+			else if (!proc_create(TRACE_PROC_NAME, 0444,
+					      handle->proc_mwlan,
+					      &trace_proc_fops))
+				PRINTM(MERROR, "Fail to create proc trace\n");
+#endif
 		} else {
 			handle->proc_mwlan = proc_mwlan;
 		}
@@ -672,6 +785,10 @@ woal_proc_exit(moal_handle *handle)
 			atomic_dec(&(handle->proc_mwlan->count));
 #endif
 			if (!--proc_dir_entry_use_count) {
+#ifdef HOTPATH_TRACE
+				remove_proc_entry(TRACE_PROC_NAME,
+						  handle->proc_mwlan);
+#endif
 				remove_proc_entry(MWLAN_PROC, PROC_DIR);
 #if LINUX_VERSION_CODE > KERNEL_VERSION(2, 6, 26)
 				proc_mwlan = NULL;
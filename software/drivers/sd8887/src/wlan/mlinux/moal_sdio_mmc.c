@@ -692,6 +692,38 @@ woal_sdio_f0_readb(moal_handle *handle, t_u32 reg, t_u8 *data)
 	return ret;
 }
 
+/**
+ *  @brief This function adds the segments of one mlan_buffer to a
+ *         scatterlist
+ *
+ *  @param sg_list  A pointer to the scatterlist
+ *  @param num_sg   Number of segments already in sg_list
+ *  @param pmbuf    Pointer to mlan_buffer structure
+ *
+ *  @return         Number of segments in sg_list, or -1 if it is full
+ */
+static int
+woal_sdio_sg_add_buf(struct scatterlist *sg_list, int num_sg,
+		     mlan_buffer *pmbuf)
+{
+	t_u32 i;
+
+	if (!(pmbuf->flags & MLAN_BUF_FLAG_SG)) {
+		if (num_sg >= SDIO_MP_SG_MAX_SEGS)
+			return -1;
+		sg_set_buf(&sg_list[num_sg++], pmbuf->pbuf + pmbuf->data_offset,
+			   pmbuf->data_len);
+		return num_sg;
+	}
+	for (i = 0; i < pmbuf->frag_cnt; i++) {
+		if (num_sg >= SDIO_MP_SG_MAX_SEGS)
+			return -1;
+		sg_set_buf(&sg_list[num_sg++], pmbuf->pfrag[i].pdata,
+			   pmbuf->pfrag[i].len);
+	}
+	return num_sg;
+}
+
 /**
  *  @brief This function use SG mode to read/write data into card memory
  *
@@ -706,8 +738,8 @@ mlan_status
 woal_sdio_rw_mb(moal_handle *handle, pmlan_buffer pmbuf_list, t_u32 port,
 		t_u8 write)
 {
-	struct scatterlist sg_list[SDIO_MP_AGGR_DEF_PKT_LIMIT];
-	int num_sg = pmbuf_list->use_count;
+	struct scatterlist sg_list[SDIO_MP_SG_MAX_SEGS];
+	int num_sg = 0;
 	int i = 0;
 	mlan_buffer *pmbuf = NULL;
 	struct mmc_request mmc_req;
@@ -720,19 +752,28 @@ woal_sdio_rw_mb(moal_handle *handle, pmlan_buffer pmbuf_list, t_u32 port,
 	int status;
 #endif
 
-	if (num_sg > SDIO_MP_AGGR_DEF_PKT_LIMIT) {
-		PRINTM(MERROR, "ERROR: num_sg=%d", num_sg);
+	if (pmbuf_list->use_count > SDIO_MP_SG_MAX_SEGS) {
+		PRINTM(MERROR, "ERROR: use_count=%d", pmbuf_list->use_count);
 		return MLAN_STATUS_FAILURE;
 	}
-	sg_init_table(sg_list, num_sg);
-	pmbuf = pmbuf_list->pnext;
-	for (i = 0; i < num_sg; i++) {
-		if (pmbuf == pmbuf_list)
-			break;
-		sg_set_buf(&sg_list[i], pmbuf->pbuf + pmbuf->data_offset,
-			   pmbuf->data_len);
-		pmbuf = pmbuf->pnext;
+	sg_init_table(sg_list, SDIO_MP_SG_MAX_SEGS);
+	if (pmbuf_list->flags & MLAN_BUF_FLAG_SG) {
+		/* A single scatter-gather buffer */
+		num_sg = woal_sdio_sg_add_buf(sg_list, num_sg, pmbuf_list);
+	} else {
+		pmbuf = pmbuf_list->pnext;
+		for (i = 0; i < pmbuf_list->use_count; i++) {
+			if (pmbuf == pmbuf_list || num_sg < 0)
+				break;
+			num_sg = woal_sdio_sg_add_buf(sg_list, num_sg, pmbuf);
+			pmbuf = pmbuf->pnext;
+		}
 	}
+	if (num_sg <= 0) {
+		PRINTM(MERROR, "ERROR: num_sg=%d", num_sg);
+		return MLAN_STATUS_FAILURE;
+	}
+	sg_mark_end(&sg_list[num_sg - 1]);
 	memset(&mmc_req, 0, sizeof(struct mmc_request));
 	memset(&mmc_cmd, 0, sizeof(struct mmc_command));
 	memset(&mmc_dat, 0, sizeof(struct mmc_data));
@@ -808,7 +849,7 @@ woal_write_data_sync(moal_handle *handle, mlan_buffer *pmbuf, t_u32 port,
 				MLAN_SDIO_BLOCK_SIZE) : pmbuf->data_len;
 	t_u32 ioport = (port & MLAN_SDIO_IO_PORT_MASK);
 	int status = 0;
-	if (pmbuf->use_count > 1)
+	if (pmbuf->use_count > 1 || (pmbuf->flags & MLAN_BUF_FLAG_SG))
 		return woal_sdio_rw_mb(handle, pmbuf, port, MTRUE);
 #ifdef SDIO_MMC_DEBUG
 	handle->cmd53w = 1;
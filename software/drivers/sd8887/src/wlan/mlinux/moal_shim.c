@@ -545,6 +545,10 @@ moal_get_fw_data(IN t_void *pmoal_handle,
 	if (!pbuf || !len)
 		return MLAN_STATUS_FAILURE;
 
+#ifdef FW_XZ_SUPPORT
+	if (handle->fw_xz)
+		return woal_fw_xz_read(handle, offset, len, pbuf);
+#endif
 	if (offset + len > handle->firmware->size)
 		return MLAN_STATUS_FAILURE;
 
@@ -569,6 +573,7 @@ moal_get_hw_spec_complete(IN t_void *pmoal_handle, IN mlan_status status,
 	ENTER();
 	if (status == MLAN_STATUS_SUCCESS) {
 		PRINTM(MCMND, "Get Hw Spec done, fw_cap=0x%x\n", phw->fw_cap);
+		woal_init_phase((moal_handle *)pmoal_handle, "hw_spec");
 	}
 	LEAVE();
 	return MLAN_STATUS_SUCCESS;
@@ -587,8 +592,10 @@ moal_init_fw_complete(IN t_void *pmoal_handle, IN mlan_status status)
 {
 	moal_handle *handle = (moal_handle *)pmoal_handle;
 	ENTER();
-	if (status == MLAN_STATUS_SUCCESS)
+	if (status == MLAN_STATUS_SUCCESS) {
 		handle->hardware_status = HardwareStatusReady;
+		woal_init_phase(handle, "init_fw_complete");
+	}
 	handle->init_wait_q_woken = MTRUE;
 	wake_up(&handle->init_wait_q);
 	LEAVE();
@@ -708,6 +715,26 @@ moal_alloc_mlan_buffer(IN t_void *pmoal_handle,
 	return MLAN_STATUS_SUCCESS;
 }
 
+/**
+ *  @brief This function allocates mlan_buffer from the RX recycle pool.
+ *
+ *  @param pmoal_handle Pointer to the MOAL context
+ *  @param size     allocation size requested
+ *  @param pmbuf    pointer to pointer to the allocated buffer
+ *
+ *  @return         MLAN_STATUS_SUCCESS or MLAN_STATUS_FAILURE
+ */
+mlan_status
+moal_alloc_pool_mlan_buffer(IN t_void *pmoal_handle,
+			    IN t_u32 size, OUT pmlan_buffer *pmbuf)
+{
+	*pmbuf = woal_alloc_pool_mlan_buffer((moal_handle *)pmoal_handle,
+					     size);
+	if (NULL == *pmbuf)
+		return MLAN_STATUS_FAILURE;
+	return MLAN_STATUS_SUCCESS;
+}
+
 /**
  *  @brief This function frees mlan_buffer.
  *
@@ -755,8 +782,12 @@ moal_send_packet_complete(IN t_void *pmoal_handle,
 		priv = woal_bss_index_to_priv(pmoal_handle, pmbuf->bss_index);
 		skb = (struct sk_buff *)pmbuf->pdesc;
 		if (priv) {
+			if (pmbuf->tx_ts[MLAN_TX_TS_KERNEL])
+				woal_tx_lat_add(priv, pmbuf);
 			woal_set_trans_start(priv->netdev);
 			if (skb) {
+				if (pmbuf->flags & MLAN_BUF_FLAG_TX_DESC)
+					woal_tx_bql_completed(priv, skb);
 				if (status == MLAN_STATUS_SUCCESS) {
 					priv->stats.tx_packets++;
 					priv->stats.tx_bytes += skb->len;
@@ -818,6 +849,8 @@ moal_send_packet_complete(IN t_void *pmoal_handle,
 		}
 		if (skb)
 			dev_kfree_skb_any(skb);
+		if (pmbuf->flags & MLAN_BUF_FLAG_TX_DESC)
+			woal_free_tx_desc(handle, pmbuf);
 	}
 
 done:
@@ -908,13 +941,36 @@ moal_recv_packet(IN t_void *pmoal_handle, IN pmlan_buffer pmbuf)
 	moal_private *priv = NULL;
 	struct sk_buff *skb = NULL;
 	moal_handle *handle = (moal_handle *)pmoal_handle;
+	moal_rx_batch *batch = NULL;
 	ENTER();
 	if (pmbuf) {
 
 		priv = woal_bss_index_to_priv(pmoal_handle, pmbuf->bss_index);
 		skb = (struct sk_buff *)pmbuf->pdesc;
 		if (priv) {
-			if (skb) {
+			if (skb && (pmbuf->flags & MLAN_BUF_FLAG_RX_SHARED)) {
+				/* MLAN forwards the buffer itself, upload a clone */
+				skb = skb_clone(skb, GFP_ATOMIC);
+				if (!skb) {
+					PRINTM(MERROR, "%s fail to clone skb\n",
+					       __func__);
+					status = MLAN_STATUS_FAILURE;
+					priv->stats.rx_dropped++;
+					goto done;
+				}
+				skb_reserve(skb, pmbuf->data_offset);
+				if (skb_tailroom(skb) < pmbuf->data_len) {
+					PRINTM(MERROR,
+					       "skb overflow: tail room=%d, data_len=%d\n",
+					       skb_tailroom(skb),
+					       pmbuf->data_len);
+					dev_kfree_skb_any(skb);
+					status = MLAN_STATUS_FAILURE;
+					priv->stats.rx_dropped++;
+					goto done;
+				}
+				skb_put(skb, pmbuf->data_len);
+			} else if (skb) {
 				skb_reserve(skb, pmbuf->data_offset);
 				if (skb_tailroom(skb) < pmbuf->data_len) {
 					PRINTM(MERROR,
@@ -971,7 +1027,15 @@ moal_recv_packet(IN t_void *pmoal_handle, IN pmlan_buffer pmbuf)
 #endif
 			}
 #endif
-			if (in_interrupt())
+			/* A batch open on this CPU can only belong to us,
+			 * its owner keeps bottom halves disabled */
+			if (handle->rx_batch && !in_irq())
+				batch = raw_cpu_ptr(handle->rx_batch);
+			if (batch && batch->depth)
+				__skb_queue_tail(&batch->q, skb);
+			else if (woal_in_napi_poll(handle))
+				napi_gro_receive(&handle->napi_rx, skb);
+			else if (in_interrupt())
 				netif_rx(skb);
 			else {
 				if (atomic_read(&handle->rx_pending) >
@@ -987,6 +1051,80 @@ done:
 	return status;
 }
 
+/**
+ *  @brief This function opens or delivers a batch of received packets.
+ *         While a batch is open moal_recv_packet() holds the skbs of the
+ *         calling context, and closing the outermost batch hands them to
+ *         the stack together. The batch lives on the current CPU with
+ *         bottom halves disabled, so packets received by other contexts
+ *         are never captured.
+ *
+ *  @param pmoal_handle Pointer to the MOAL context
+ *  @param start        MTRUE to open a batch, MFALSE to deliver it
+ *
+ *  @return             N/A
+ */
+t_void
+moal_recv_batch(IN t_void *pmoal_handle, IN t_u8 start)
+{
+	moal_handle *handle = (moal_handle *)pmoal_handle;
+	moal_rx_batch *batch;
+	struct sk_buff *skb;
+	int mode;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 19, 0)
+	LIST_HEAD(rx_list);
+#endif
+
+	ENTER();
+	/* Packets are delivered one by one where bottom halves cannot be
+	 * toggled */
+	if (!handle->rx_batch || in_irq() || irqs_disabled()) {
+		LEAVE();
+		return;
+	}
+	if (start) {
+		if (woal_in_napi_poll(handle))
+			mode = MOAL_RX_BATCH_NAPI;
+		else if (in_interrupt())
+			mode = MOAL_RX_BATCH_NETIF_RX;
+		else
+			mode = MOAL_RX_BATCH_LIST;
+		local_bh_disable();
+		batch = this_cpu_ptr(handle->rx_batch);
+		if (!batch->depth++)
+			batch->mode = mode;
+		LEAVE();
+		return;
+	}
+	batch = this_cpu_ptr(handle->rx_batch);
+	if (--batch->depth) {
+		local_bh_enable();
+		LEAVE();
+		return;
+	}
+
+	if (batch->mode == MOAL_RX_BATCH_NAPI) {
+		/* GRO is flushed when the poll completes */
+		while ((skb = __skb_dequeue(&batch->q)))
+			napi_gro_receive(&handle->napi_rx, skb);
+	} else if (batch->mode == MOAL_RX_BATCH_NETIF_RX ||
+		   atomic_read(&handle->rx_pending) > MAX_RX_PENDING_THRHLD) {
+		while ((skb = __skb_dequeue(&batch->q)))
+			netif_rx(skb);
+	} else {
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 19, 0)
+		while ((skb = __skb_dequeue(&batch->q)))
+			list_add_tail(&skb->list, &rx_list);
+		netif_receive_skb_list(&rx_list);
+#else
+		while ((skb = __skb_dequeue(&batch->q)))
+			netif_receive_skb(skb);
+#endif
+	}
+	local_bh_enable();
+	LEAVE();
+}
+
 /**
  * @brief   Handle RX MGMT PKT event
  *
@@ -2792,3 +2930,41 @@ moal_do_div(IN t_u64 num, IN t_u32 base)
 	do_div(val, base);
 	return val;
 }
+
+/**
+ *  @brief Reads a value shared with another context, ordering later
+ *         memory accesses after the read
+ *
+ *  @param pval  A pointer to the value
+ *  @return      The value
+ */
+t_u32
+moal_load_acquire(IN t_u32 *pval)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 14, 0)
+	return smp_load_acquire(pval);
+#else
+	t_u32 val = *(volatile t_u32 *)pval;
+	smp_mb();
+	return val;
+#endif
+}
+
+/**
+ *  @brief Writes a value shared with another context, ordering earlier
+ *         memory accesses before the write
+ *
+ *  @param pval  A pointer to the value
+ *  @param val   The new value
+ *  @return      N/A
+ */
+t_void
+moal_store_release(IN t_u32 *pval, IN t_u32 val)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3, 14, 0)
+	smp_store_release(pval, val);
+#else
+	smp_mb();
+	*(volatile t_u32 *)pval = val;
+#endif
+}
@@ -43,6 +43,9 @@ mlan_status moal_ioctl_complete(IN t_void *pmoal_handle,
 				IN mlan_status status);
 mlan_status moal_alloc_mlan_buffer(IN t_void *pmoal_handle, IN t_u32 size,
 				   OUT pmlan_buffer *pmbuf);
+mlan_status moal_alloc_pool_mlan_buffer(IN t_void *pmoal_handle,
+					IN t_u32 size,
+					OUT pmlan_buffer *pmbuf);
 mlan_status moal_free_mlan_buffer(IN t_void *pmoal_handle,
 				  IN pmlan_buffer pmbuf);
 mlan_status moal_send_packet_complete(IN t_void *pmoal_handle,
@@ -62,6 +65,7 @@ mlan_status moal_read_data_sync(IN t_void *pmoal_handle,
 				IN OUT pmlan_buffer pmbuf,
 				IN t_u32 port, IN t_u32 timeout);
 mlan_status moal_recv_packet(IN t_void *pmoal_handle, IN pmlan_buffer pmbuf);
+t_void moal_recv_batch(IN t_void *pmoal_handle, IN t_u8 start);
 mlan_status moal_recv_event(IN t_void *pmoal_handle, IN pmlan_event pmevent);
 mlan_status moal_malloc(IN t_void *pmoal_handle,
 			IN t_u32 size, IN t_u32 flag, OUT t_u8 **ppbuf);
@@ -102,6 +106,8 @@ t_void moal_hist_data_add(IN t_void *pmoal_handle, IN t_u32 bss_index,
 t_void moal_updata_peer_signal(IN t_void *pmoal_handle, IN t_u32 bss_index,
 			       IN t_u8 *peer_addr, IN t_s8 snr, IN t_s8 nflr);
 t_u64 moal_do_div(IN t_u64 num, IN t_u32 base);
+t_u32 moal_load_acquire(IN t_u32 *pval);
+t_void moal_store_release(IN t_u32 *pval, IN t_u32 val);
 
 mlan_status moal_init_timer(IN t_void *pmoal_handle,
 			    OUT t_void **pptimer,
@@ -1394,7 +1394,7 @@ woal_alloc_virt_interface(moal_handle *handle, t_u8 bss_index, t_u8 bss_type,
 	priv->bss_type = bss_type;
 	priv->bss_role = MLAN_BSS_ROLE_STA;
 
-	INIT_LIST_HEAD(&priv->tcp_sess_queue);
+	woal_init_tcp_sess_queue(priv);
 	spin_lock_init(&priv->tcp_sess_lock);
 
 	INIT_LIST_HEAD(&priv->tx_stat_queue);